@@ -0,0 +1,108 @@
+#include "lemon.h"
+#include "lmodule.h"
+#include "lstring.h"
+#include "lnumber.h"
+#include "linteger.h"
+
+#include <math.h>
+#include <string.h>
+
+static struct lobject *
+math_pow(struct lemon *lemon, struct lobject *self, int argc, struct lobject *argv[])
+{
+	int i;
+	double x;
+	double y;
+
+	if (argc != 2 && argc != 3) {
+		return lobject_error_argument(lemon, "pow() required 2 or 3 arguments");
+	}
+
+	for (i = 0; i < argc; i++) {
+		if (!lobject_is_integer(lemon, argv[i]) &&
+		    !lobject_is_number(lemon, argv[i]))
+		{
+			return lobject_error_argument(lemon, "pow() integer or number value required");
+		}
+	}
+
+	if (lobject_is_integer(lemon, argv[0]) &&
+	    lobject_is_integer(lemon, argv[1]))
+	{
+		if (argc == 3) {
+			if (!lobject_is_integer(lemon, argv[2])) {
+				return lobject_error_argument(lemon, "pow() integer modulus required");
+			}
+			return linteger_pow(lemon, argv[0], argv[1], argv[2]);
+		}
+		return linteger_pow(lemon, argv[0], argv[1], NULL);
+	}
+
+	if (argc == 3) {
+		return lobject_error_argument(lemon, "pow() integer modulus required");
+	}
+
+	if (lobject_is_integer(lemon, argv[0])) {
+		x = (double)linteger_to_long(lemon, argv[0]);
+	} else {
+		x = lnumber_to_double(lemon, argv[0]);
+	}
+	if (lobject_is_integer(lemon, argv[1])) {
+		y = (double)linteger_to_long(lemon, argv[1]);
+	} else {
+		y = lnumber_to_double(lemon, argv[1]);
+	}
+
+	return lnumber_create_from_double(lemon, pow(x, y));
+}
+
+static struct lobject *
+math_gcd(struct lemon *lemon, struct lobject *self, int argc, struct lobject *argv[])
+{
+	if (argc != 2) {
+		return lobject_error_argument(lemon, "gcd() required 2 arguments");
+	}
+
+	if (!lobject_is_integer(lemon, argv[0]) ||
+	    !lobject_is_integer(lemon, argv[1]))
+	{
+		return lobject_error_argument(lemon, "gcd() integer value required");
+	}
+
+	return linteger_gcd(lemon, argv[0], argv[1]);
+}
+
+static struct lobject *
+math_isqrt(struct lemon *lemon, struct lobject *self, int argc, struct lobject *argv[])
+{
+	if (argc != 1 || !lobject_is_integer(lemon, argv[0])) {
+		return lobject_error_argument(lemon, "isqrt() required 1 integer argument");
+	}
+
+	return linteger_isqrt(lemon, argv[0]);
+}
+
+struct lobject *
+math_module(struct lemon *lemon)
+{
+	char *cstr;
+	struct lobject *name;
+	struct lobject *module;
+
+#define SET_FUNCTION(value) do {                                               \
+	cstr = #value ;                                                        \
+	name = lstring_create(lemon, cstr, strlen(cstr));                      \
+	lobject_set_attr(lemon,                                                \
+	                 module,                                               \
+	                 name,                                                 \
+	                 lfunction_create(lemon, name, NULL, math_ ## value)); \
+} while(0)
+
+	module = lmodule_create(lemon, lstring_create(lemon, "math", 4));
+
+	SET_FUNCTION(pow);
+	SET_FUNCTION(gcd);
+	SET_FUNCTION(isqrt);
+
+	return module;
+}
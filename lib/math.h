@@ -0,0 +1,9 @@
+#ifndef LEMON_LIB_MATH_H
+#define LEMON_LIB_MATH_H
+
+#include "lobject.h"
+
+struct lobject *
+math_module(struct lemon *lemon);
+
+#endif /* LEMON_LIB_MATH_H */
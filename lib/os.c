@@ -3,6 +3,7 @@
 #include "lmodule.h"
 #include "lstring.h"
 #include "linteger.h"
+#include "lnumber.h"
 
 #include <time.h>
 #include <stdio.h>
@@ -323,6 +324,13 @@ os_time(struct lemon *lemon, struct lobject *self, int argc, struct lobject *arg
 	return linteger_create_from_long(lemon, t);
 }
 
+static struct lobject *
+os_clock(struct lemon *lemon, struct lobject *self, int argc, struct lobject *argv[])
+{
+	return lnumber_create_from_double(lemon,
+	                                  (double)clock() / CLOCKS_PER_SEC);
+}
+
 static struct lobject *
 os_ctime(struct lemon *lemon, struct lobject *self, int argc, struct lobject *argv[])
 {
@@ -397,7 +405,7 @@ os_strftime(struct lemon *lemon, struct lobject *self, int argc, struct lobject
 	const char *fmt;
 	struct ltmobject *tm;
 
-	if (argc != 2 || !lobject_is_string(lemon, argv[0]) || argv[1]->l_method != ltmobject_method) {
+	if (argc != 2 || !lobject_is_string(lemon, argv[0]) || !lobject_is_pointer(lemon, argv[1]) || argv[1]->l_method != ltmobject_method) {
 		return lobject_error_argument(lemon, "required 2 integer arguments");
 	}
 
@@ -461,6 +469,7 @@ os_module(struct lemon *lemon)
 	SET_FUNCTION(close);
 
 	SET_FUNCTION(time);
+	SET_FUNCTION(clock);
 	SET_FUNCTION(ctime);
 	SET_FUNCTION(gmtime);
 	SET_FUNCTION(strftime);
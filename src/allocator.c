@@ -3,6 +3,7 @@
 #include "allocator.h"
 
 #include <stdio.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -33,6 +34,9 @@ memalign_malloc(size_t nbytes)
 
 	nbytes = ROUNDUP(nbytes + ROUNDUP(sizeof(void *)));
 	ptr = malloc(nbytes);
+	if (!ptr) {
+		return NULL;
+	}
 	alignptr = (void *)ROUNDUP((uintptr_t)ptr);
 
 	memcpy(alignptr, &ptr, sizeof(void *));
@@ -112,10 +116,19 @@ allocator_alloc(struct lemon *lemon, long size)
 	struct allocator *allocator;
 	struct mpool **pp;
 
+	/* header and round up must not overflow `size' */
 	allocator = lemon->l_allocator;
+	if (size < 0 ||
+	    size > LONG_MAX - (long)ROUNDUP(sizeof(void *)) - ALIGN)
+	{
+		return NULL;
+	}
 	size = ROUNDUP(size + ROUNDUP(sizeof(void *)));
 	if ((size >> SIZE_SHIFT) >= ALLOCATOR_POOL_SIZE) {
 		ptr = MALLOC((size_t)size);
+		if (!ptr) {
+			return NULL;
+		}
 		memset(ptr, 0, ROUNDUP(sizeof(void *)));
 		ptr = (void *)((char *)ptr + ROUNDUP(sizeof(void *)));
 	} else {
@@ -131,6 +144,9 @@ allocator_alloc(struct lemon *lemon, long size)
 			p = (*pp)->next;
 			(*pp)->prev = NULL;
 			(*pp)->next = NULL;
+			if (p) {
+				p->prev = NULL;
+			}
 			*pp = p;
 		}
 
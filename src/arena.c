@@ -5,7 +5,12 @@
 #include <stdio.h>
 #include <string.h>
 
-static const int block_size = 4096;
+/*
+ * block size double from `block_size' to `block_size_max', large block is
+ * mmap-ed by malloc and go back to system when arena_reset free it
+ */
+static const long block_size = 4096;
+static const long block_size_max = 1024 * 1024;
 
 struct arena *
 arena_create(struct lemon *lemon)
@@ -84,10 +89,44 @@ arena_alloc(struct lemon *lemon, struct arena *arena, long bytes)
 
 		return ptr;
 	}
-	block = arena_alloc_block(lemon, arena, block_size);
+	if (arena->blocksize < block_size) {
+		arena->blocksize = block_size;
+	} else if (arena->blocksize < block_size_max) {
+		arena->blocksize *= 2;
+	}
+	block = arena_alloc_block(lemon, arena, arena->blocksize);
+	if (!block) {
+		return NULL;
+	}
 	arena->avail = block + bytes;
-	arena->limit = block + block_size;
+	arena->limit = block + arena->blocksize;
 	ptr = block;
 
 	return ptr;
 }
+
+void
+arena_mark(struct lemon *lemon,
+           struct arena *arena,
+           struct arena_mark *mark)
+{
+	mark->limit = arena->limit;
+	mark->avail = arena->avail;
+	mark->iblocks = arena->iblocks;
+}
+
+void
+arena_reset(struct lemon *lemon,
+            struct arena *arena,
+            struct arena_mark *mark)
+{
+	int i;
+
+	/* blocks after mark include large blocks, current block is kept */
+	for (i = mark->iblocks; i < arena->iblocks; i++) {
+		allocator_free(lemon, arena->blocks[i]);
+	}
+	arena->iblocks = mark->iblocks;
+	arena->limit = mark->limit;
+	arena->avail = mark->avail;
+}
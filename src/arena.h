@@ -4,12 +4,22 @@
 struct arena {
 	char *limit;
 	char *avail;
+	long blocksize; /* size of last block */
 
 	char **blocks;
 	int iblocks;
 	int nblocks;
 };
 
+/*
+ * allocation point of arena, see arena_reset
+ */
+struct arena_mark {
+	char *limit;
+	char *avail;
+	int iblocks;
+};
+
 struct arena *
 arena_create(struct lemon *lemon);
 
@@ -19,4 +29,18 @@ arena_destroy(struct lemon *lemon, struct arena *arena);
 void *
 arena_alloc(struct lemon *lemon, struct arena *arena, long bytes);
 
+void
+arena_mark(struct lemon *lemon,
+           struct arena *arena,
+           struct arena_mark *mark);
+
+/*
+ * release everything allocated after `mark', memory before `mark' is
+ * untouched
+ */
+void
+arena_reset(struct lemon *lemon,
+            struct arena *arena,
+            struct arena_mark *mark);
+
 #endif /* LEMON_ARENA_H */
@@ -292,11 +292,11 @@ collector_scan_phase(struct lemon *lemon)
 	lemon_mark_strings(lemon);
 
 	machine = lemon->l_machine;
-	for (i = 0; i < machine->cpoollen; i++) {
-		if (!machine->cpool[i]) {
-			break;
-		}
-		lemon_collector_mark(lemon, machine->cpool[i]);
+	for (i = 0; i < machine->nglobals; i++) {
+		lemon_collector_mark(lemon, machine->globals[i]);
+	}
+	if (machine->lcode) {
+		lemon_collector_mark(lemon, machine->lcode);
 	}
 	for (i = 0; i <= machine->sp; i++) {
 		lemon_collector_mark(lemon, machine->stack[i]);
@@ -12,6 +12,7 @@
 #include "generator.h"
 #include "lmodule.h"
 #include "lnumber.h"
+#include "larray.h"
 #include "lstring.h"
 #include "linteger.h"
 
@@ -37,6 +38,21 @@
 #include <unistd.h>
 #endif
 
+/*
+ * small function in module level can be inlined into caller in same
+ * module, body is copied with locals remapped into caller's frame
+ */
+#define COMPILER_INLINE_CODES 32
+#define COMPILER_INLINE_LOCALS 8
+
+struct compiler_inline {
+	int nparams;
+	int nlocals;
+	struct scope *module;
+	struct generator_label *entry; /* label before function body */
+	struct generator_label *exit;
+};
+
 static int
 compiler_expr(struct lemon *lemon, struct syntax *node);
 
@@ -266,7 +282,10 @@ compiler_const_object(struct lemon *lemon, struct lobject *object)
 {
 	int cpool;
 
-	cpool = machine_add_const(lemon, object);
+	cpool = generator_add_const(lemon, object);
+	if (cpool < 0) {
+		return 0;
+	}
 	generator_emit_const(lemon, cpool);
 
 	return 1;
@@ -330,7 +349,9 @@ compiler_symbol(struct lemon *lemon, struct symbol *symbol)
 	} else if (symbol->type == SYMBOL_EXCEPTION) {
 		generator_emit_opcode(lemon, OPCODE_LOADEXC);
 	} else {
-		generator_emit_const(lemon, symbol->cpool);
+		return compiler_const_object(lemon,
+		                             machine_get_global(lemon,
+		                                                symbol->global));
 	}
 
 	return 1;
@@ -668,6 +689,430 @@ compiler_argument(struct lemon *lemon, struct syntax *node)
 	return 1;
 }
 
+/*
+ * compile arguments of call, plain and named only arguments push value
+ * without `karg' and `*keywords' is constant of names array for `callkw',
+ * otherwise `*keywords' is -1
+ */
+static int
+compiler_argument_list(struct lemon *lemon,
+                       struct syntax *node,
+                       int *argc,
+                       int *keywords)
+{
+	int n;
+	int nkargs;
+	struct syntax *name;
+	struct syntax *argument;
+	struct lobject *object;
+	struct lobject *names[256];
+
+	*argc = 0;
+	*keywords = -1;
+
+	/* argument list is n..0 order, named arguments are head of list */
+	n = 0;
+	nkargs = 0;
+	for (argument = node->u.call.argument_list;
+	     argument;
+	     argument = argument->sibling)
+	{
+		if (argument->argument_type ||
+		    (n && argument->u.argument.name))
+		{
+			nkargs = 0;
+			break;
+		}
+		if (argument->u.argument.name) {
+			nkargs += 1;
+		} else {
+			n += 1;
+		}
+	}
+
+	if (!nkargs || nkargs > 255) {
+		for (argument = node->u.call.argument_list;
+		     argument;
+		     argument = argument->sibling)
+		{
+			*argc += 1;
+			if (!compiler_argument(lemon, argument)) {
+				return 0;
+			}
+		}
+
+		return 1;
+	}
+
+	n = nkargs;
+	for (argument = node->u.call.argument_list;
+	     argument;
+	     argument = argument->sibling)
+	{
+		*argc += 1;
+		if (!compiler_expr(lemon, argument->u.argument.expr)) {
+			return 0;
+		}
+
+		name = argument->u.argument.name;
+		if (name) {
+			object = lstring_create(lemon,
+			                        name->buffer,
+			                        strlen(name->buffer));
+			if (!object) {
+				return 0;
+			}
+
+			/* share constant with parameter name */
+			*keywords = generator_add_const(lemon, object);
+			if (*keywords < 0) {
+				return 0;
+			}
+			names[--n] = generator_get_const(lemon, *keywords);
+		}
+	}
+
+	object = larray_create(lemon, nkargs, names);
+	if (!object) {
+		return 0;
+	}
+	*keywords = generator_add_const(lemon, object);
+	if (*keywords < 0) {
+		return 0;
+	}
+
+	return 1;
+}
+
+static int
+compiler_inline_label(int code,
+                      int exit,
+                      struct generator_label *label)
+{
+	int i;
+
+	/* `label' is forward in function body */
+	i = label->code;
+
+	return i > code && i < exit;
+}
+
+static struct compiler_inline *
+compiler_inline_define(struct lemon *lemon,
+                       struct syntax *node,
+                       struct scope *scope,
+                       struct generator_label *entry,
+                       struct generator_label *exit)
+{
+	int i;
+	int n;
+	struct scope *module;
+	struct syntax *parameter;
+	struct generator_code *code;
+	struct compiler_inline *define;
+
+	if (lemon->l_optimize < 2 ||
+	    !lemon->l_inline ||
+	    node->nvalues ||
+	    node->nlocals > COMPILER_INLINE_LOCALS ||
+	    node->u.define_stmt.accessor_list)
+	{
+		return NULL;
+	}
+
+	for (parameter = node->u.define_stmt.parameter_list;
+	     parameter;
+	     parameter = parameter->sibling)
+	{
+		if (parameter->parameter_type ||
+		    parameter->u.parameter.expr ||
+		    parameter->u.parameter.accessor_list)
+		{
+			return NULL;
+		}
+	}
+
+	/* function's upframe should always be module frame */
+	module = scope;
+	while (module && module->type == SCOPE_BLOCK) {
+		module = module->parent;
+	}
+	if (!module || module->type != SCOPE_MODULE) {
+		return NULL;
+	}
+
+	/* no loop, nested function or frame depended code */
+	n = 0;
+	for (i = entry->code + 1; i < exit->code; i++) {
+		code = generator_get_code(lemon, i);
+		if (++n > COMPILER_INLINE_CODES) {
+			return NULL;
+		}
+
+		switch (code->opcode) {
+		case OPCODE_JZ:
+		case OPCODE_JNZ:
+		case OPCODE_JMP:
+			if (!compiler_inline_label(i,
+			                           exit->code,
+			                           code->arg[0].label))
+			{
+				return NULL;
+			}
+			break;
+
+		case OPCODE_INLINE:
+			if (!compiler_inline_label(i,
+			                           exit->code,
+			                           code->arg[1].label))
+			{
+				return NULL;
+			}
+			break;
+
+		case OPCODE_LOAD:
+		case OPCODE_STORE:
+			if (code->arg[0].value > 1) {
+				return NULL;
+			}
+			break;
+
+		case OPCODE_SELF:
+		case OPCODE_SUPER:
+		case OPCODE_CLASS:
+		case OPCODE_FORITER:
+		case OPCODE_MODULE:
+		case OPCODE_DEFINE:
+		case OPCODE_TRY:
+		case OPCODE_UNTRY:
+		case OPCODE_LOADEXC:
+			return NULL;
+
+		default:
+			break;
+		}
+	}
+
+	define = arena_alloc(lemon, lemon->l_arena, sizeof(*define));
+	if (define) {
+		define->nparams = node->nparams;
+		define->nlocals = node->nlocals;
+		define->module = module;
+		define->entry = entry;
+		define->exit = exit;
+	}
+
+	return define;
+}
+
+static struct compiler_inline *
+compiler_inline_callee(struct lemon *lemon, struct syntax *node, int *depth)
+{
+	int argc;
+	struct scope *scope;
+	struct symbol *symbol;
+	struct syntax *callable;
+	struct syntax *argument;
+	struct syntax *space_enclosing;
+	struct compiler_inline *define;
+
+	callable = node->u.call.callable;
+	if (lemon->l_optimize < 2 ||
+	    !lemon->l_inline ||
+	    callable->kind != SYNTAX_KIND_NAME)
+	{
+		return NULL;
+	}
+
+	symbol = scope_get_symbol(lemon, lemon->l_scope, callable->buffer);
+	if (!symbol ||
+	    symbol->type != SYMBOL_LOCAL ||
+	    symbol->accessor_list ||
+	    !symbol->define)
+	{
+		return NULL;
+	}
+	define = symbol->define;
+
+	argc = 0;
+	for (argument = node->u.call.argument_list;
+	     argument;
+	     argument = argument->sibling)
+	{
+		if (argument->argument_type || argument->u.argument.name) {
+			return NULL;
+		}
+		argc += 1;
+	}
+	if (argc != define->nparams) {
+		return NULL;
+	}
+
+	/* module frame is `depth' upframe of caller */
+	*depth = 0;
+	for (scope = lemon->l_scope; scope; scope = scope->parent) {
+		if (scope == define->module) {
+			break;
+		}
+		if (scope->type == SCOPE_DEFINE) {
+			*depth += 1;
+		}
+	}
+	if (!scope || symbol->level != *depth) {
+		return NULL;
+	}
+
+	space_enclosing = lemon->l_space_enclosing;
+	if (space_enclosing->nlocals + define->nlocals > 255) {
+		return NULL;
+	}
+
+	return define;
+}
+
+static struct generator_label *
+compiler_inline_remap(struct generator_label *label,
+                      struct generator_label *labels[][2],
+                      int nlabels)
+{
+	int i;
+
+	for (i = 0; i < nlabels; i++) {
+		if (labels[i][0] == label) {
+			return labels[i][1];
+		}
+	}
+
+	return label;
+}
+
+static int
+compiler_inline(struct lemon *lemon,
+                struct compiler_inline *define,
+                int depth)
+{
+	/*
+	 *    callable
+	 *    argument n
+	 *    ...
+	 *    argument 0
+	 *    store 0, local 0
+	 *    ...
+	 *    store 0, local n
+	 *    inline entry, l_call
+	 *    body (return -> jmp l_exit)
+	 * l_call:
+	 *    load 0, local n
+	 *    ...
+	 *    load 0, local 0
+	 *    call n
+	 * l_exit:
+	 */
+
+	int i;
+	int j;
+	int base;
+	int level;
+	int nlabels;
+	struct syntax *space_enclosing;
+	struct generator_arg *arg;
+	struct generator_code code;
+	struct generator_label *l_call;
+	struct generator_label *l_exit;
+	struct generator_label *labels[COMPILER_INLINE_CODES][2];
+
+	space_enclosing = lemon->l_space_enclosing;
+	base = space_enclosing->nlocals;
+	space_enclosing->nlocals += define->nlocals;
+
+	l_call = generator_make_label(lemon);
+	l_exit = generator_make_label(lemon);
+	if (!l_call || !l_exit) {
+		return 0;
+	}
+
+	for (i = 0; i < define->nparams; i++) {
+		generator_emit_store(lemon, 0, base + i);
+	}
+	generator_emit_inline(lemon, define->entry, l_call);
+
+	/* frame's locals start with nil */
+	for (i = define->nparams; i < define->nlocals; i++) {
+		if (!compiler_const_object(lemon, lemon->l_nil)) {
+			return 0;
+		}
+		generator_emit_store(lemon, 0, base + i);
+	}
+
+	nlabels = 0;
+	for (i = define->entry->code + 1; i < define->exit->code; i++) {
+		code = *generator_get_code(lemon, i);
+		if (code.opcode == -1) {
+			labels[nlabels][0] = code.label;
+			labels[nlabels][1] = generator_make_label(lemon);
+			if (!labels[nlabels][1]) {
+				return 0;
+			}
+			nlabels += 1;
+		}
+	}
+
+	/* copy by value, emit may move the codes array */
+	for (i = define->entry->code + 1; i < define->exit->code; i++) {
+		code = *generator_get_code(lemon, i);
+		if (code.opcode == -1) {
+			for (j = 0; labels[j][0] != code.label; j++) {
+				continue;
+			}
+			generator_emit_label(lemon, labels[j][1]);
+			continue;
+		}
+
+		if (code.opcode == OPCODE_RETURN) {
+			generator_emit_jmp(lemon, l_exit);
+			continue;
+		}
+
+		if (code.opcode == OPCODE_TAILCALL) {
+			generator_emit_call(lemon, code.arg[0].value);
+			continue;
+		}
+
+		if (code.opcode == OPCODE_LOAD ||
+		    code.opcode == OPCODE_STORE)
+		{
+			level = code.arg[0].value;
+			if (level == 0) {
+				code.arg[1].value += base;
+			} else {
+				code.arg[0].value = level + depth - 1;
+			}
+		}
+
+		/* label of other function (inline entry) is kept */
+		for (j = 0; j < code.nargs; j++) {
+			arg = &code.arg[j];
+			if (arg->type == 1) {
+				arg->label = compiler_inline_remap(arg->label,
+				                                   labels,
+				                                   nlabels);
+			}
+		}
+		if (generator_emit_code(lemon, &code) < 0) {
+			return 0;
+		}
+	}
+
+	generator_emit_label(lemon, l_call);
+	for (i = define->nparams - 1; i >= 0; i--) {
+		generator_emit_load(lemon, 0, base + i);
+	}
+	generator_emit_call(lemon, define->nparams);
+	generator_emit_label(lemon, l_exit);
+
+	return 1;
+}
+
 static int
 compiler_call(struct lemon *lemon, struct syntax *node)
 {
@@ -677,11 +1122,21 @@ compiler_call(struct lemon *lemon, struct syntax *node)
 	 *    ...
 	 *    argument 0
 	 *    call n
+	 *
+	 * named arguments without `*' or `**' are value only
+	 *
+	 *    callable
+	 *    argument n (value of keyword)
+	 *    ...
+	 *    argument 0
+	 *    callkw n, keywords
 	 */
 
 	int argc;
-	struct syntax *argument;
+	int depth;
+	int keywords;
 	struct syntax *stmt_enclosing;
+	struct compiler_inline *define;
 
 	stmt_enclosing = lemon->l_stmt_enclosing;
 	lemon->l_stmt_enclosing = node;
@@ -690,17 +1145,20 @@ compiler_call(struct lemon *lemon, struct syntax *node)
 		return 0;
 	}
 
-	argc = 0;
-	for (argument = node->u.call.argument_list;
-	     argument;
-	     argument = argument->sibling)
-	{
-		argc += 1;
-		if (!compiler_argument(lemon, argument)) {
+	if (!compiler_argument_list(lemon, node, &argc, &keywords)) {
+		return 0;
+	}
+
+	define = compiler_inline_callee(lemon, node, &depth);
+	if (define) {
+		if (!compiler_inline(lemon, define, depth)) {
 			return 0;
 		}
+	} else if (keywords >= 0) {
+		generator_emit_callkw(lemon, argc, keywords);
+	} else {
+		generator_emit_call(lemon, argc);
 	}
-	generator_emit_call(lemon, argc);
 
 	if (!stmt_enclosing) {
 		/* dispose return value */
@@ -1167,7 +1625,13 @@ compiler_forin_stmt(struct lemon *lemon, struct syntax *node)
 	 *    call 0
 	 *    store local
 	 * l_next:
-	 *    store local
+	 *    foriter local, l_call, l_exit
+	 *    store name
+	 * l_block:
+	 *    block_stmt
+	 *    jmp l_next
+	 * l_call:
+	 *    load local
 	 *    const "__next__"
 	 *    getattr
 	 *    call 0
@@ -1175,17 +1639,19 @@ compiler_forin_stmt(struct lemon *lemon, struct syntax *node)
 	 *    store name
 	 *    const sentinal
 	 *    eq
-	 *    jnz l_exit
-	 *    step_expr
-	 *    block_stmt
-	 *    jmp l_next
+	 *    jz l_block
 	 * l_exit:
+	 *
+	 * native iterator is advanced by `foriter', others jump to
+	 * `l_call' and call `__next__'
 	 */
 
 	int local;
 
 	struct generator_label *l_next;
 	struct generator_label *l_exit;
+	struct generator_label *l_call;
+	struct generator_label *l_block;
 
 	struct syntax *name;
 	struct syntax *stmt_enclosing;
@@ -1203,6 +1669,8 @@ compiler_forin_stmt(struct lemon *lemon, struct syntax *node)
 
 	l_next = generator_make_label(lemon);
 	l_exit = generator_make_label(lemon);
+	l_call = generator_make_label(lemon);
+	l_block = generator_make_label(lemon);
 
 	stmt_enclosing = lemon->l_stmt_enclosing;
 	lemon->l_stmt_enclosing = node;
@@ -1219,14 +1687,7 @@ compiler_forin_stmt(struct lemon *lemon, struct syntax *node)
 	generator_emit_store(lemon, 0, local);
 
 	generator_emit_label(lemon, l_next);
-
-	generator_emit_load(lemon, 0, local);
-	if (!compiler_const_object(lemon, lemon->l_next_string)) {
-		return 0;
-	}
-	generator_emit_opcode(lemon, OPCODE_GETATTR);
-	generator_emit_call(lemon, 0);
-	generator_emit_opcode(lemon, OPCODE_DUP); /* store and cmp */
+	generator_emit_foriter(lemon, local, l_call, l_exit);
 
 	name = node->u.forin_stmt.name;
 	if (name->kind == SYNTAX_KIND_VAR_STMT) {
@@ -1251,12 +1712,7 @@ compiler_forin_stmt(struct lemon *lemon, struct syntax *node)
 		}
 	}
 	generator_emit_store(lemon, symbol->level, symbol->local);
-
-	if (!compiler_const_object(lemon, lemon->l_sentinel)) {
-		return 0;
-	}
-	generator_emit_opcode(lemon, OPCODE_EQ);
-	generator_emit_jnz(lemon, l_exit);
+	generator_emit_label(lemon, l_block);
 
 	node->l_break = l_exit;
 	node->l_continue = l_next;
@@ -1264,7 +1720,22 @@ compiler_forin_stmt(struct lemon *lemon, struct syntax *node)
 	if (!compiler_block(lemon, node->u.forin_stmt.block_stmt)) {
 		return 0;
 	}
-	generator_emit_jmp(lemon, l_next);
+	generator_emit_jmp(lemon, l_next);
+
+	generator_emit_label(lemon, l_call);
+	generator_emit_load(lemon, 0, local);
+	if (!compiler_const_object(lemon, lemon->l_next_string)) {
+		return 0;
+	}
+	generator_emit_opcode(lemon, OPCODE_GETATTR);
+	generator_emit_call(lemon, 0);
+	generator_emit_opcode(lemon, OPCODE_DUP); /* store and cmp */
+	generator_emit_store(lemon, symbol->level, symbol->local);
+	if (!compiler_const_object(lemon, lemon->l_sentinel)) {
+		return 0;
+	}
+	generator_emit_opcode(lemon, OPCODE_EQ);
+	generator_emit_jz(lemon, l_block);
 	generator_emit_label(lemon, l_exit);
 
 	lemon->l_loop_enclosing = loop_enclosing;
@@ -1440,15 +1911,48 @@ compiler_parameter(struct lemon *lemon, struct syntax *node)
 }
 
 static int
-compiler_define_stmt(struct lemon *lemon, struct syntax *node)
+compiler_define_type(struct lemon *lemon, struct syntax *node)
+{
+	int define;
+	struct syntax *parameter;
+
+	define = 0;
+	for (parameter = node->u.define_stmt.parameter_list;
+	     parameter;
+	     parameter = parameter->sibling)
+	{
+		if (parameter->parameter_type == 0 && define == 0) {
+			/* define func(var a, var b, var c) */
+			define = 0;
+		} else if (parameter->parameter_type == 1 && define == 0) {
+			/* define func(var a, var b, var *c) */
+			define = 1;
+		} else if (parameter->parameter_type == 2 && define == 0) {
+			/* define func(var a, var b, var **c) */
+			define = 2;
+		} else if (parameter->parameter_type == 2 && define == 1) {
+			/* define func(var a, var *b, var **c) */
+			define = 3;
+		} else {
+			compiler_error(lemon, node, "wrong parameter type\n");
+
+			return -1;
+		}
+	}
+
+	return define;
+}
+
+static int
+compiler_define_body(struct lemon *lemon,
+                     struct syntax *node,
+                     int define,
+                     struct generator_label *l_entry,
+                     struct generator_label *l_exit)
 {
 	/*
-	 *    const parameter_name_0
-	 *    ...
-	 *    const parameter_name_n
-	 *
-	 *    const function_name
 	 *    define define, nvalues, nparams, nlocals, l_exit
+	 * l_entry:
 	 *    parameter_0
 	 *    ...
 	 *    parameter_n
@@ -1458,9 +1962,217 @@ compiler_define_stmt(struct lemon *lemon, struct syntax *node)
 	 * l_exit:
 	 */
 
+	int c_define;
+	struct syntax *parameter;
+
+	/* 'define' will create a function object and jmp function end */
+	c_define = generator_emit_define(lemon, 0, 0, 0, 0, 0);
+	generator_emit_label(lemon, l_entry);
+
+	/* generate function parameters name(for call keyword arguments) */
+	for (parameter = node->u.define_stmt.parameter_list;
+	     parameter;
+	     parameter = parameter->sibling)
+	{
+		if (!compiler_parameter(lemon, parameter)) {
+			return 0;
+		}
+	}
+
+	if (!compiler_block(lemon, node->u.define_stmt.block_stmt)) {
+		return 0;
+	}
+
+	if (!node->u.define_stmt.block_stmt->has_return) {
+		if (!compiler_const_object(lemon, lemon->l_nil)) {
+			return 0;
+		}
+		generator_emit_opcode(lemon, OPCODE_RETURN);
+	}
+
+	generator_emit_label(lemon, l_exit);
+
+	/* patch define */
+	generator_patch_define(lemon,
+	                       c_define,
+	                       define,
+	                       node->nvalues,
+	                       node->nparams,
+	                       node->nlocals,
+	                       l_exit);
+
+	return 1;
+}
+
+/*
+ * export module symbols added since last lazy define, `names' is
+ * [name, local, ...] in added order and shared by every lazy function
+ * of module, function only see its prefix.  symbol has accessor can't be
+ * exported and module's later function is not lazy.
+ */
+static int
+compiler_lazy_names(struct lemon *lemon, struct scope *scope)
+{
+	long i;
+	long n;
+	struct symbol *symbol;
+	struct symbol **symbols;
+	struct lobject *items[2];
+
+	if (!scope->names) {
+		scope->names = larray_create(lemon, 0, NULL);
+		if (!scope->names) {
+			return 0;
+		}
+	}
+
+	n = scope->nsymbols - larray_length(lemon, scope->names) / 2;
+	if (n <= 0) {
+		return 1;
+	}
+	symbols = arena_alloc(lemon, lemon->l_arena, sizeof(*symbols) * n);
+	if (!symbols) {
+		return 0;
+	}
+
+	/* scope's symbols is last added first */
+	symbol = scope->symbol;
+	for (i = n - 1; i >= 0; i--) {
+		symbols[i] = symbol;
+		symbol = symbol->next;
+	}
+
+	for (i = 0; i < n; i++) {
+		symbol = symbols[i];
+		if (symbol->type != SYMBOL_LOCAL || symbol->accessor_list) {
+			scope->eager = 1;
+		}
+		items[0] = lstring_create(lemon,
+		                          symbol->name,
+		                          strlen(symbol->name));
+		items[1] = linteger_create_from_long(lemon, symbol->local);
+		if (!items[0] || !items[1]) {
+			return 0;
+		}
+		if (!larray_append(lemon, scope->names, 2, items)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * body of lazy define is needed now, parse it again from source
+ */
+static int
+compiler_lazy_block(struct lemon *lemon, struct syntax *node)
+{
+	struct syntax *define;
+
+	define = parser_parse_define(lemon,
+	                             node->u.define_stmt.source,
+	                             node->filename,
+	                             node->u.define_stmt.offset);
+	if (!define) {
+		return 0;
+	}
+	node->u.define_stmt.block_stmt = define->u.define_stmt.block_stmt;
+
+	return 1;
+}
+
+static int
+compiler_lazy(struct lemon *lemon,
+              struct syntax *node,
+              struct scope *scope,
+              int define)
+{
+	/*
+	 *    const [record_0, ..., record_n]
+	 *    lazy define, nvalues, nparams, n
+	 *
+	 * record is [source, filename, offset, names, count], body is
+	 * compiled at first call by compiler_compile_lazy
+	 */
+
+	int nvalues;
+	int nparams;
+	struct syntax *parameter;
+	struct lobject *record;
+	struct lobject *items[5];
+
+	nvalues = 0;
+	nparams = 0;
+	for (parameter = node->u.define_stmt.parameter_list;
+	     parameter;
+	     parameter = parameter->sibling)
+	{
+		nparams += 1;
+		if (parameter->u.parameter.expr) {
+			nvalues += 1;
+		}
+	}
+
+	items[0] = node->u.define_stmt.source;
+	items[1] = lstring_create(lemon,
+	                          node->filename,
+	                          strlen(node->filename));
+	items[2] = linteger_create_from_long(lemon,
+	                                     node->u.define_stmt.offset);
+	items[3] = scope->names;
+	items[4] = linteger_create_from_long(lemon, scope->nsymbols);
+	if (!items[1] || !items[2] || !items[4]) {
+		return 0;
+	}
+	record = larray_create(lemon, 5, items);
+	if (!record) {
+		return 0;
+	}
+
+	/* records of module share one constant */
+	if (!scope->lazies) {
+		scope->lazies = larray_create(lemon, 0, NULL);
+		if (!scope->lazies) {
+			return 0;
+		}
+	}
+	if (!larray_append(lemon, scope->lazies, 1, &record)) {
+		return 0;
+	}
+	if (!compiler_const_object(lemon, scope->lazies)) {
+		return 0;
+	}
+	generator_emit_lazy(lemon,
+	                    define,
+	                    nvalues,
+	                    nparams,
+	                    larray_length(lemon, scope->lazies) - 1);
+
+	return 1;
+}
+
+static int
+compiler_define_stmt(struct lemon *lemon, struct syntax *node)
+{
+	/*
+	 *    const parameter_name_0
+	 *    ...
+	 *    const parameter_name_n
+	 *
+	 *    const function_name
+	 *    define body (see compiler_define_body)
+	 *
+	 * or module level function parsed lazily
+	 *
+	 *    const function_name
+	 *    lazy (see compiler_lazy)
+	 */
+
+	int lazy;
 	int define;
 	struct generator_label *l_exit;
-	struct generator_code *c_define;
+	struct generator_label *l_entry;
 
 	struct scope *scope;
 	struct symbol *symbol;
@@ -1473,6 +2185,10 @@ compiler_define_stmt(struct lemon *lemon, struct syntax *node)
 	struct syntax *space_enclosing;
 
 	l_exit = generator_make_label(lemon);
+	l_entry = generator_make_label(lemon);
+	if (!l_exit || !l_entry) {
+		return 0;
+	}
 
 	/* generate default parameters value */
 	for (parameter = node->u.define_stmt.parameter_list;
@@ -1485,6 +2201,11 @@ compiler_define_stmt(struct lemon *lemon, struct syntax *node)
 		}
 	}
 
+	define = compiler_define_type(lemon, node);
+	if (define < 0) {
+		return 0;
+	}
+
 	space_enclosing = lemon->l_space_enclosing;
 	lemon->l_space_enclosing = node;
 
@@ -1514,66 +2235,39 @@ compiler_define_stmt(struct lemon *lemon, struct syntax *node)
 		symbol = NULL;
 	}
 
-	/* 'define' will create a function object and jmp function end */
-	c_define = generator_emit_define(lemon, 0, 0, 0, 0, 0);
-
-	try_enclosing = lemon->l_try_enclosing;
-	lemon->l_try_enclosing = NULL;
-
-	define = 0;
-	/* generate function parameters name(for call keyword arguments) */
-	for (parameter = node->u.define_stmt.parameter_list;
-	     parameter;
-	     parameter = parameter->sibling)
-	{
-		if (parameter->parameter_type == 0 && define == 0) {
-			/* define func(var a, var b, var c) */
-			define = 0;
-		} else if (parameter->parameter_type == 1 && define == 0) {
-			/* define func(var a, var b, var *c) */
-			define = 1;
-		} else if (parameter->parameter_type == 2 && define == 0) {
-			/* define func(var a, var b, var **c) */
-			define = 2;
-		} else if (parameter->parameter_type == 2 && define == 1) {
-			/* define func(var a, var *b, var **c) */
-			define = 3;
-		} else {
-			compiler_error(lemon, node, "wrong parameter type\n");
-
-			return 0;
+	/* only function see nothing but module symbols can be lazy */
+	lazy = 0;
+	if (!node->u.define_stmt.block_stmt) {
+		if (scope && scope->type == SCOPE_MODULE) {
+			if (!compiler_lazy_names(lemon, scope)) {
+				return 0;
+			}
+			lazy = !scope->eager;
 		}
-
-		if (!compiler_parameter(lemon, parameter)) {
+		if (!lazy && !compiler_lazy_block(lemon, node)) {
 			return 0;
 		}
 	}
 
+	try_enclosing = lemon->l_try_enclosing;
 	stmt_enclosing = lemon->l_stmt_enclosing;
-	lemon->l_stmt_enclosing = NULL;
-
-	if (!compiler_block(lemon, node->u.define_stmt.block_stmt)) {
-		return 0;
-	}
-
-	if (!node->u.define_stmt.block_stmt->has_return) {
-		if (!compiler_const_object(lemon, lemon->l_nil)) {
+	if (lazy) {
+		if (!compiler_lazy(lemon, node, scope, define)) {
+			return 0;
+		}
+	} else {
+		lemon->l_try_enclosing = NULL;
+		lemon->l_stmt_enclosing = NULL;
+		if (!compiler_define_body(lemon,
+		                          node,
+		                          define,
+		                          l_entry,
+		                          l_exit))
+		{
 			return 0;
 		}
-		generator_emit_opcode(lemon, OPCODE_RETURN);
 	}
 
-	generator_emit_label(lemon, l_exit);
-
-	/* patch define */
-	generator_patch_define(lemon,
-	                       c_define,
-	                       define,
-	                       node->nvalues,
-	                       node->nparams,
-	                       node->nlocals,
-	                       l_exit);
-
 	/* if define in class don't emit store */
 	if (scope && scope->type != SCOPE_CLASS) {
 		if (name) {
@@ -1588,6 +2282,13 @@ compiler_define_stmt(struct lemon *lemon, struct syntax *node)
 				generator_emit_opcode(lemon, OPCODE_DUP);
 			}
 			generator_emit_store(lemon, 0, symbol->local);
+			if (!lazy) {
+				symbol->define = compiler_inline_define(lemon,
+				                                        node,
+				                                        scope,
+				                                        l_entry,
+				                                        l_exit);
+			}
 		}
 	}
 
@@ -1671,8 +2372,9 @@ compiler_return_stmt(struct lemon *lemon, struct syntax *node)
 	if (node->u.return_stmt.expr) {
 		struct syntax *expr;
 
+		/* call in try block is not tail, handler is in this frame */
 		expr = node->u.return_stmt.expr;
-		if (expr->kind == SYNTAX_KIND_CALL) {
+		if (expr->kind == SYNTAX_KIND_CALL && !lemon->l_try_enclosing) {
 			if (!compiler_tailcall(lemon, expr)) {
 				return 0;
 			}
@@ -2091,8 +2793,8 @@ compiler_block(struct lemon *lemon, struct syntax *node)
 static int
 compiler_module(struct lemon *lemon, struct syntax *node)
 {
+	int c_module;
 	struct generator_label *l_exit;
-	struct generator_code *c_module;
 
 	char *module_name;
 	char *module_path;
@@ -2232,8 +2934,8 @@ compiler_module(struct lemon *lemon, struct syntax *node)
 static int
 compiler_import_stmt(struct lemon *lemon, struct syntax *node)
 {
+	int c_module;
 	struct generator_label *l_exit;
-	struct generator_code *c_module;
 
 	struct syntax *stmt;
 	struct scope *scope;
@@ -2816,3 +3518,72 @@ compiler_compile(struct lemon *lemon, struct syntax *node)
 {
 	return compiler_module(lemon, node);
 }
+
+int
+compiler_compile_lazy(struct lemon *lemon,
+                      struct lobject *record,
+                      struct generator_label **entry,
+                      int *nlocals)
+{
+	long i;
+	long count;
+	int define;
+	struct lobject *name;
+	struct lobject *names;
+	struct symbol *symbol;
+	struct syntax *node;
+	struct generator_label *l_exit;
+	struct generator_label *l_entry;
+
+#define item(i) larray_get_item(lemon, record, (i))
+
+	node = parser_parse_define(lemon,
+	                           item(0),
+	                           lstring_to_cstr(lemon, item(1)),
+	                           linteger_to_long(lemon, item(2)));
+	if (!node) {
+		return 0;
+	}
+
+	/* module scope has only symbols added before function */
+	scope_enter(lemon, SCOPE_MODULE);
+	names = item(3);
+	count = linteger_to_long(lemon, item(4));
+	for (i = 0; i < count; i++) {
+		name = larray_get_item(lemon, names, i * 2);
+		symbol = scope_add_symbol(lemon,
+		                          lemon->l_scope,
+		                          lstring_to_cstr(lemon, name),
+		                          SYMBOL_LOCAL);
+		if (!symbol) {
+			return 0;
+		}
+		symbol->local = linteger_to_long(lemon,
+		                                 larray_get_item(lemon,
+		                                                 names,
+		                                                 i * 2 + 1));
+	}
+#undef item
+
+	scope_enter(lemon, SCOPE_DEFINE);
+	lemon->l_space_enclosing = node;
+
+	define = compiler_define_type(lemon, node);
+	if (define < 0) {
+		return 0;
+	}
+	l_entry = generator_make_label(lemon);
+	l_exit = generator_make_label(lemon);
+	if (!l_entry || !l_exit) {
+		return 0;
+	}
+	/* no code jump to entry, keep it from peephole for its address */
+	l_entry->count += 1;
+	if (!compiler_define_body(lemon, node, define, l_entry, l_exit)) {
+		return 0;
+	}
+	*entry = l_entry;
+	*nlocals = node->nlocals;
+
+	return 1;
+}
@@ -1,7 +1,20 @@
 #ifndef LEMON_COMPILER_H
 #define LEMON_COMPILER_H
 
+struct lobject;
+struct generator_label;
+
 int
 compiler_compile(struct lemon *lemon, struct syntax *node);
 
+/*
+ * compile lazy function's body (see compiler_lazy) from its `record',
+ * body start at label `entry' and need `nlocals' locals
+ */
+int
+compiler_compile_lazy(struct lemon *lemon,
+                      struct lobject *record,
+                      struct generator_label **entry,
+                      int *nlocals);
+
 #endif /* LEMON_COMPILER_H */
@@ -25,23 +25,49 @@ extend_to_long(int n, extend_t *x)
 	unsigned long u;
 
 	u = 0;
-	i = sizeof(u) * 8;
+	i = (sizeof(u) * 8 + EXTEND_BITS - 1) / EXTEND_BITS;
 
 	if (i > n) {
 		i = n;
 	}
 
 	while (--i >= 0) {
-		u = u * EXTEND_BASE + x[i];
+		u = (unsigned long)(u * EXTEND_BASE + x[i]);
 	}
 
 	return u;
 }
 
+/*
+ * largest power of `base' fit in one digit, `k' is the exponent
+ */
+unsigned long
+extend_radix(int base, int *k)
+{
+	unsigned long power;
+
+	power = base;
+	*k = 1;
+	while (power <= (EXTEND_BASE - 1) / base) {
+		power *= base;
+		*k += 1;
+	}
+
+	return power;
+}
+
+/*
+ * digits are accumulated into one chunk of `extend_radix()', so `z' is
+ * scanned once per chunk instead of once per character
+ */
 unsigned long
 extend_from_str(int n, extend_t *z, const char *str, int base, char **end)
 {
+	int k;
+	int count;
 	const char *p;
+	unsigned long chunk;
+	unsigned long power;
 	unsigned long carry;
 
 	for (p = str; *p && isspace(*p); p++) {
@@ -50,12 +76,12 @@ extend_from_str(int n, extend_t *z, const char *str, int base, char **end)
 
 	carry = 0;
 	if (*p && isalnum(*p)) {
+		extend_radix(base, &k);
+		count = 0;
+		chunk = 0;
+		power = 1;
 		for (; *p && isalnum(*p); p++) {
 			int digit;
-			carry = extend_product(n, z, z, base);
-			if (carry) {
-				break;
-			}
 			digit = 0;
 			switch (*p) {
 			case '0':
@@ -98,7 +124,22 @@ extend_from_str(int n, extend_t *z, const char *str, int base, char **end)
 				break;
 			}
 			assert(digit < base);
-			extend_sum(n, z, z, digit);
+			chunk = chunk * base + digit;
+			power *= base;
+			if (++count == k) {
+				carry = extend_product(n, z, z, power);
+				carry += extend_sum(n, z, z, chunk);
+				if (carry) {
+					break;
+				}
+				count = 0;
+				chunk = 0;
+				power = 1;
+			}
+		}
+		if (count) {
+			carry = extend_product(n, z, z, power);
+			carry += extend_sum(n, z, z, chunk);
 		}
 		if (end) {
 			*end = (char *)p;
@@ -114,20 +155,33 @@ extend_from_str(int n, extend_t *z, const char *str, int base, char **end)
 	return carry;
 }
 
+/*
+ * `x' is destroyed, every division by `extend_radix()' produce a chunk
+ * of digits.  result is truncated to `size' - 1 characters.
+ */
 char *
 extend_to_str(int n, extend_t *x, char *str, int size, int base)
 {
 	int i;
 	int j;
+	int k;
+	unsigned long r;
+	unsigned long radix;
 
+	radix = extend_radix(base, &k);
 	i = 0;
 	do {
-		int r = extend_quotient(n, x, x, base);
-		str[i++] = "0123456789abcdef"[r];
-		while (n > 1 && x[n - 1] == 0) {
-			n--;
+		r = extend_quotient(n, x, x, radix);
+		n = extend_length(n, x);
+		for (j = 0; j < k && i < size - 1; j++) {
+			str[i++] = "0123456789abcdef"[r % base];
+			r /= base;
+			/* no leading zero in last chunk */
+			if (r == 0 && n == 1 && x[0] == 0) {
+				break;
+			}
 		}
-	} while (n > 1 || x[0] != 0);
+	} while ((n > 1 || x[0] != 0) && i < size - 1);
 	str[i] = '\0';
 
 	for (j = 0; j < --i; j++) {
@@ -195,45 +249,411 @@ extend_sub(extend_t *z, int n,
 	for (i = 0; i < m; i++) {
 		d = (x[i] + EXTEND_BASE) - y[i] - borrow;
 		z[i] = d % EXTEND_BASE;
-		borrow /= EXTEND_BASE;
+		borrow = 1 - d / EXTEND_BASE;
 	}
 
 	for (; i < n; i++) {
 		d = (x[i] + EXTEND_BASE) - borrow;
 		z[i] = d % EXTEND_BASE;
-		borrow /= EXTEND_BASE;
+		borrow = 1 - d / EXTEND_BASE;
 	}
 
 	return borrow;
 }
 
-unsigned long
-extend_mul(extend_t *z, int n, extend_t *x, int m, extend_t *y)
+/*
+ * multiplication
+ *
+ * schoolbook below EXTEND_KARATSUBA digits, Karatsuba below EXTEND_TOOM3
+ * digits, then Toom-3 at points 0, 1, -1, 2 and infinity.  square is
+ * detected by `x == y' and only one operand is evaluated at every level.
+ * Karatsuba and Toom-3 need `tmp' of `extend_mul_tmp(n, m)' digits.
+ */
+#define EXTEND_KARATSUBA 32
+#define EXTEND_TOOM3 300
+
+static void
+extend_mul_balanced(extend_t *z, int n,
+                    extend_t *x,
+                    extend_t *y,
+                    extend_t *tmp);
+
+static void
+extend_mul_basecase(extend_t *z, int n, extend_t *x, int m, extend_t *y)
 {
 	int i;
 	int j;
-	unsigned long carry;
-	unsigned long carryout;
+	extend_wide_t xi;
+	extend_wide_t carry;
 
-	carryout = 0;
+	memset(z, 0, (n + m) * sizeof(extend_t));
 	for (i = 0; i < n; i++) {
+		xi = x[i];
+		if (xi == 0) {
+			continue;
+		}
+
 		carry = 0;
 		for (j = 0; j < m; j++) {
-			carry += x[i] * y[j] + z[i+j];
-			z[i+j] = carry % EXTEND_BASE;
+			carry += xi * y[j] + z[i + j];
+			z[i + j] = carry % EXTEND_BASE;
 			carry /= EXTEND_BASE;
 		}
-		for (; j < n + m - i; j++) {
-			carry += z[i + j];
+		z[i + m] = (extend_t)carry;
+	}
+}
+
+/*
+ * sum of x[i] * x[j] (i < j) once, double it and add x[i] * x[i]
+ */
+static void
+extend_sqr_basecase(extend_t *z, int n, extend_t *x)
+{
+	int i;
+	int j;
+	extend_wide_t v;
+	extend_wide_t xi;
+	extend_wide_t carry;
+
+	memset(z, 0, 2 * n * sizeof(extend_t));
+	for (i = 0; i < n; i++) {
+		xi = x[i];
+		carry = 0;
+		for (j = i + 1; j < n; j++) {
+			carry += xi * x[j] + z[i + j];
 			z[i + j] = carry % EXTEND_BASE;
 			carry /= EXTEND_BASE;
 		}
-		carryout |= carry;
+		z[i + n] = (extend_t)carry;
+	}
+
+	carry = 0;
+	for (i = 0; i < 2 * n; i++) {
+		v = ((extend_wide_t)z[i] << 1) | carry;
+		z[i] = v % EXTEND_BASE;
+		carry = v / EXTEND_BASE;
+	}
+
+	carry = 0;
+	for (i = 0; i < n; i++) {
+		v = (extend_wide_t)x[i] * x[i];
+		carry += z[2 * i] + v % EXTEND_BASE;
+		z[2 * i] = carry % EXTEND_BASE;
+		carry /= EXTEND_BASE;
+		carry += z[2 * i + 1] + v / EXTEND_BASE;
+		z[2 * i + 1] = carry % EXTEND_BASE;
+		carry /= EXTEND_BASE;
+	}
+}
+
+/*
+ * z[0, n) += x[0, m), z has enough digits for carry
+ */
+static void
+extend_mul_accumulate(extend_t *z, int n, extend_t *x, int m)
+{
+	m = extend_length(m, x);
+	extend_add(z, n, z, m, x, 0);
+}
+
+static void
+extend_karatsuba(extend_t *z, int n, extend_t *x, extend_t *y, extend_t *tmp)
+{
+	int l;
+	int h;
+	extend_t *sx;
+	extend_t *sy;
+	extend_t *z1;
+
+	/* x = x1 * BASE^l + x0 */
+	l = n / 2;
+	h = n - l;
+	sx = tmp;
+	sy = tmp + h + 1;
+	z1 = tmp + 2 * (h + 1);
+
+	extend_mul_balanced(z, l, x, y, z1);
+	extend_mul_balanced(z + 2 * l, h, x + l, y + l, z1);
+
+	sx[h] = (extend_t)extend_add(sx, h, x + l, l, x, 0);
+	if (x == y) {
+		sy = sx;
+	} else {
+		sy[h] = (extend_t)extend_add(sy, h, y + l, l, y, 0);
+	}
+
+	/* z1 = (x0 + x1)(y0 + y1) - z0 - z2 */
+	extend_mul_balanced(z1, h + 1, sx, sy, tmp + 4 * (h + 1));
+	extend_sub(z1, 2 * (h + 1), z1, 2 * l, z, 0);
+	extend_sub(z1, 2 * (h + 1), z1, 2 * h, z + 2 * l, 0);
+
+	extend_mul_accumulate(z + l, 2 * n - l, z1, 2 * (h + 1));
+}
+
+/*
+ * p(1), |p(-1)| and p(2) of p(t) = x2 * t^2 + x1 * t + x0,
+ * return 1 if p(-1) is negative
+ */
+static int
+extend_toom3_evaluate(int k, int r,
+                      extend_t *x,
+                      extend_t *p1,
+                      extend_t *pm,
+                      extend_t *p2)
+{
+	int sign;
+	extend_t *x0;
+	extend_t *x1;
+	extend_t *x2;
+
+	x0 = x;
+	x1 = x + k;
+	x2 = x + 2 * k;
+
+	p1[k] = (extend_t)extend_add(p1, k, x0, r, x2, 0);
+	if (p1[k] || extend_cmp(k, p1, x1) >= 0) {
+		sign = 0;
+		extend_sub(pm, k + 1, p1, k, x1, 0);
+	} else {
+		sign = 1;
+		extend_sub(pm, k, x1, k, p1, 0);
+		pm[k] = 0;
+	}
+	extend_add(p1, k + 1, p1, k, x1, 0);
+
+	/* p(2) = (x2 * 2 + x1) * 2 + x0 */
+	memset(p2, 0, (k + 1) * sizeof(extend_t));
+	memcpy(p2, x2, r * sizeof(extend_t));
+	extend_product(k + 1, p2, p2, 2);
+	extend_add(p2, k + 1, p2, k, x1, 0);
+	extend_product(k + 1, p2, p2, 2);
+	extend_add(p2, k + 1, p2, k, x0, 0);
+
+	return sign;
+}
+
+/*
+ * with r(t) = c4 * t^4 + c3 * t^3 + c2 * t^2 + c1 * t + c0:
+ *     A  = (r(1) - r(-1)) / 2 = c1 + c3
+ *     c2 = (r(1) + r(-1)) / 2 - c0 - c4
+ *     D  = (r(2) - c0 - 16 * c4 - 4 * c2) / 2 = c1 + 4 * c3
+ *     c3 = (D - A) / 3
+ *     c1 = A - c3
+ * every intermediate value is nonnegative, no signed arithmetic needed.
+ */
+static void
+extend_toom3(extend_t *z, int n, extend_t *x, extend_t *y, extend_t *tmp)
+{
+	int k;
+	int r;
+	int l;
+	int k1;
+	int sign;
+	extend_t *p1;
+	extend_t *pm;
+	extend_t *p2;
+	extend_t *q1;
+	extend_t *qm;
+	extend_t *q2;
+	extend_t *r1;
+	extend_t *rm;
+	extend_t *r2;
+	extend_t *t;
+	extend_t *next;
+
+	k = (n + 2) / 3;
+	r = n - 2 * k;
+	k1 = k + 1;
+	l = 2 * k1;
+
+	p1 = tmp;
+	pm = p1 + k1;
+	p2 = pm + k1;
+	q1 = p2 + k1;
+	qm = q1 + k1;
+	q2 = qm + k1;
+	r1 = q2 + k1;
+	rm = r1 + l;
+	r2 = rm + l;
+	t = r2 + l;
+	next = t + l;
+
+	sign = extend_toom3_evaluate(k, r, x, p1, pm, p2);
+	if (x == y) {
+		q1 = p1;
+		qm = pm;
+		q2 = p2;
+		sign = 0;
+	} else {
+		sign ^= extend_toom3_evaluate(k, r, y, q1, qm, q2);
+	}
+
+	extend_mul_balanced(z, k, x, y, next);
+	memset(z + 2 * k, 0, 2 * k * sizeof(extend_t));
+	extend_mul_balanced(z + 4 * k, r, x + 2 * k, y + 2 * k, next);
+
+	extend_mul_balanced(r1, k1, p1, q1, next);
+	extend_mul_balanced(rm, k1, pm, qm, next);
+	extend_mul_balanced(r2, k1, p2, q2, next);
+
+	/* r1 = A, t = c2 */
+	if (sign) {
+		extend_sub(t, l, r1, l, rm, 0);
+		extend_add(r1, l, r1, l, rm, 0);
+	} else {
+		extend_add(t, l, r1, l, rm, 0);
+		extend_sub(r1, l, r1, l, rm, 0);
+	}
+	extend_quotient(l, r1, r1, 2);
+	extend_quotient(l, t, t, 2);
+	extend_sub(t, l, t, 2 * k, z, 0);
+	extend_sub(t, l, t, 2 * r, z + 4 * k, 0);
+
+	/* r2 = D then c3 */
+	memset(rm, 0, l * sizeof(extend_t));
+	memcpy(rm, z + 4 * k, 2 * r * sizeof(extend_t));
+	extend_product(l, rm, rm, 16);
+	extend_sub(r2, l, r2, 2 * k, z, 0);
+	extend_sub(r2, l, r2, l, rm, 0);
+	extend_product(l, rm, t, 4);
+	extend_sub(r2, l, r2, l, rm, 0);
+	extend_quotient(l, r2, r2, 2);
+	extend_sub(r2, l, r2, l, r1, 0);
+	extend_quotient(l, r2, r2, 3);
+
+	/* r1 = c1 */
+	extend_sub(r1, l, r1, l, r2, 0);
+
+	extend_mul_accumulate(z + k, 2 * n - k, r1, l);
+	extend_mul_accumulate(z + 2 * k, 2 * n - 2 * k, t, l);
+	extend_mul_accumulate(z + 3 * k, 2 * n - 3 * k, r2, l);
+}
+
+static void
+extend_mul_balanced(extend_t *z, int n,
+                    extend_t *x,
+                    extend_t *y,
+                    extend_t *tmp)
+{
+	if (n < EXTEND_KARATSUBA) {
+		if (x == y) {
+			extend_sqr_basecase(z, n, x);
+		} else {
+			extend_mul_basecase(z, n, x, n, y);
+		}
+	} else if (n < EXTEND_TOOM3) {
+		extend_karatsuba(z, n, x, y, tmp);
+	} else {
+		extend_toom3(z, n, x, y, tmp);
+	}
+}
+
+static int
+extend_mul_balanced_tmp(int n)
+{
+	int h;
+	int k1;
+
+	if (n < EXTEND_KARATSUBA) {
+		return 0;
+	}
+
+	if (n < EXTEND_TOOM3) {
+		h = n - n / 2;
+		return 4 * (h + 1) + extend_mul_balanced_tmp(h + 1);
+	}
+
+	k1 = (n + 2) / 3 + 1;
+	return 14 * k1 + extend_mul_balanced_tmp(k1);
+}
+
+int
+extend_mul_tmp(int n, int m)
+{
+	int c;
+	int a;
+	int b;
+
+	if (n < m) {
+		c = n;
+		n = m;
+		m = c;
+	}
+
+	if (m < EXTEND_KARATSUBA) {
+		return 0;
+	}
+
+	if (n == m) {
+		return extend_mul_balanced_tmp(m);
+	}
+
+	/* product buffer of one chunk and tmp of chunk */
+	a = extend_mul_balanced_tmp(m);
+	b = 0;
+	if (n % m) {
+		b = extend_mul_tmp(m, n % m);
+	}
+
+	return 2 * m + (a > b ? a : b);
+}
+
+/*
+ * z[0, n + m) = x * y, `tmp' can be NULL to use schoolbook only
+ */
+unsigned long
+extend_mul(extend_t *z, int n, extend_t *x, int m, extend_t *y, extend_t *tmp)
+{
+	int c;
+	int off;
+	extend_t *w;
+
+	if (n < m) {
+		w = x;
+		x = y;
+		y = w;
+		c = n;
+		n = m;
+		m = c;
+	}
+
+	if (m < EXTEND_KARATSUBA || !tmp) {
+		if (x == y && n == m) {
+			extend_sqr_basecase(z, n, x);
+		} else {
+			extend_mul_basecase(z, n, x, m, y);
+		}
+
+		return 0;
+	}
+
+	if (n == m) {
+		extend_mul_balanced(z, n, x, y, tmp);
+
+		return 0;
+	}
+
+	/* unbalanced, multiply y by every m digits chunk of x */
+	w = tmp;
+	memset(z, 0, (n + m) * sizeof(extend_t));
+	for (off = 0; off < n; off += m) {
+		c = n - off < m ? n - off : m;
+		if (c == m) {
+			extend_mul_balanced(w, m, x + off, y, tmp + 2 * m);
+		} else {
+			extend_mul(w, m, y, c, x + off, tmp + 2 * m);
+		}
+		extend_mul_accumulate(z + off, n + m - off, w, m + c);
 	}
 
-	return carryout;
+	return 0;
 }
 
+/*
+ * Knuth algorithm D, `y' and `x' are shifted until top digit of `y'
+ * have highest bit set, then two digits estimate of every quotient
+ * digit is at most one too large.  `tmp' is n + 2 * m + 2 digits.
+ */
 int
 extend_div(extend_t *q, int n,
            extend_t *x, int m,
@@ -243,12 +663,14 @@ extend_div(extend_t *q, int n,
 {
 	int i;
 	int k;
+	int s;
 
 	int nx;
 	int my;
 
 	extend_t *rem;
 	extend_t *dq;
+	extend_t *yn;
 
 	nx = n;
 	my = m;
@@ -260,50 +682,54 @@ extend_div(extend_t *q, int n,
 		if (y[0] == 0) {
 			return 0;
 		}
-		r[0] = extend_quotient(nx, q, x, y[0]);
-		memset(r + 1, 0, my - 1);
+		r[0] = (extend_t)extend_quotient(nx, q, x, y[0]);
+		memset(r + 1, 0, (my - 1) * sizeof(extend_t));
 	} else if (m > n) {
 		memset(q, 0, nx * sizeof(extend_t));
 		memcpy(r, x, n * sizeof(extend_t));
 		memset(r + n, 0, (my - n) * sizeof(extend_t));
 	} else {
 		rem = tmp;
-		dq = tmp + n + 1;
-		memcpy(rem, x, n * sizeof(extend_t));
-		rem[n] = 0;
+		dq = rem + n + 1;
+		yn = dq + m + 1;
+
+		for (s = 0; ((extend_wide_t)y[m - 1] << s) < EXTEND_BASE / 2; s++) {
+			/* NULL */
+		}
+		extend_shl(m, yn, m, y, s, 0);
+		extend_shl(n + 1, rem, n, x, s, 0);
+
 		for (k = n - m; k >= 0; k--) {
 			int km;
-			unsigned long qk;
-			unsigned long y2;
-			unsigned long r3;
-			unsigned long borrow;
+			extend_wide_t qk;
+			extend_wide_t rk;
+			extend_wide_t r2;
 
 			km = k + m;
-			y2 = y[m - 1] * EXTEND_BASE + y[m-2];
-			r3 = rem[km] * (EXTEND_BASE * EXTEND_BASE) +
-			     rem[km-1] * EXTEND_BASE + rem[km-2];
-
-			qk = r3/y2;
-			if (qk >= EXTEND_BASE) {
-				qk = EXTEND_BASE - 1;
-			}
-			dq[m] = extend_product(m, dq, y, qk);
-			for (i = m; i > 0; i--) {
-				if (rem[i + k] != dq[i]) {
+			r2 = rem[km] * EXTEND_BASE + rem[km - 1];
+			qk = r2 / yn[m - 1];
+			rk = r2 % yn[m - 1];
+			while (qk >= EXTEND_BASE ||
+			       qk * yn[m - 2] > rk * EXTEND_BASE + rem[km - 2])
+			{
+				qk -= 1;
+				rk += yn[m - 1];
+				if (rk >= EXTEND_BASE) {
 					break;
 				}
 			}
-			if (rem[i+k] < dq[i]) {
-				dq[m] = extend_product(m, dq, y, --qk);
+
+			dq[m] = (extend_t)extend_product(m,
+			                                 dq,
+			                                 yn,
+			                                 (unsigned long)qk);
+			if (extend_sub(&rem[k], m + 1, &rem[k], m + 1, dq, 0)) {
+				qk -= 1;
+				extend_add(&rem[k], m + 1, &rem[k], m, yn, 0);
 			}
-			q[k] = qk;
-			borrow = extend_sub(&rem[k], m + 1,
-			                    &rem[k], m + 1,
-			                    dq, 0);
-			(void)borrow;
-			assert(borrow == 0);
+			q[k] = (extend_t)qk;
 		}
-		memcpy(r, rem, m * sizeof(extend_t));
+		extend_shr(m, r, m, rem, s, 0);
 		for (i = n - m + 1; i < nx; i++) {
 			q[i] = 0;
 		}
@@ -315,6 +741,63 @@ extend_div(extend_t *q, int n,
 	return 1;
 }
 
+/*
+ * -1/x mod EXTEND_BASE of odd `x', x * x = 1 mod 8 so start with 3
+ * correct bits, every Newton step double the bits
+ */
+extend_t
+extend_inverse(extend_t x)
+{
+	int i;
+	unsigned long y;
+
+	y = x;
+	for (i = 0; i < 5; i++) {
+		y = y * (2 - (unsigned long)x * y);
+	}
+
+	return (extend_t)((0 - y) % EXTEND_BASE);
+}
+
+/*
+ * Montgomery reduction z[0, n) = t / BASE^n mod m, `m' is odd, `minv'
+ * is extend_inverse(m[0]), `t' is 2 * n + 1 digits less than m * BASE^n
+ * and be destroyed
+ */
+void
+extend_redc(extend_t *z, int n,
+            extend_t *t,
+            extend_t *m, extend_t minv)
+{
+	int i;
+	int j;
+	extend_wide_t u;
+	extend_wide_t carry;
+
+	t[2 * n] = 0;
+	for (i = 0; i < n; i++) {
+		u = (t[i] * (extend_wide_t)minv) % EXTEND_BASE;
+		carry = 0;
+		for (j = 0; j < n; j++) {
+			carry += u * m[j] + t[i + j];
+			t[i + j] = carry % EXTEND_BASE;
+			carry /= EXTEND_BASE;
+		}
+		for (j = i + n; carry; j++) {
+			carry += t[j];
+			t[j] = carry % EXTEND_BASE;
+			carry /= EXTEND_BASE;
+		}
+	}
+
+	/* t / BASE^n < 2 * m */
+	if (t[2 * n] || extend_cmp(n, t + n, m) >= 0) {
+		extend_sub(z, n, t + n, n, m, 0);
+	} else {
+		memmove(z, t + n, n * sizeof(extend_t));
+	}
+}
+
 unsigned long
 extend_sum(int n, extend_t *z, extend_t *x, unsigned long y)
 {
@@ -348,32 +831,32 @@ unsigned long
 extend_product(int n, extend_t *z, extend_t *x, unsigned long y)
 {
 	int i;
-	unsigned long carry;
+	extend_wide_t carry;
 
 	carry = 0;
 	for (i = 0; i < n; i++) {
-		carry += x[i] * y;
+		carry += (extend_wide_t)x[i] * y;
 		z[i] = carry % EXTEND_BASE;
 		carry /= EXTEND_BASE;
 	}
 
-	return carry;
+	return (unsigned long)carry;
 }
 
 unsigned long
 extend_quotient(int n, extend_t *z, extend_t *x, unsigned long y)
 {
 	int i;
-	unsigned long carry;
+	extend_wide_t carry;
 
 	carry = 0;
 	for (i = n - 1; i >= 0; i--) {
 		carry = carry * EXTEND_BASE + x[i];
-		z[i] = carry / y;
+		z[i] = (extend_t)(carry / y);
 		carry %= y;
 	}
 
-	return carry;
+	return (unsigned long)carry;
 }
 
 void
@@ -381,8 +864,9 @@ extend_shl(int n, extend_t *z, int m, extend_t *x, int s, int fill)
 {
 	int i;
 	int j;
+	extend_t f;
 
-	fill = fill ? 0xffffffff : 0;
+	f = fill ? (extend_t)(EXTEND_BASE - 1) : 0;
 	if (n > m) {
 		i = m - 1;
 	} else {
@@ -399,13 +883,13 @@ extend_shl(int n, extend_t *z, int m, extend_t *x, int s, int fill)
 	}
 
 	for (; j >= 0; j--) {
-		z[j] = fill;
+		z[j] = f;
 	}
 
 	s %= EXTEND_BITS;
 	if (s > 0) {
-		extend_product(n, z, z, 1 << s);
-		z[0] |= fill >> (EXTEND_BITS - s);
+		extend_product(n, z, z, 1UL << s);
+		z[0] |= f >> (EXTEND_BITS - s);
 	}
 }
 
@@ -414,21 +898,22 @@ extend_shr(int n, extend_t *z, int m, extend_t *x, int s, int fill)
 {
 	int i;
 	int j;
+	extend_t f;
 
-	fill = fill ? 0xffffffff : 0;
+	f = fill ? (extend_t)(EXTEND_BASE - 1) : 0;
 	j = 0;
 	for (i = s/EXTEND_BITS; i < m && j < n; i++, j++) {
 		z[j] = x[i];
 	}
 
 	for (; j < n; j++) {
-		z[j] = fill;
+		z[j] = f;
 	}
 
 	s %= EXTEND_BITS;
 	if (s > 0) {
-		extend_quotient(n, z, z, 1<<s);
-		z[n-1] |= fill << (EXTEND_BITS - s);
+		extend_quotient(n, z, z, 1UL << s);
+		z[n-1] |= (extend_t)((f << (EXTEND_BITS - s)) % EXTEND_BASE);
 	}
 }
 
@@ -5,10 +5,24 @@
  * ref: David R. Hanson C Interface and Implementation
  */
 
+/*
+ * digit is EXTEND_BITS bits, `extend_wide_t' hold product of two digits.
+ * EXTEND_64 select 62 bits digit, require 64 bits long and `__int128'
+ * (gcc or clang), default is portable 30 bits digit.
+ */
+#ifdef EXTEND_64
+#define EXTEND_BITS 62
+
+typedef unsigned long extend_t;
+__extension__ typedef unsigned __int128 extend_wide_t;
+#else
 #define EXTEND_BITS 30
-#define EXTEND_BASE (1UL << EXTEND_BITS)
 
 typedef unsigned int extend_t;
+typedef unsigned long extend_wide_t;
+#endif
+
+#define EXTEND_BASE ((extend_wide_t)1 << EXTEND_BITS)
 
 unsigned long
 extend_from_long(int n, extend_t *z, unsigned long u);
@@ -16,6 +30,9 @@ extend_from_long(int n, extend_t *z, unsigned long u);
 unsigned long
 extend_to_long(int n, extend_t *x);
 
+unsigned long
+extend_radix(int base, int *k);
+
 unsigned long
 extend_from_str(int n, extend_t *z, const char *str, int base, char **end);
 
@@ -35,10 +52,14 @@ extend_sub(extend_t *z, int n,
            extend_t *x, int m,
            extend_t *y, unsigned long borrow);
 
+int
+extend_mul_tmp(int n, int m);
+
 unsigned long
 extend_mul(extend_t *z, int n,
            extend_t *x, int m,
-           extend_t *y);
+           extend_t *y,
+           extend_t *tmp);
 
 int
 extend_div(extend_t *q, int n,
@@ -47,6 +68,14 @@ extend_div(extend_t *q, int n,
            extend_t *r,
            extend_t *tmp);
 
+extend_t
+extend_inverse(extend_t x);
+
+void
+extend_redc(extend_t *z, int n,
+            extend_t *t,
+            extend_t *m, extend_t minv);
+
 unsigned long
 extend_sum(int n, extend_t *z, extend_t *x, unsigned long y);
 
@@ -0,0 +1,771 @@
+#include "lemon.h"
+#include "arena.h"
+#include "opcode.h"
+#include "generator.h"
+#include "flowgraph.h"
+
+#include <string.h>
+
+/*
+ * flowgraph split function body into basic blocks, propagate constant
+ * and copy of locals through blocks, rewrite `load' of known local,
+ * turn `store' of dead local into `pop' and remove unreachable code.
+ *
+ * only function body is optimized, locals of module are visible as
+ * module attribute.  body has `try' is skipped (exception edges are not
+ * in graph) and local accessed by inner function is never tracked.
+ *
+ * `callcc' continuation can resume frame after any code may call Lemon
+ * code with frame's locals at the time of resume, so every such code
+ * and `return' feed a `resume' state and every such code merge it back.
+ */
+
+#define VALUE_TOP     (-1)      /* not reached yet */
+#define VALUE_UNKNOWN (-2)
+#define VALUE_COPY    (1 << 24) /* value >= VALUE_COPY is copy of local */
+
+#define IS_OPCODE(a,b) ((a) && (a)->opcode == (b))
+#define IS_LOCAL(g,a) ((a)->arg[0].value == 0 && \
+                       !(g)->captured[(a)->arg[1].value])
+
+#define PREV(a) generator_prev(lemon, (a))
+#define NEXT(a) generator_next(lemon, (a))
+
+struct flowgraph_unit {
+	int skip;
+	int nlocals;
+	char *captured; /* local accessed by inner function */
+	struct generator_code *define;
+	struct generator_code *exit; /* label after function body */
+
+	struct flowgraph_unit *next;
+	struct flowgraph_unit *parent;
+};
+
+struct flowgraph_block {
+	int visited;
+	int nsuccs;
+	int succs[3];
+	int *values; /* value of locals on entry */
+	char *live; /* live locals on entry */
+
+	struct generator_code *head;
+	struct generator_code *tail;
+};
+
+struct flowgraph {
+	int nlocals;
+	int nblocks;
+	int changed;
+	char *captured;
+
+	int *resume; /* merged values of locals frame can be resumed */
+	char *resume_live;
+
+	struct flowgraph_block *blocks;
+	struct generator_code *exit;
+};
+
+static int
+flowgraph_may_call(struct generator_code *code)
+{
+	switch (code->opcode) {
+	case -1:
+	case OPCODE_NOP:
+	case OPCODE_POP:
+	case OPCODE_DUP:
+	case OPCODE_SWAP:
+	case OPCODE_LOAD:
+	case OPCODE_STORE:
+	case OPCODE_CONST:
+	case OPCODE_JMP:
+	case OPCODE_INLINE:
+	case OPCODE_ARRAY:
+	case OPCODE_DEFINE:
+	case OPCODE_LAZY:
+	case OPCODE_RETURN:
+		return 0;
+
+	default:
+		return 1;
+	}
+}
+
+static int
+flowgraph_is_leave(struct generator_code *code)
+{
+	switch (code->opcode) {
+	case OPCODE_JZ:
+	case OPCODE_JNZ:
+	case OPCODE_JMP:
+	case OPCODE_INLINE:
+	case OPCODE_FORITER:
+	case OPCODE_THROW:
+	case OPCODE_RETURN:
+	case OPCODE_DEFINE:
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+static struct generator_code *
+flowgraph_next(struct lemon *lemon, struct generator_code *code)
+{
+	/* `define' jump over inner function body to its end label */
+	if (code->opcode == OPCODE_DEFINE) {
+		return generator_label_code(lemon, code->arg[4].label);
+	}
+
+	return NEXT(code);
+}
+
+static void *
+flowgraph_alloc(struct lemon *lemon, long size)
+{
+	void *p;
+
+	p = arena_alloc(lemon, lemon->l_arena, size);
+	if (p) {
+		memset(p, 0, size);
+	}
+
+	return p;
+}
+
+static struct flowgraph_unit *
+flowgraph_units(struct lemon *lemon)
+{
+	int level;
+	int local;
+	struct generator_code *code;
+	struct generator_label *label;
+	struct flowgraph_unit *up;
+	struct flowgraph_unit *unit;
+	struct flowgraph_unit *curr;
+	struct flowgraph_unit *units;
+
+	curr = NULL;
+	units = NULL;
+	for (code = generator_first(lemon); code; code = NEXT(code)) {
+		while (curr && code == curr->exit) {
+			curr = curr->parent;
+		}
+
+		if (code->opcode == OPCODE_DEFINE ||
+		    code->opcode == OPCODE_MODULE)
+		{
+			unit = flowgraph_alloc(lemon, sizeof(*unit));
+			if (!unit) {
+				return NULL;
+			}
+			unit->define = code;
+			if (code->opcode == OPCODE_DEFINE) {
+				unit->nlocals = code->arg[3].value;
+				label = code->arg[4].label;
+				unit->exit = generator_label_code(lemon, label);
+			} else {
+				/* module frame is other frame's upframe */
+				unit->skip = 1;
+				label = code->arg[1].label;
+				unit->exit = generator_label_code(lemon, label);
+				for (up = curr; up; up = up->parent) {
+					up->skip = 1;
+				}
+			}
+			unit->captured = flowgraph_alloc(lemon,
+			                                 unit->nlocals + 1);
+			if (!unit->captured) {
+				return NULL;
+			}
+			unit->parent = curr;
+			unit->next = units;
+			units = unit;
+			curr = unit;
+
+			continue;
+		}
+
+		if (!curr) {
+			continue;
+		}
+
+		switch (code->opcode) {
+		case OPCODE_TRY:
+		case OPCODE_UNTRY:
+		case OPCODE_LOADEXC:
+			curr->skip = 1;
+			break;
+
+		case OPCODE_LOAD:
+		case OPCODE_STORE:
+			level = code->arg[0].value;
+			local = code->arg[1].value;
+			for (up = curr; up && level > 0; level--) {
+				up = up->parent;
+			}
+			if (!up || up->define->opcode != OPCODE_DEFINE) {
+				break;
+			}
+			if (local >= up->nlocals) {
+				up->skip = 1;
+			} else if (up != curr) {
+				up->captured[local] = 1;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return units;
+}
+
+static int
+flowgraph_find(struct lemon *lemon,
+               struct flowgraph *graph,
+               struct generator_label *label)
+{
+	int i;
+
+	i = label->block;
+	if (i < 0 || i >= graph->nblocks) {
+		return -1;
+	}
+	if (graph->blocks[i].head != generator_label_code(lemon, label)) {
+		return -1;
+	}
+
+	return i;
+}
+
+static int
+flowgraph_build(struct lemon *lemon,
+                struct flowgraph *graph,
+                struct flowgraph_unit *unit)
+{
+	int i;
+	int n;
+	int nblocks;
+	struct generator_code *code;
+	struct generator_code *prev;
+	struct flowgraph_block *block;
+
+	graph->nlocals = unit->nlocals;
+	graph->captured = unit->captured;
+	graph->exit = unit->exit;
+	graph->changed = 0;
+
+	/* block start from label or code after jump */
+	nblocks = 0;
+	prev = NULL;
+	code = NEXT(unit->define);
+	for (; code != unit->exit; code = flowgraph_next(lemon, code)) {
+		if (!code) {
+			return 0;
+		}
+		if (!prev || code->opcode == -1 || flowgraph_is_leave(prev)) {
+			nblocks += 1;
+		}
+		prev = code;
+	}
+	if (!nblocks) {
+		return 0;
+	}
+
+	n = sizeof(struct flowgraph_block) * nblocks;
+	graph->blocks = flowgraph_alloc(lemon, n);
+	graph->resume = flowgraph_alloc(lemon, sizeof(int) * graph->nlocals);
+	graph->resume_live = flowgraph_alloc(lemon, graph->nlocals + 1);
+	if (!graph->blocks || !graph->resume || !graph->resume_live) {
+		return 0;
+	}
+	graph->nblocks = nblocks;
+	for (i = 0; i < graph->nlocals; i++) {
+		graph->resume[i] = VALUE_TOP;
+	}
+
+	block = NULL;
+	prev = NULL;
+	code = NEXT(unit->define);
+	for (; code != unit->exit; code = flowgraph_next(lemon, code)) {
+		if (!prev || code->opcode == -1 || flowgraph_is_leave(prev)) {
+			block = block ? block + 1 : graph->blocks;
+			block->head = code;
+			if (code->opcode == -1) {
+				code->label->block = block - graph->blocks;
+			}
+		}
+		block->tail = code;
+		prev = code;
+	}
+
+	for (i = 0; i < nblocks; i++) {
+		block = &graph->blocks[i];
+		block->values = flowgraph_alloc(lemon,
+		                                sizeof(int) * graph->nlocals);
+		block->live = flowgraph_alloc(lemon, graph->nlocals + 1);
+		if (!block->values || !block->live) {
+			return 0;
+		}
+
+		code = block->tail;
+		switch (code->opcode) {
+		case OPCODE_FORITER:
+			n = flowgraph_find(lemon, graph, code->arg[2].label);
+			if (n < 0) {
+				return 0;
+			}
+			block->succs[block->nsuccs++] = n;
+			/* fallthrough */
+
+		case OPCODE_INLINE:
+			/* arg[0] is entry of other function */
+			n = flowgraph_find(lemon, graph, code->arg[1].label);
+			if (n < 0) {
+				return 0;
+			}
+			block->succs[block->nsuccs++] = n;
+			if (i + 1 < nblocks) {
+				block->succs[block->nsuccs++] = i + 1;
+			}
+			break;
+
+		case OPCODE_JZ:
+		case OPCODE_JNZ:
+		case OPCODE_JMP:
+			n = flowgraph_find(lemon, graph, code->arg[0].label);
+			if (n < 0) {
+				/* jump out of function body */
+				return 0;
+			}
+			block->succs[block->nsuccs++] = n;
+			if (code->opcode == OPCODE_JMP) {
+				break;
+			}
+			/* fallthrough */
+
+		default:
+			if (i + 1 < nblocks) {
+				block->succs[block->nsuccs++] = i + 1;
+			}
+			break;
+
+		case OPCODE_THROW:
+		case OPCODE_RETURN:
+			break;
+		}
+	}
+
+	return 1;
+}
+
+static int
+flowgraph_meet(int a, int b)
+{
+	if (a == VALUE_TOP) {
+		return b;
+	}
+	if (b == VALUE_TOP || a == b) {
+		return a;
+	}
+
+	return VALUE_UNKNOWN;
+}
+
+static int
+flowgraph_merge(int n, int *a, int *b)
+{
+	int i;
+	int v;
+	int changed;
+
+	changed = 0;
+	for (i = 0; i < n; i++) {
+		v = flowgraph_meet(a[i], b[i]);
+		if (v != a[i]) {
+			a[i] = v;
+			changed = 1;
+		}
+	}
+
+	return changed;
+}
+
+static int
+flowgraph_stored(struct flowgraph *graph,
+                 int *values,
+                 struct generator_code *a,
+                 struct generator_code *b)
+{
+	/*
+	 * value of `store' after `a', `b' is code before `a'
+	 *
+	 *    CONST/LOAD           CONST/LOAD
+	 *    STORE                DUP
+	 *                         STORE
+	 */
+
+	int v;
+
+	if (IS_OPCODE(a, OPCODE_DUP)) {
+		a = b;
+	}
+
+	if (IS_OPCODE(a, OPCODE_CONST)) {
+		return a->arg[0].value;
+	}
+
+	if (IS_OPCODE(a, OPCODE_LOAD) && IS_LOCAL(graph, a)) {
+		v = values[a->arg[1].value];
+		if (v >= 0) {
+			return v;
+		}
+		return VALUE_COPY + a->arg[1].value;
+	}
+
+	return VALUE_UNKNOWN;
+}
+
+static int
+flowgraph_propagate(struct lemon *lemon,
+                    struct flowgraph *graph,
+                    struct flowgraph_block *block,
+                    int *values,
+                    int rewrite)
+{
+	int i;
+	int v;
+	int local;
+	int changed;
+	struct generator_code *a;
+	struct generator_code *b;
+	struct generator_code *code;
+
+	a = NULL;
+	b = NULL;
+	changed = 0;
+	for (code = block->head; ; code = NEXT(code)) {
+		if (flowgraph_may_call(code)) {
+			changed |= flowgraph_merge(graph->nlocals,
+			                           graph->resume,
+			                           values);
+			flowgraph_merge(graph->nlocals, values, graph->resume);
+		}
+
+		switch (code->opcode) {
+		case OPCODE_LOAD:
+			if (!rewrite || !IS_LOCAL(graph, code)) {
+				break;
+			}
+			v = values[code->arg[1].value];
+			if (v >= VALUE_COPY) {
+				code->arg[1].value = v - VALUE_COPY;
+				graph->changed += 1;
+			} else if (v >= 0) {
+				code->opcode = OPCODE_CONST;
+				code->nargs = 0;
+				generator_add_arg(lemon, code, 4, v);
+				graph->changed += 1;
+			}
+			break;
+
+		case OPCODE_STORE:
+			if (!IS_LOCAL(graph, code)) {
+				break;
+			}
+			local = code->arg[1].value;
+			v = flowgraph_stored(graph, values, a, b);
+			if (v == VALUE_COPY + local) {
+				/* store local to itself */
+				break;
+			}
+			for (i = 0; i < graph->nlocals; i++) {
+				if (values[i] == VALUE_COPY + local) {
+					values[i] = VALUE_UNKNOWN;
+				}
+			}
+			values[local] = v;
+			break;
+
+		case OPCODE_RETURN:
+			changed |= flowgraph_merge(graph->nlocals,
+			                           graph->resume,
+			                           values);
+			break;
+
+		default:
+			break;
+		}
+
+		if (code == block->tail) {
+			break;
+		}
+		b = a;
+		a = code;
+	}
+
+	return changed;
+}
+
+static void
+flowgraph_propagate_values(struct lemon *lemon, struct flowgraph *graph)
+{
+	int i;
+	int j;
+	int n;
+	int changed;
+	int *values;
+	size_t size;
+	struct flowgraph_block *block;
+	struct flowgraph_block *succ;
+
+	n = graph->nlocals;
+	size = sizeof(int) * n;
+	values = flowgraph_alloc(lemon, size + sizeof(int));
+	if (!values) {
+		return;
+	}
+
+	/* locals on entry are arguments, nil or left by last loop */
+	block = &graph->blocks[0];
+	block->visited = 1;
+	for (i = 0; i < n; i++) {
+		block->values[i] = VALUE_UNKNOWN;
+	}
+
+	do {
+		changed = 0;
+		for (i = 0; i < graph->nblocks; i++) {
+			block = &graph->blocks[i];
+			if (!block->visited) {
+				continue;
+			}
+
+			memcpy(values, block->values, size);
+			changed |= flowgraph_propagate(lemon,
+			                               graph,
+			                               block,
+			                               values,
+			                               0);
+			for (j = 0; j < block->nsuccs; j++) {
+				succ = &graph->blocks[block->succs[j]];
+				if (!succ->visited) {
+					succ->visited = 1;
+					memcpy(succ->values, values, size);
+					changed = 1;
+				} else {
+					changed |= flowgraph_merge(n,
+					                           succ->values,
+					                           values);
+				}
+			}
+		}
+	} while (changed);
+
+	for (i = 0; i < graph->nblocks; i++) {
+		block = &graph->blocks[i];
+		if (block->visited) {
+			memcpy(values, block->values, size);
+			flowgraph_propagate(lemon, graph, block, values, 1);
+		}
+	}
+}
+
+static int
+flowgraph_union(int n, char *a, char *b)
+{
+	int i;
+	int changed;
+
+	changed = 0;
+	for (i = 0; i < n; i++) {
+		if (b[i] && !a[i]) {
+			a[i] = 1;
+			changed = 1;
+		}
+	}
+
+	return changed;
+}
+
+static int
+flowgraph_liveness(struct lemon *lemon,
+                   struct flowgraph *graph,
+                   struct flowgraph_block *block,
+                   char *live,
+                   int rewrite)
+{
+	int i;
+	int n;
+	int local;
+	int changed;
+	struct generator_code *code;
+
+	/* live locals on exit */
+	n = graph->nlocals;
+	memset(live, 0, n);
+	for (i = 0; i < block->nsuccs; i++) {
+		flowgraph_union(n, live, graph->blocks[block->succs[i]].live);
+	}
+	if (!block->nsuccs) {
+		flowgraph_union(n, live, graph->resume_live);
+	}
+
+	changed = 0;
+	for (code = block->tail; ; code = PREV(code)) {
+		switch (code->opcode) {
+		case OPCODE_LOAD:
+			if (code->arg[0].value == 0) {
+				live[code->arg[1].value] = 1;
+			}
+			break;
+
+		case OPCODE_FORITER:
+			live[code->arg[0].value] = 1;
+			break;
+
+		case OPCODE_STORE:
+			if (!IS_LOCAL(graph, code)) {
+				break;
+			}
+			local = code->arg[1].value;
+			if (rewrite && !live[local]) {
+				code->opcode = OPCODE_POP;
+				code->nargs = 0;
+				graph->changed += 1;
+			}
+			live[local] = 0;
+			break;
+
+		case OPCODE_RETURN:
+			flowgraph_union(n, live, graph->resume_live);
+			break;
+
+		default:
+			break;
+		}
+
+		if (flowgraph_may_call(code)) {
+			changed |= flowgraph_union(n, graph->resume_live, live);
+			flowgraph_union(n, live, graph->resume_live);
+		}
+
+		if (code == block->head) {
+			break;
+		}
+	}
+
+	return changed;
+}
+
+static void
+flowgraph_eliminate_stores(struct lemon *lemon, struct flowgraph *graph)
+{
+	int i;
+	int changed;
+	char *live;
+	struct flowgraph_block *block;
+
+	live = flowgraph_alloc(lemon, graph->nlocals + 1);
+	if (!live) {
+		return;
+	}
+
+	do {
+		changed = 0;
+		for (i = graph->nblocks - 1; i >= 0; i--) {
+			block = &graph->blocks[i];
+			if (!block->visited) {
+				continue;
+			}
+
+			changed |= flowgraph_liveness(lemon,
+			                              graph,
+			                              block,
+			                              live,
+			                              0);
+			changed |= flowgraph_union(graph->nlocals,
+			                           block->live,
+			                           live);
+		}
+	} while (changed);
+
+	for (i = 0; i < graph->nblocks; i++) {
+		block = &graph->blocks[i];
+		if (block->visited) {
+			flowgraph_liveness(lemon, graph, block, live, 1);
+		}
+	}
+}
+
+static void
+flowgraph_eliminate_blocks(struct lemon *lemon, struct flowgraph *graph)
+{
+	int i;
+	struct flowgraph_block *block;
+	struct generator_code *code;
+	struct generator_code *next;
+	struct generator_code *inner;
+
+	for (i = 0; i < graph->nblocks; i++) {
+		block = &graph->blocks[i];
+		if (block->visited) {
+			continue;
+		}
+
+		code = block->head;
+		for (;;) {
+			next = flowgraph_next(lemon, code);
+			if (code->opcode == OPCODE_DEFINE) {
+				/* inner function body is unreachable too */
+				while ((inner = NEXT(code)) != next) {
+					generator_delete_code(lemon, inner);
+				}
+			}
+
+			/* no reference label is removed by peephole */
+			if (code->opcode != -1) {
+				generator_delete_code(lemon, code);
+				graph->changed += 1;
+			}
+
+			if (code == block->tail) {
+				break;
+			}
+			code = next;
+		}
+	}
+}
+
+int
+flowgraph_optimize(struct lemon *lemon)
+{
+	int changed;
+	struct flowgraph graph;
+	struct flowgraph_unit *unit;
+
+	changed = 0;
+	for (unit = flowgraph_units(lemon); unit; unit = unit->next) {
+		/* unreachable inner function is deleted with outer's block */
+		if (unit->skip || unit->define->opcode == -2) {
+			continue;
+		}
+
+		memset(&graph, 0, sizeof(graph));
+		if (!flowgraph_build(lemon, &graph, unit)) {
+			continue;
+		}
+
+		flowgraph_propagate_values(lemon, &graph);
+		flowgraph_eliminate_stores(lemon, &graph);
+		flowgraph_eliminate_blocks(lemon, &graph);
+
+		changed += graph.changed;
+	}
+	generator_compact(lemon);
+
+	return changed;
+}
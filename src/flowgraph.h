@@ -0,0 +1,10 @@
+#ifndef LEMON_FLOWGRAPH_H
+#define LEMON_FLOWGRAPH_H
+
+/*
+ * return count of rewritten codes, 0 if nothing changed
+ */
+int
+flowgraph_optimize(struct lemon *lemon);
+
+#endif /* LEMON_FLOWGRAPH_H */
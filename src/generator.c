@@ -1,7 +1,7 @@
 #include "lemon.h"
 #include "arena.h"
 #include "opcode.h"
-#include "machine.h"
+#include "lcode.h"
 #include "generator.h"
 
 #include <stdio.h>
@@ -20,62 +20,67 @@ generator_create(struct lemon *lemon)
 	return generator;
 }
 
-struct generator_arg *
-generator_make_arg(struct lemon *lemon,
-                   int type,
-                   int size,
-                   int value)
+void
+generator_reset(struct lemon *lemon)
 {
-	struct generator_arg *arg;
-
-	arg = arena_alloc(lemon, lemon->l_arena, sizeof(*arg));
-	if (arg) {
-		memset(arg, 0, sizeof(*arg));
-		arg->type = type;
-		arg->size = size;
-		arg->value = value;
-	}
+	struct generator *generator;
 
-	return arg;
+	generator = lemon->l_generator;
+	lemon_allocator_free(lemon, generator->codes);
+	lemon_allocator_free(lemon, generator->cpool);
+	memset(generator, 0, sizeof(*generator));
 }
 
-struct generator_arg *
-generator_make_arg_label(struct lemon *lemon,
-                         struct generator_label *label)
+int
+generator_add_const(struct lemon *lemon, struct lobject *object)
 {
-	struct generator_arg *arg;
+	int i;
+	int cpoollen;
+	struct generator *gen;
+	struct lobject **cpool;
+
+	gen = lemon->l_generator;
+	for (i = 0; i < gen->ncpool; i++) {
+		if (object == gen->cpool[i]) {
+			return i;
+		}
+
+		if (lobject_is_pointer(lemon, object) &&
+		    lobject_is_pointer(lemon, gen->cpool[i]) &&
+		    object->l_method == gen->cpool[i]->l_method &&
+		    lobject_is_equal(lemon, object, gen->cpool[i]))
+		{
+			return i;
+		}
+	}
 
-	arg = generator_make_arg(lemon, 1, 4, 0);
-	if (arg) {
-		arg->label = label;
+	if (gen->ncpool == gen->cpoollen) {
+		if (gen->cpoollen) {
+			cpoollen = gen->cpoollen * 2;
+		} else {
+			cpoollen = 64;
+		}
+		cpool = lemon_allocator_realloc(lemon,
+		                                gen->cpool,
+		                                sizeof(*cpool) * cpoollen);
+		if (!cpool) {
+			return -1;
+		}
+		gen->cpool = cpool;
+		gen->cpoollen = cpoollen;
 	}
+	gen->cpool[gen->ncpool] = object;
 
-	return arg;
+	return gen->ncpool++;
 }
 
-struct generator_code *
-generator_make_code(struct lemon *lemon,
-                    int opcode,
-                    struct generator_arg *arg1,
-                    struct generator_arg *arg2,
-                    struct generator_arg *arg3,
-                    struct generator_arg *arg4,
-                    struct generator_arg *arg5)
+struct lobject *
+generator_get_const(struct lemon *lemon, int pool)
 {
-	struct generator_code *code;
-
-	code = arena_alloc(lemon, lemon->l_arena, sizeof(*code));
-	if (code) {
-		memset(code, 0, sizeof(*code));
-		code->opcode = opcode;
-		code->arg[0] = arg1;
-		code->arg[1] = arg2;
-		code->arg[2] = arg3;
-		code->arg[3] = arg4;
-		code->arg[4] = arg5;
-	}
+	struct generator *gen;
 
-	return code;
+	gen = lemon->l_generator;
+	return gen->cpool[pool];
 }
 
 struct generator_label *
@@ -86,94 +91,127 @@ generator_make_label(struct lemon *lemon)
 	label = arena_alloc(lemon, lemon->l_arena, sizeof(*label));
 	if (label) {
 		memset(label, 0, sizeof(*label));
+		label->code = -1;
 	}
 
 	return label;
 }
 
-struct generator_code *
-generator_emit_code(struct lemon *lemon,
-                    struct generator_code *code)
+static struct generator_code *
+generator_append(struct lemon *lemon, int opcode)
 {
-	int i;
+	long capacity;
 	struct generator *gen;
+	struct generator_code *code;
+	struct generator_code *codes;
 
 	gen = lemon->l_generator;
-	gen->address += 1;
-	code->prev = gen->tail;
-	if (gen->tail) {
-		gen->tail->next = code;
-	}
-	gen->tail = code;
-	if (!gen->head) {
-		gen->head = code;
-	}
-	code->address = gen->address;
-
-	for (i = 0; i < MAX_ARG; i++) {
-		if (code->arg[i] &&
-		    code->arg[i]->type == 1 &&
-		    code->arg[i]->label)
-		{
-			code->arg[i]->label->count += 1;
+	if (gen->ncodes == gen->capacity) {
+		if (gen->capacity) {
+			capacity = gen->capacity * 2;
+		} else {
+			capacity = 256;
+		}
+		codes = lemon_allocator_realloc(lemon,
+		                                gen->codes,
+		                                sizeof(*codes) * capacity);
+		if (!codes) {
+			return NULL;
 		}
+		gen->codes = codes;
+		gen->capacity = capacity;
 	}
+	code = &gen->codes[gen->ncodes++];
+	memset(code, 0, sizeof(*code));
+	code->opcode = opcode;
 
 	return code;
 }
 
-void
-generator_insert_code(struct lemon *lemon,
-                      struct generator_code *code,
-                      struct generator_code *newcode)
+static int
+generator_index(struct lemon *lemon, struct generator_code *code)
 {
-	newcode->prev = code->prev;
-	newcode->next = code;
-	if (code->prev) {
-		code->prev->next = newcode;
-	}
+	struct generator *gen;
+
+	gen = lemon->l_generator;
+	return (int)(code - gen->codes);
 }
 
 void
-generator_delete_code(struct lemon *lemon,
-                      struct generator_code *code)
+generator_add_arg(struct lemon *lemon,
+                  struct generator_code *code,
+                  int size,
+                  int value)
 {
-	int i;
-	struct generator *gen;
+	struct generator_arg *arg;
 
-	if (code->dead) {
-		return;
-	}
+	arg = &code->arg[code->nargs++];
+	arg->type = 0;
+	arg->size = (short)size;
+	arg->value = value;
+	arg->label = NULL;
+}
 
-	gen = lemon->l_generator;
-	if (code == gen->head) {
-		gen->head = code->next;
-	}
+void
+generator_add_arg_label(struct lemon *lemon,
+                        struct generator_code *code,
+                        struct generator_label *label)
+{
+	struct generator_arg *arg;
 
-	if (code == gen->tail) {
-		gen->tail = code->prev;
+	arg = &code->arg[code->nargs++];
+	arg->type = 1;
+	arg->size = 4;
+	arg->value = 0;
+	arg->label = label;
+	/* placeholder of `define' and `module' has no label until patch */
+	if (label) {
+		label->count += 1;
 	}
+}
 
-	if (code->prev) {
-		code->prev->next = code->next;
-	}
+void
+generator_clear_args(struct lemon *lemon,
+                     struct generator_code *code)
+{
+	int i;
 
-	if (code->next) {
-		code->next->prev = code->prev;
+	for (i = 0; i < code->nargs; i++) {
+		if (code->arg[i].type == 1 && code->arg[i].label) {
+			code->arg[i].label->count -= 1;
+		}
 	}
+	code->nargs = 0;
+}
 
-	code->dead = 1;
-	code->prev = NULL;
-	code->next = NULL;
+int
+generator_emit_code(struct lemon *lemon,
+                    struct generator_code *code)
+{
+	int i;
+	struct generator_code copy;
+	struct generator_code *newcode;
 
-	for (i = 0; i < MAX_ARG; i++) {
-		if (code->arg[i] &&
-		    code->arg[i]->type == 1 &&
-		    code->arg[i]->label)
-		{
-			code->arg[i]->label->count -= 1;
+	/* `code' may point into codes array, which append may move */
+	copy = *code;
+	newcode = generator_append(lemon, copy.opcode);
+	if (!newcode) {
+		return -1;
+	}
+	for (i = 0; i < copy.nargs; i++) {
+		if (copy.arg[i].type == 1) {
+			generator_add_arg_label(lemon,
+			                        newcode,
+			                        copy.arg[i].label);
+		} else {
+			generator_add_arg(lemon,
+			                  newcode,
+			                  copy.arg[i].size,
+			                  copy.arg[i].value);
 		}
 	}
+
+	return generator_index(lemon, newcode);
 }
 
 void
@@ -182,381 +220,469 @@ generator_emit_label(struct lemon *lemon,
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon, -1, NULL, NULL, NULL, NULL, NULL);
-	code->label = label;
-	label->code = code;
-	generator_emit_code(lemon, code);
+	code = generator_append(lemon, -1);
+	if (code) {
+		code->label = label;
+		label->code = generator_index(lemon, code);
+	}
 }
 
-void
-generator_patch_arg_label(struct lemon *lemon,
-                          struct generator_arg *arg,
-                          struct generator_label *label)
+struct generator_code *
+generator_get_code(struct lemon *lemon, int index)
 {
-	int address;
+	struct generator *gen;
 
-	address = arg->address;
-	if (arg->type == 1) {
-		machine_set_code4(lemon, address, label->address);
-	} else {
-		printf("patch wrong arg\n");
-	}
+	gen = lemon->l_generator;
+	return &gen->codes[index];
 }
 
 struct generator_code *
-generator_patch_code(struct lemon *lemon,
-                     struct generator_code *oldcode,
-                     struct generator_code *newcode)
+generator_label_code(struct lemon *lemon, struct generator_label *label)
 {
-	int i;
-	struct generator_code *prev;
-	struct generator_code *next;
+	if (label->code < 0) {
+		return NULL;
+	}
+
+	return generator_get_code(lemon, label->code);
+}
 
-	prev = oldcode->prev;
-	next = oldcode->next;
+struct generator_code *
+generator_first(struct lemon *lemon)
+{
+	struct generator *gen;
 
-	newcode->prev = prev;
-	if (prev) {
-		prev->next = newcode;
+	gen = lemon->l_generator;
+	if (!gen->ncodes) {
+		return NULL;
 	}
-	newcode->next = next;
-	if (next) {
-		next->prev = newcode;
+	if (gen->codes[0].opcode == -2) {
+		return generator_next(lemon, gen->codes);
 	}
-	oldcode->dead = 1;
-	oldcode->next = NULL;
-	oldcode->prev = NULL;
 
-	for (i = 0; i < MAX_ARG; i++) {
-		if (oldcode->arg[i] &&
-		    oldcode->arg[i]->type == 1 &&
-		    oldcode->arg[i]->label)
-		{
-			oldcode->arg[i]->label->count -= 1;
+	return gen->codes;
+}
+
+struct generator_code *
+generator_prev(struct lemon *lemon, struct generator_code *code)
+{
+	struct generator *gen;
+
+	gen = lemon->l_generator;
+	while (code > gen->codes) {
+		code -= 1;
+		if (code->opcode != -2) {
+			return code;
 		}
-		if (newcode->arg[i] &&
-		    newcode->arg[i]->type == 1 &&
-		    newcode->arg[i]->label)
-		{
-			newcode->arg[i]->label->count -= 1;
+	}
+
+	return NULL;
+}
+
+struct generator_code *
+generator_next(struct lemon *lemon, struct generator_code *code)
+{
+	struct generator *gen;
+	struct generator_code *end;
+
+	gen = lemon->l_generator;
+	end = gen->codes + gen->ncodes;
+	for (code += 1; code < end; code++) {
+		if (code->opcode != -2) {
+			return code;
 		}
 	}
 
-	return newcode;
+	return NULL;
 }
 
 void
-generator_generator_label(struct lemon *lemon,
-                          struct generator_label *label)
+generator_delete_code(struct lemon *lemon,
+                      struct generator_code *code)
 {
-	struct generator_arg *arg;
-
-	label->address = lemon_machine_get_pc(lemon);
-	for (arg = label->prevlabel;
-	     arg;
-	     arg = arg->prevlabel)
-	{
-		generator_patch_arg_label(lemon, arg, label);
+	if (code->opcode == -2) {
+		return;
 	}
+
+	generator_clear_args(lemon, code);
+	code->opcode = -2;
 }
 
 void
-generator_generator_code(struct lemon *lemon,
-                         struct generator_code *code)
+generator_compact(struct lemon *lemon)
 {
-	int i;
-	struct generator_arg *arg;
-	struct generator_label *label;
+	long i;
+	long n;
+	struct generator *gen;
+	struct generator_code *code;
 
-	machine_add_code1(lemon, code->opcode);
-	for (i = 0; i < MAX_ARG; i++) {
-		arg = code->arg[i];
-		if (!arg) {
-			break;
+	n = 0;
+	gen = lemon->l_generator;
+	for (i = 0; i < gen->ncodes; i++) {
+		code = &gen->codes[i];
+		if (code->opcode == -2) {
+			continue;
 		}
-		arg->address = lemon_machine_get_pc(lemon);
-		if (arg->type == 1) {
-			label = arg->label;
-			machine_add_code4(lemon, label->address);
-
-			if (label->address == 0) {
-				arg->prevlabel = label->prevlabel;
-				label->prevlabel = arg;
-			}
-		} else {
-			/* current only 1 byte code and 4 byte code */
-			if (arg->size == 1) {
-				machine_add_code1(lemon, arg->value);
-			} else if (arg->size == 4) {
-				machine_add_code4(lemon, arg->value);
-			}
+		if (code->opcode == -1) {
+			code->label->code = (int)n;
+		}
+		if (i != n) {
+			gen->codes[n] = *code;
 		}
+		n += 1;
 	}
+	gen->ncodes = n;
 }
 
-void
+static int
+generator_code_size(struct generator_code *code)
+{
+	int i;
+	int size;
+
+	size = 1;
+	for (i = 0; i < code->nargs; i++) {
+		size += code->arg[i].size;
+	}
+
+	return size;
+}
+
+static void
+generator_write4(unsigned char *p, int value)
+{
+	p[0] = (unsigned char)((value >> 24) & 0xFF);
+	p[1] = (unsigned char)((value >> 16) & 0xFF);
+	p[2] = (unsigned char)((value >> 8)  & 0xFF);
+	p[3] = (unsigned char)(value         & 0xFF);
+}
+
+struct lobject *
 generator_emit(struct lemon *lemon)
 {
-	struct machine *machine;
+	int i;
+	int j;
+	int pc;
+	unsigned char *bytes;
+	struct lcode *lcode;
 	struct generator *gen;
+	struct generator_arg *arg;
 	struct generator_code *code;
 
+	/* every code's size is known, resolve labels before write */
 	gen = lemon->l_generator;
-	for (code = gen->head; code; code = code->next) {
+	pc = 0;
+	for (i = 0; i < gen->ncodes; i++) {
+		code = &gen->codes[i];
 		if (code->opcode == -1) {
-			generator_generator_label(lemon, code->label);
-		} else if (code->opcode != OPCODE_NOP) {
-			generator_generator_code(lemon, code);
+			code->label->address = pc;
+		} else if (code->opcode >= 0 && code->opcode != OPCODE_NOP) {
+			pc += generator_code_size(code);
 		}
 	}
-	machine = lemon->l_machine;
-	machine->maxpc = lemon_machine_get_pc(lemon);
+
+	lcode = lcode_create(lemon, pc, gen->ncpool, gen->cpool);
+	if (!lcode) {
+		return NULL;
+	}
+
+	pc = 0;
+	bytes = lcode->code;
+	for (i = 0; i < gen->ncodes; i++) {
+		code = &gen->codes[i];
+		if (code->opcode < 0 || code->opcode == OPCODE_NOP) {
+			continue;
+		}
+
+		bytes[pc++] = (unsigned char)code->opcode;
+		for (j = 0; j < code->nargs; j++) {
+			arg = &code->arg[j];
+			if (arg->type == 1) {
+				generator_write4(bytes + pc,
+				                 arg->label->address);
+				pc += 4;
+			} else if (arg->size == 1) {
+				/* current only 1 byte code and 4 byte code */
+				bytes[pc++] = (unsigned char)arg->value;
+			} else if (arg->size == 4) {
+				generator_write4(bytes + pc, arg->value);
+				pc += 4;
+			}
+		}
+	}
+
+	return (struct lobject *)lcode;
 }
 
-struct generator_code *
+int
 generator_emit_opcode(struct lemon *lemon,
                       int opcode)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           opcode,
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, opcode);
+	if (!code) {
+		return -1;
+	}
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_const(struct lemon *lemon,
                      int pool)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_CONST,
-	                           generator_make_arg(lemon, 0, 4, pool),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_CONST);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 4, pool);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_unpack(struct lemon *lemon,
                       int count)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_UNPACK,
-	                           generator_make_arg(lemon, 0, 1, count),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_UNPACK);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, count);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_load(struct lemon *lemon,
                     int level,
                     int local)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_LOAD,
-	                           generator_make_arg(lemon, 0, 1, level),
-	                           generator_make_arg(lemon, 0, 1, local),
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_LOAD);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, level);
+	generator_add_arg(lemon, code, 1, local);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_store(struct lemon *lemon,
                      int level,
                      int local)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_STORE,
-	                           generator_make_arg(lemon, 0, 1, level),
-	                           generator_make_arg(lemon, 0, 1, local),
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_STORE);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, level);
+	generator_add_arg(lemon, code, 1, local);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_array(struct lemon *lemon,
                      int length)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_ARRAY,
-	                           generator_make_arg(lemon, 0, 4, length),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_ARRAY);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 4, length);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_dictionary(struct lemon *lemon,
                           int length)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_DICTIONARY,
-	                           generator_make_arg(lemon, 0, 4, length),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_DICTIONARY);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 4, length);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_jmp(struct lemon *lemon,
                    struct generator_label *label)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_JMP,
-	                           generator_make_arg_label(lemon, label),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_JMP);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_jz(struct lemon *lemon,
                   struct generator_label *label)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_JZ,
-	                           generator_make_arg_label(lemon, label),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_JZ);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_jnz(struct lemon *lemon,
                    struct generator_label *label)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_JNZ,
-	                           generator_make_arg_label(lemon, label),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_JNZ);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
+generator_emit_inline(struct lemon *lemon,
+                      struct generator_label *entry,
+                      struct generator_label *label)
+{
+	struct generator_code *code;
+
+	code = generator_append(lemon, OPCODE_INLINE);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg_label(lemon, code, entry);
+	generator_add_arg_label(lemon, code, label);
+
+	return generator_index(lemon, code);
+}
+
+int
+generator_emit_foriter(struct lemon *lemon,
+                       int local,
+                       struct generator_label *label,
+                       struct generator_label *exit)
+{
+	struct generator_code *code;
+
+	code = generator_append(lemon, OPCODE_FORITER);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, local);
+	generator_add_arg_label(lemon, code, label);
+	generator_add_arg_label(lemon, code, exit);
+
+	return generator_index(lemon, code);
+}
+
+int
 generator_emit_call(struct lemon *lemon,
                     int argc)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_CALL,
-	                           generator_make_arg(lemon, 0, 1, argc),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_CALL);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, argc);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
+generator_emit_callkw(struct lemon *lemon,
+                      int argc,
+                      int keywords)
+{
+	struct generator_code *code;
+
+	code = generator_append(lemon, OPCODE_CALLKW);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, argc);
+	generator_add_arg(lemon, code, 4, keywords);
+
+	return generator_index(lemon, code);
+}
+
+int
 generator_emit_tailcall(struct lemon *lemon,
                         int argc)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_TAILCALL,
-	                           generator_make_arg(lemon, 0, 1, argc),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_TAILCALL);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, argc);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_module(struct lemon *lemon,
                       int nlocals,
                       struct generator_label *label)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_MODULE,
-	                           generator_make_arg(lemon, 0, 1, nlocals),
-	                           generator_make_arg_label(lemon, label),
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_MODULE);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, nlocals);
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_patch_module(struct lemon *lemon,
-                       struct generator_code *code,
+                       int index,
                        int nlocals,
                        struct generator_label *label)
 {
-	struct generator_code *newcode;
+	struct generator_code *code;
 
-	newcode = generator_make_code(lemon,
-	                              OPCODE_MODULE,
-	                              generator_make_arg(lemon, 0, 1, nlocals),
-	                              generator_make_arg_label(lemon, label),
-	                              NULL,
-	                              NULL,
-	                              NULL);
+	code = generator_get_code(lemon, index);
+	generator_clear_args(lemon, code);
+	generator_add_arg(lemon, code, 1, nlocals);
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_patch_code(lemon, code, newcode);
+	return index;
 }
 
-struct generator_code *
+int
 generator_emit_define(struct lemon *lemon,
                       int define,
                       int nvalues,
@@ -566,104 +692,120 @@ generator_emit_define(struct lemon *lemon,
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_DEFINE,
-	                           generator_make_arg(lemon, 0, 1, define),
-	                           generator_make_arg(lemon, 0, 1, nvalues),
-	                           generator_make_arg(lemon, 0, 1, nparams),
-	                           generator_make_arg(lemon, 0, 1, nlocals),
-	                           generator_make_arg_label(lemon, label));
+	code = generator_append(lemon, OPCODE_DEFINE);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, define);
+	generator_add_arg(lemon, code, 1, nvalues);
+	generator_add_arg(lemon, code, 1, nparams);
+	generator_add_arg(lemon, code, 1, nlocals);
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
+generator_emit_lazy(struct lemon *lemon,
+                    int define,
+                    int nvalues,
+                    int nparams,
+                    int record)
+{
+	struct generator_code *code;
+
+	code = generator_append(lemon, OPCODE_LAZY);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, define);
+	generator_add_arg(lemon, code, 1, nvalues);
+	generator_add_arg(lemon, code, 1, nparams);
+	generator_add_arg(lemon, code, 4, record);
+
+	return generator_index(lemon, code);
+}
+
+int
 generator_patch_define(struct lemon *lemon,
-                       struct generator_code *code,
+                       int index,
                        int define,
                        int nvalues,
                        int nparams,
                        int nlocals,
                        struct generator_label *label)
 {
-	struct generator_code *newcode;
+	struct generator_code *code;
 
-	newcode = generator_make_code(lemon,
-	                              OPCODE_DEFINE,
-	                              generator_make_arg(lemon, 0, 1, define),
-	                              generator_make_arg(lemon, 0, 1, nvalues),
-	                              generator_make_arg(lemon, 0, 1, nparams),
-	                              generator_make_arg(lemon, 0, 1, nlocals),
-	                              generator_make_arg_label(lemon, label));
+	code = generator_get_code(lemon, index);
+	generator_clear_args(lemon, code);
+	generator_add_arg(lemon, code, 1, define);
+	generator_add_arg(lemon, code, 1, nvalues);
+	generator_add_arg(lemon, code, 1, nparams);
+	generator_add_arg(lemon, code, 1, nlocals);
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_patch_code(lemon, code, newcode);
+	return index;
 }
 
-struct generator_code *
+int
 generator_emit_try(struct lemon *lemon,
                    struct generator_label *label)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_TRY,
-	                           generator_make_arg_label(lemon, label),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_TRY);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg_label(lemon, code, label);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_class(struct lemon *lemon,
                      int nsupers,
                      int nattrs)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_CLASS,
-	                           generator_make_arg(lemon, 0, 1, nsupers),
-	                           generator_make_arg(lemon, 0, 1, nattrs),
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_CLASS);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, nsupers);
+	generator_add_arg(lemon, code, 1, nattrs);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_setgetter(struct lemon *lemon,
                          int ngetters)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_SETGETTER,
-	                           generator_make_arg(lemon,0, 1, ngetters),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_SETGETTER);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, ngetters);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
 
-struct generator_code *
+int
 generator_emit_setsetter(struct lemon *lemon,
                          int nsetters)
 {
 	struct generator_code *code;
 
-	code = generator_make_code(lemon,
-	                           OPCODE_SETSETTER,
-	                           generator_make_arg(lemon, 0, 1, nsetters),
-	                           NULL,
-	                           NULL,
-	                           NULL,
-	                           NULL);
+	code = generator_append(lemon, OPCODE_SETSETTER);
+	if (!code) {
+		return -1;
+	}
+	generator_add_arg(lemon, code, 1, nsetters);
 
-	return generator_emit_code(lemon, code);
+	return generator_index(lemon, code);
 }
@@ -1,66 +1,67 @@
 #ifndef LEMON_GENERATOR_H
 #define LEMON_GENERATOR_H
 
+struct lobject;
 struct generator_label;
 
 #define MAX_ARG 5
 
 struct generator_arg {
-	int type; /* 0: value, 1: label */
-	int size; /* size of this value */
+	short type; /* 0: value, 1: label */
+	short size; /* size of this value */
 	int value;
-
-	int address;
-	struct generator_label *label;
-	struct generator_arg *prevlabel;
+	struct generator_label *label; /* if type == 1 */
 };
 
+/*
+ * codes are stored in one growable array, args are inline.  opcode -1 is
+ * label and -2 is deleted code, deleted code is skipped by
+ * `generator_prev' and `generator_next' and removed by
+ * `generator_compact'.  pointer to code is invalid after next emit.
+ */
 struct generator_code {
 	int opcode;
-	int address;
-	int dead;
-	struct generator_arg *arg[MAX_ARG];
+	int nargs;
+	struct generator_arg arg[MAX_ARG];
 	struct generator_label *label; /* if opcode == -1 */
-
-	struct generator_code *prev;
-	struct generator_code *next;
 };
 
 struct generator_label {
 	int count; /* reference count */
+	int block; /* basic block index, used by flowgraph */
+	int code;  /* index of label's code, -1 if not emitted yet */
 	int address;
-	struct generator_code *code;
-	struct generator_arg *prevlabel;
 };
 
 struct generator {
-	int address;
-
-	struct generator_code *head;
-	struct generator_code *tail;
+	long ncodes;
+	long capacity;
+	struct generator_code *codes;
+
+	/* constants of code object being generated */
+	int ncpool;
+	int cpoollen;
+	struct lobject **cpool;
 };
 
 struct generator *
 generator_create(struct lemon *lemon);
 
-struct generator_code *
-generator_make_code(struct lemon *lemon,
-                    int opcode,
-                    struct generator_arg *arg1,
-                    struct generator_arg *arg2,
-                    struct generator_arg *arg3,
-                    struct generator_arg *arg4,
-                    struct generator_arg *arg5);
-
-struct generator_arg *
-generator_make_arg(struct lemon *lemon,
-                   int type,
-                   int size,
-                   int value);
-
-struct generator_arg *
-generator_make_arg_label(struct lemon *lemon,
-                         struct generator_label *label);
+/*
+ * drop all codes and constants, labels are released with arena
+ */
+void
+generator_reset(struct lemon *lemon);
+
+/*
+ * return index of `object' in constants, equal constant is shared,
+ * -1 if out of memory
+ */
+int
+generator_add_const(struct lemon *lemon, struct lobject *object);
+
+struct lobject *
+generator_get_const(struct lemon *lemon, int pool);
 
 struct generator_label *
 generator_make_label(struct lemon *lemon);
@@ -69,90 +70,140 @@ void
 generator_emit_label(struct lemon *lemon,
                      struct generator_label *label);
 
-struct generator_code *
+/*
+ * append copy of `code', return index of new code or -1
+ */
+int
 generator_emit_code(struct lemon *lemon,
                     struct generator_code *code);
 
-/* insert `newcode' before `code' */
+struct generator_code *
+generator_get_code(struct lemon *lemon, int index);
+
+struct generator_code *
+generator_label_code(struct lemon *lemon, struct generator_label *label);
+
+struct generator_code *
+generator_first(struct lemon *lemon);
+
+struct generator_code *
+generator_prev(struct lemon *lemon, struct generator_code *code);
+
+struct generator_code *
+generator_next(struct lemon *lemon, struct generator_code *code);
+
 void
-generator_insert_code(struct lemon *lemon,
-                      struct generator_code *code,
-                      struct generator_code *newcode);
+generator_add_arg(struct lemon *lemon,
+                  struct generator_code *code,
+                  int size,
+                  int value);
+
+void
+generator_add_arg_label(struct lemon *lemon,
+                        struct generator_code *code,
+                        struct generator_label *label);
+
+/* drop args of `code' before rewrite it in place */
+void
+generator_clear_args(struct lemon *lemon,
+                     struct generator_code *code);
 
 void
 generator_delete_code(struct lemon *lemon,
                       struct generator_code *code);
 
-struct generator_code *
-generator_patch_code(struct lemon *lemon,
-                     struct generator_code *oldcode,
-                     struct generator_code *newcode);
-
+/* remove deleted codes */
 void
+generator_compact(struct lemon *lemon);
+
+/*
+ * write codes and constants into new code object, label's address is
+ * offset in it.  return NULL if out of memory
+ */
+struct lobject *
 generator_emit(struct lemon *lemon);
 
-struct generator_code *
+int
 generator_emit_opcode(struct lemon *lemon,
                       int opcode);
 
-struct generator_code *
+int
 generator_emit_const(struct lemon *lemon,
                      int pool);
 
-struct generator_code *
+int
 generator_emit_unpack(struct lemon *lemon,
                       int count);
 
-struct generator_code *
+int
 generator_emit_load(struct lemon *lemon,
                     int level,
                     int local);
 
-struct generator_code *
+int
 generator_emit_store(struct lemon *lemon,
                      int level,
                      int local);
 
-struct generator_code *
+int
 generator_emit_array(struct lemon *lemon,
                      int length);
 
-struct generator_code *
+int
 generator_emit_dictionary(struct lemon *lemon,
                           int length);
 
-struct generator_code *
+int
 generator_emit_jmp(struct lemon *lemon,
                    struct generator_label *label);
 
-struct generator_code *
+int
 generator_emit_jz(struct lemon *lemon,
                   struct generator_label *label);
 
-struct generator_code *
+int
 generator_emit_jnz(struct lemon *lemon,
                    struct generator_label *label);
 
-struct generator_code *
+int
+generator_emit_inline(struct lemon *lemon,
+                      struct generator_label *entry,
+                      struct generator_label *label);
+
+int
+generator_emit_foriter(struct lemon *lemon,
+                       int local,
+                       struct generator_label *label,
+                       struct generator_label *exit);
+
+int
 generator_emit_call(struct lemon *lemon,
                     int argc);
 
-struct generator_code *
+/*
+ * `keywords' is constant of keyword names array
+ */
+int
+generator_emit_callkw(struct lemon *lemon,
+                      int argc,
+                      int keywords);
+
+int
 generator_emit_tailcall(struct lemon *lemon,
                         int argc);
 
-struct generator_code *
+int
 generator_emit_module(struct lemon *lemon,
                       int nlocals,
                       struct generator_label *label);
 
-struct generator_code *
+int
 generator_patch_module(struct lemon *lemon,
-                       struct generator_code *code,
+                       int index,
                        int nlocals,
                        struct generator_label *label);
 
-struct generator_code *
+int
 generator_emit_define(struct lemon *lemon,
                       int define,
                       int nvalues,
@@ -160,29 +211,36 @@ generator_emit_define(struct lemon *lemon,
                       int nlocals,
                       struct generator_label *label);
 
-struct generator_code *
+int
+generator_emit_lazy(struct lemon *lemon,
+                    int define,
+                    int nvalues,
+                    int nparams,
+                    int record);
+
+int
 generator_patch_define(struct lemon *lemon,
-                       struct generator_code *code,
+                       int index,
                        int define,
                        int nvalues,
                        int nparams,
                        int nlocals,
                        struct generator_label *label);
 
-struct generator_code *
+int
 generator_emit_try(struct lemon *lemon,
                    struct generator_label *label);
 
-struct generator_code *
+int
 generator_emit_class(struct lemon *lemon,
                      int nsupers,
                      int nattrs);
 
-struct generator_code *
+int
 generator_emit_setgetter(struct lemon *lemon,
                          int ngetters);
 
-struct generator_code *
+int
 generator_emit_setsetter(struct lemon *lemon,
                          int nsetters);
 
@@ -1,21 +1,26 @@
 #include "lemon.h"
-#include "arena.h"
 #include "input.h"
+#include "symbol.h"
 
 #include <stdio.h>
-#include <limits.h>
 #include <string.h>
 
-#ifdef LINUX
-#include <linux/limits.h>
-#endif
+static void
+input_rewind(struct input *input)
+{
+	input->offset = 0;
+	input->line = 0;
+	input->column = 0;
+	input->position = 0;
+	input->start = 0;
+}
 
 struct input *
 input_create(struct lemon *lemon)
 {
 	struct input *input;
 
-	input = arena_alloc(lemon, lemon->l_arena, sizeof(*input));
+	input = lemon_allocator_alloc(lemon, sizeof(*input));
 	if (!input) {
 		return NULL;
 	}
@@ -27,6 +32,44 @@ input_create(struct lemon *lemon)
 void
 input_destroy(struct lemon *lemon, struct input *input)
 {
+	if (input) {
+		lemon_allocator_free(lemon, input->buffer);
+		lemon_allocator_free(lemon, input);
+	}
+}
+
+/*
+ * source buffer is not in arena, only one source is scanned at a time and
+ * it's released by `input_reset' when compilation done
+ */
+static char *
+input_alloc_buffer(struct lemon *lemon, struct input *input, long size)
+{
+	char *buffer;
+
+	buffer = lemon_allocator_alloc(lemon, size);
+	if (!buffer) {
+		return NULL;
+	}
+	lemon_allocator_free(lemon, input->buffer);
+	input->size = size;
+	input->buffer = buffer;
+	input->source = NULL;
+
+	return buffer;
+}
+
+void
+input_reset(struct lemon *lemon)
+{
+	struct input *input;
+
+	input = lemon->l_input;
+	lemon_allocator_free(lemon, input->buffer);
+	input->size = 0;
+	input->buffer = NULL;
+	input->source = NULL;
+	input_rewind(input);
 }
 
 int
@@ -44,8 +87,11 @@ input_set_file(struct lemon *lemon, const char *filename)
 	fseek(fp, 0, SEEK_END);
 
 	input = lemon->l_input;
-	input->size = ftell(fp) + 1;
-	input->buffer = arena_alloc(lemon, lemon->l_arena, input->size);
+	if (!input_alloc_buffer(lemon, input, ftell(fp) + 1)) {
+		fclose(fp);
+
+		return 0;
+	}
 	memset(input->buffer, 0, input->size);
 
 	fseek(fp, 0, SEEK_SET);
@@ -57,9 +103,12 @@ input_set_file(struct lemon *lemon, const char *filename)
 	}
 	fclose(fp);
 
-	input->filename = arena_alloc(lemon, lemon->l_arena, PATH_MAX);
-	strncpy(input->filename, filename, PATH_MAX);
-	input->offset = 0;
+	/* syntax node keep filename, interned name outlive arena */
+	input->filename = symbol_intern(lemon, filename, strlen(filename));
+	if (!input->filename) {
+		return 0;
+	}
+	input_rewind(input);
 
 	return 1;
 }
@@ -78,12 +127,18 @@ input_set_buffer(struct lemon *lemon,
 {
 	struct input *input;
 
+	/* lexer scan until '\0', copy because `buffer' may not terminated */
 	input = lemon->l_input;
-	input->size = length;
-	input->buffer = buffer;
-	input->filename = arena_alloc(lemon, lemon->l_arena, PATH_MAX);
-	strncpy(input->filename, filename, PATH_MAX);
-	input->offset = 0;
+	if (!input_alloc_buffer(lemon, input, length + 1)) {
+		return 0;
+	}
+	memcpy(input->buffer, buffer, length);
+	input->buffer[length] = '\0';
+	input->filename = symbol_intern(lemon, filename, strlen(filename));
+	if (!input->filename) {
+		return 0;
+	}
+	input_rewind(input);
 
 	return 1;
 }
@@ -106,51 +161,55 @@ input_filename(struct lemon *lemon)
 	return input->filename;
 }
 
-long
-input_line(struct lemon *lemon)
+/*
+ * count newline from last computed position to `offset', restart from
+ * buffer begin if offset moved backward
+ */
+static void
+input_locate(struct input *input)
 {
-	struct input *input;
+	char *p;
+	char *end;
 
-	input = lemon->l_input;
-	return input->line;
-}
-
-long
-input_column(struct lemon *lemon)
-{
-	struct input *input;
+	if (input->offset < input->position) {
+		input->line = 0;
+		input->start = 0;
+		input->position = 0;
+	}
 
-	input = lemon->l_input;
-	return input->column;
+	p = input->buffer + input->position;
+	end = input->buffer + input->offset;
+	while (p < end) {
+		p = memchr(p, '\n', (size_t)(end - p));
+		if (!p) {
+			break;
+		}
+		p += 1;
+		input->line += 1;
+		input->start = p - input->buffer;
+	}
+	input->column = input->offset - input->start;
+	input->position = input->offset;
 }
 
-int
-input_getchar(struct lemon *lemon)
+long
+input_line(struct lemon *lemon)
 {
-	int c;
 	struct input *input;
 
 	input = lemon->l_input;
-	if (input->offset >= input->size) {
-		return 0;
-	}
+	input_locate(input);
 
-	c = input->buffer[input->offset++];
-	if (c == '\n') {
-		input->line++;
-		input->column = 0;
-	} else {
-		input->column++;
-	}
-
-	return c;
+	return input->line;
 }
 
-void
-input_ungetchar(struct lemon *lemon, int c)
+long
+input_column(struct lemon *lemon)
 {
 	struct input *input;
 
 	input = lemon->l_input;
-	input->offset--;
+	input_locate(input);
+
+	return input->column;
 }
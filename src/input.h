@@ -8,9 +8,14 @@ struct input {
 	long offset; /* offset in buffer */
 	long line;   /* line number */
 	long column; /* position of current line */
+
+	/* `line' and `column' are computed lazily up to `position' */
+	long position;
+	long start;  /* offset of line start at `position' */
 	char *filename;
 
 	char *buffer;
+	void *source; /* `buffer' as lstring, made by parser for lazy define */
 };
 
 struct input *
@@ -30,6 +35,12 @@ input_set_buffer(struct lemon *lemon,
                  char *buffer,
                  int length);
 
+/*
+ * release source buffer, filename is kept
+ */
+void
+input_reset(struct lemon *lemon);
+
 char *
 input_filename(struct lemon *lemon);
 
@@ -39,10 +50,4 @@ input_line(struct lemon *lemon);
 long
 input_column(struct lemon *lemon);
 
-int
-input_getchar(struct lemon *lemon);
-
-void
-input_ungetchar(struct lemon *lemon, int c);
-
 #endif /* LEMON_INPUT_H */
@@ -127,7 +127,13 @@ larray_del_item(struct lemon *lemon,
 		                          self);
 	}
 
-	if (i != array->count - 1) {
+	/* move shorter side */
+	if (i < array->count / 2) {
+		memmove(&array->items[1],
+		        &array->items[0],
+		        i * sizeof(struct lobject *));
+		array->items += 1;
+	} else if (i != array->count - 1) {
 		memmove(&array->items[i],
 		        &array->items[i+1],
 		        (array->count - i - 1) * sizeof(struct lobject *));
@@ -137,33 +143,74 @@ larray_del_item(struct lemon *lemon,
 	return lemon->l_nil;
 }
 
+/*
+ * make room for `front' slots before and `back' slots after items,
+ * spare slots are kept before items only when grow to front.
+ */
+static int
+larray_reserve(struct lemon *lemon, struct larray *array, int front, int back)
+{
+	int gap;
+	int need;
+	int alloc;
+	size_t size;
+	struct lobject **base;
+
+	gap = (int)(array->items - array->base);
+	if (gap >= front && array->alloc - gap - array->count >= back) {
+		return 1;
+	}
+
+	need = array->count + front + back;
+	if (need <= array->alloc / 2) {
+		/* enough space, move items instead of grow */
+		alloc = array->alloc;
+		base = array->base;
+	} else {
+		alloc = need * 2;
+		size = sizeof(struct lobject *) * alloc;
+		base = lemon_allocator_alloc(lemon, size);
+		if (!base) {
+			return 0;
+		}
+	}
+
+	gap = 0;
+	if (front) {
+		gap = front + (alloc - need) / 2;
+	}
+	if (array->count) {
+		memmove(base + gap,
+		        array->items,
+		        sizeof(struct lobject *) * array->count);
+	}
+	if (base != array->base) {
+		lemon_allocator_free(lemon, array->base);
+	}
+	array->base = base;
+	array->items = base + gap;
+	array->alloc = alloc;
+
+	return 1;
+}
+
 struct lobject *
 larray_append(struct lemon *lemon,
               struct lobject *self,
               int argc, struct lobject *argv[])
 {
 	int i;
-	int count;
-	size_t size;
 	struct larray *array;
 
 	array = (struct larray *)self;
-	count = array->count + argc;
-	if (count > array->alloc) {
-		size = sizeof(struct lobject *) * count * 2;
-		array->items = lemon_allocator_realloc(lemon,
-		                                       array->items,
-		                                       size);
-		if (!array->items) {
-			return NULL;
-		}
-		array->alloc = count * 2;
+	if (!larray_reserve(lemon, array, 0, argc)) {
+		return NULL;
 	}
 	for (i = 0; i < argc; i++) {
 		lemon_collector_barrierback(lemon, self, argv[i]);
 		array->items[array->count + i] = argv[i];
 	}
-	array->count = count;
+	array->count += argc;
 
 	return lemon->l_nil;
 }
@@ -177,12 +224,595 @@ larray_pop(struct lemon *lemon,
 
 	array = (struct larray *)self;
 	if (!array->count) {
-		return lobject_error_item(lemon, "pop() from empty list");
+		return lobject_error_item(lemon, "pop() from empty array");
 	}
 
 	return array->items[--array->count];
 }
 
+static struct lobject *
+larray_shift(struct lemon *lemon,
+             struct lobject *self,
+             int argc, struct lobject *argv[])
+{
+	struct larray *array;
+
+	array = (struct larray *)self;
+	if (!array->count) {
+		return lobject_error_item(lemon, "shift() from empty array");
+	}
+	array->count -= 1;
+
+	return *array->items++;
+}
+
+static struct lobject *
+larray_unshift(struct lemon *lemon,
+               struct lobject *self,
+               int argc, struct lobject *argv[])
+{
+	int i;
+	struct larray *array;
+
+	array = (struct larray *)self;
+	if (!larray_reserve(lemon, array, argc, 0)) {
+		return NULL;
+	}
+	array->items -= argc;
+	array->count += argc;
+	for (i = 0; i < argc; i++) {
+		lemon_collector_barrierback(lemon, self, argv[i]);
+		array->items[i] = argv[i];
+	}
+
+	return lemon->l_nil;
+}
+
+static struct lobject *
+larray_insert(struct lemon *lemon,
+              struct lobject *self,
+              int argc, struct lobject *argv[])
+{
+	long i;
+	struct larray *array;
+
+	if (argc != 2 || !lobject_is_integer(lemon, argv[0])) {
+		const char *fmt;
+
+		fmt = "'%@' accept index and value arguments";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	array = (struct larray *)self;
+	i = linteger_to_long(lemon, argv[0]);
+	if (i < 0) {
+		i = array->count + i;
+	}
+	if (i < 0) {
+		i = 0;
+	}
+	if (i > array->count) {
+		i = array->count;
+	}
+
+	/* move shorter side */
+	if (i < array->count / 2) {
+		if (!larray_reserve(lemon, array, 1, 0)) {
+			return NULL;
+		}
+		array->items -= 1;
+		memmove(&array->items[0],
+		        &array->items[1],
+		        i * sizeof(struct lobject *));
+	} else {
+		if (!larray_reserve(lemon, array, 0, 1)) {
+			return NULL;
+		}
+		memmove(&array->items[i + 1],
+		        &array->items[i],
+		        (array->count - i) * sizeof(struct lobject *));
+	}
+	array->count += 1;
+	array->items[i] = argv[1];
+	lemon_collector_barrierback(lemon, self, argv[1]);
+
+	return lemon->l_nil;
+}
+
+static struct lobject *
+larray_extend_callback(struct lemon *lemon,
+                       struct lframe *frame,
+                       struct lobject *retval)
+{
+	struct larray *other;
+
+	if (!lobject_is_array(lemon, retval)) {
+		return retval;
+	}
+	other = (struct larray *)retval;
+	if (!larray_append(lemon, frame->self, other->count, other->items)) {
+		return NULL;
+	}
+
+	return lemon->l_nil;
+}
+
+static struct lobject *
+larray_extend(struct lemon *lemon,
+              struct lobject *self,
+              int argc, struct lobject *argv[])
+{
+	struct lframe *frame;
+	struct larray *array;
+	struct larray *other;
+
+	if (argc != 1) {
+		const char *fmt;
+
+		fmt = "'%@' accept 1 iterable argument";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	if (lobject_is_array(lemon, argv[0])) {
+		array = (struct larray *)self;
+		other = (struct larray *)argv[0];
+
+		/* reserve first, `items' of self will move */
+		if (!larray_reserve(lemon, array, 0, other->count)) {
+			return NULL;
+		}
+
+		return larray_append(lemon, self, other->count, other->items);
+	}
+
+	frame = lemon_machine_push_new_frame(lemon,
+	                                     self,
+	                                     NULL,
+	                                     larray_extend_callback,
+	                                     0);
+	if (!frame) {
+		return NULL;
+	}
+
+	return literator_to_array(lemon, argv[0], 0);
+}
+
+static struct lobject *
+larray_index(struct lemon *lemon,
+             struct lobject *self,
+             int argc, struct lobject *argv[])
+{
+	int i;
+	struct larray *array;
+
+	if (argc != 1) {
+		const char *fmt;
+
+		fmt = "'%@' accept 1 argument";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	array = (struct larray *)self;
+	for (i = 0; i < array->count; i++) {
+		if (lobject_is_equal(lemon, array->items[i], argv[0])) {
+			return linteger_create_from_long(lemon, i);
+		}
+	}
+
+	return linteger_create_from_long(lemon, -1);
+}
+
+static struct lobject *
+larray_count(struct lemon *lemon,
+             struct lobject *self,
+             int argc, struct lobject *argv[])
+{
+	int i;
+	long count;
+	struct larray *array;
+
+	if (argc != 1) {
+		const char *fmt;
+
+		fmt = "'%@' accept 1 argument";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	count = 0;
+	array = (struct larray *)self;
+	for (i = 0; i < array->count; i++) {
+		if (lobject_is_equal(lemon, array->items[i], argv[0])) {
+			count += 1;
+		}
+	}
+
+	return linteger_create_from_long(lemon, count);
+}
+
+static struct lobject *
+larray_remove(struct lemon *lemon,
+              struct lobject *self,
+              int argc, struct lobject *argv[])
+{
+	long i;
+	struct lobject *index;
+
+	index = larray_index(lemon, self, argc, argv);
+	if (!index || lobject_is_error(lemon, index)) {
+		return index;
+	}
+
+	i = linteger_to_long(lemon, index);
+	if (i < 0) {
+		return lobject_error_item(lemon,
+		                          "'%@' remove() item not in array",
+		                          self);
+	}
+
+	return larray_del_item(lemon, self, i);
+}
+
+static struct lobject *
+larray_reverse(struct lemon *lemon,
+               struct lobject *self,
+               int argc, struct lobject *argv[])
+{
+	int i;
+	int j;
+	struct lobject *item;
+	struct larray *array;
+
+	array = (struct larray *)self;
+	for (i = 0, j = array->count - 1; i < j; i++, j--) {
+		item = array->items[i];
+		array->items[i] = array->items[j];
+		array->items[j] = item;
+	}
+
+	return lemon->l_nil;
+}
+
+static struct lobject *
+larray_clear(struct lemon *lemon,
+             struct lobject *self,
+             int argc, struct lobject *argv[])
+{
+	struct larray *array;
+
+	array = (struct larray *)self;
+	array->items = array->base;
+	array->count = 0;
+
+	return lemon->l_nil;
+}
+
+/*
+ * TimSort, natural runs are extended to `minrun' by binary insertion then
+ * merged with run stack invariants, without galloping.
+ *
+ * compare function never fail, `larray_sort' choose it after check
+ * every item's type, items are integer, number or string.
+ */
+#define LARRAY_SORT_STACK 85
+
+typedef int (*larray_less_t)(struct lemon *,
+                             struct lobject *,
+                             struct lobject *);
+
+struct larray_sort {
+	struct lemon *lemon;
+	larray_less_t less;
+
+	struct lobject **items;
+	struct lobject **buffer;
+
+	int nruns;
+	long base[LARRAY_SORT_STACK];
+	long length[LARRAY_SORT_STACK];
+};
+
+static long
+larray_small_value(struct lobject *object)
+{
+	long value;
+
+	value = (long)(((uintptr_t)object) >> 2);
+	if (((uintptr_t)object) & 0x2) {
+		return -value;
+	}
+
+	return value;
+}
+
+static int
+larray_less_small(struct lemon *lemon, struct lobject *a, struct lobject *b)
+{
+	return larray_small_value(a) < larray_small_value(b);
+}
+
+static int
+larray_less_string(struct lemon *lemon, struct lobject *a, struct lobject *b)
+{
+	int r;
+	long alen;
+	long blen;
+
+	alen = lstring_length(lemon, a);
+	blen = lstring_length(lemon, b);
+	r = memcmp(lstring_buffer(lemon, a),
+	           lstring_buffer(lemon, b),
+	           alen < blen ? alen : blen);
+	if (r == 0) {
+		return alen < blen;
+	}
+
+	return r < 0;
+}
+
+static int
+larray_less_number(struct lemon *lemon, struct lobject *a, struct lobject *b)
+{
+	struct lobject *value;
+
+	value = lobject_method_call(lemon, a, LOBJECT_METHOD_LT, 1, &b);
+
+	return value == lemon->l_true;
+}
+
+static void
+larray_sort_binary_insertion(struct larray_sort *sort,
+                             long lo,
+                             long hi,
+                             long start)
+{
+	long l;
+	long r;
+	long m;
+	struct lobject *pivot;
+	struct lobject **items;
+
+	items = sort->items;
+	for (; start < hi; start++) {
+		pivot = items[start];
+		l = lo;
+		r = start;
+		while (l < r) {
+			m = l + (r - l) / 2;
+			if (sort->less(sort->lemon, pivot, items[m])) {
+				r = m;
+			} else {
+				l = m + 1;
+			}
+		}
+		memmove(&items[l + 1],
+		        &items[l],
+		        (start - l) * sizeof(struct lobject *));
+		items[l] = pivot;
+	}
+}
+
+/*
+ * return length of run begin at `lo', reverse strictly descending run
+ */
+static long
+larray_sort_count_run(struct larray_sort *sort, long lo, long hi)
+{
+	long i;
+	long j;
+	long n;
+	struct lemon *lemon;
+	struct lobject *item;
+	struct lobject **items;
+
+	lemon = sort->lemon;
+	items = sort->items;
+	n = lo + 1;
+	if (n == hi) {
+		return 1;
+	}
+
+	if (sort->less(lemon, items[n], items[lo])) {
+		n += 1;
+		while (n < hi && sort->less(lemon, items[n], items[n - 1])) {
+			n += 1;
+		}
+		for (i = lo, j = n - 1; i < j; i++, j--) {
+			item = items[i];
+			items[i] = items[j];
+			items[j] = item;
+		}
+	} else {
+		n += 1;
+		while (n < hi && !sort->less(lemon, items[n], items[n - 1])) {
+			n += 1;
+		}
+	}
+
+	return n - lo;
+}
+
+static long
+larray_sort_minrun(long n)
+{
+	long r;
+
+	r = 0;
+	while (n >= 64) {
+		r |= n & 1;
+		n >>= 1;
+	}
+
+	return n + r;
+}
+
+static void
+larray_sort_merge_at(struct larray_sort *sort, int i)
+{
+	long a;
+	long b;
+	long k;
+	long end;
+	long len;
+	struct lobject **items;
+
+	items = sort->items;
+	len = sort->length[i];
+	k = sort->base[i];
+	end = sort->base[i + 1] + sort->length[i + 1];
+
+	sort->length[i] += sort->length[i + 1];
+	if (i == sort->nruns - 3) {
+		sort->base[i + 1] = sort->base[i + 2];
+		sort->length[i + 1] = sort->length[i + 2];
+	}
+	sort->nruns -= 1;
+
+	/* copy left run out, merge forward, left win tie for stable */
+	memcpy(sort->buffer, &items[k], len * sizeof(struct lobject *));
+	a = 0;
+	b = k + len;
+	while (a < len && b < end) {
+		if (sort->less(sort->lemon, items[b], sort->buffer[a])) {
+			items[k++] = items[b++];
+		} else {
+			items[k++] = sort->buffer[a++];
+		}
+	}
+	memcpy(&items[k],
+	       &sort->buffer[a],
+	       (len - a) * sizeof(struct lobject *));
+}
+
+static void
+larray_sort_collapse(struct larray_sort *sort)
+{
+	int n;
+	long *length;
+
+	length = sort->length;
+	while (sort->nruns > 1) {
+		n = sort->nruns - 2;
+		if ((n > 0 && length[n - 1] <= length[n] + length[n + 1]) ||
+		    (n > 1 && length[n - 2] <= length[n - 1] + length[n]))
+		{
+			if (length[n - 1] < length[n + 1]) {
+				n -= 1;
+			}
+			larray_sort_merge_at(sort, n);
+		} else if (length[n] <= length[n + 1]) {
+			larray_sort_merge_at(sort, n);
+		} else {
+			break;
+		}
+	}
+}
+
+static void
+larray_sort_force_collapse(struct larray_sort *sort)
+{
+	int n;
+
+	while (sort->nruns > 1) {
+		n = sort->nruns - 2;
+		if (n > 0 && sort->length[n - 1] < sort->length[n + 1]) {
+			n -= 1;
+		}
+		larray_sort_merge_at(sort, n);
+	}
+}
+
+static struct lobject *
+larray_sort(struct lemon *lemon,
+            struct lobject *self,
+            int argc, struct lobject *argv[])
+{
+	int i;
+	int nsmall;
+	int nstring;
+	int nnumber;
+	long lo;
+	long run;
+	long force;
+	long minrun;
+	size_t size;
+	struct larray *array;
+	struct lobject *item;
+	struct larray_sort sort;
+
+	array = (struct larray *)self;
+	if (array->count < 2) {
+		return lemon->l_nil;
+	}
+
+	nsmall = 0;
+	nstring = 0;
+	nnumber = 0;
+	for (i = 0; i < array->count; i++) {
+		item = array->items[i];
+		if (!lobject_is_pointer(lemon, item) &&
+		    lobject_is_integer(lemon, item))
+		{
+			nsmall += 1;
+		} else if (lobject_is_string(lemon, item)) {
+			nstring += 1;
+		} else if (lobject_is_integer(lemon, item) ||
+		           lobject_is_number(lemon, item))
+		{
+			nnumber += 1;
+		}
+	}
+
+	/* homogeneous small integer and string compare without dispatch */
+	if (nsmall == array->count) {
+		sort.less = larray_less_small;
+	} else if (nstring == array->count) {
+		sort.less = larray_less_string;
+	} else if (nsmall + nnumber == array->count) {
+		sort.less = larray_less_number;
+	} else {
+		return lobject_error_type(lemon,
+		                          "'%@' sort() unorderable items",
+		                          self);
+	}
+
+	size = sizeof(struct lobject *) * array->count;
+	sort.buffer = lemon_allocator_alloc(lemon, size);
+	if (!sort.buffer) {
+		return NULL;
+	}
+	sort.lemon = lemon;
+	sort.items = array->items;
+	sort.nruns = 0;
+
+	lo = 0;
+	minrun = larray_sort_minrun(array->count);
+	while (lo < array->count) {
+		run = larray_sort_count_run(&sort, lo, array->count);
+		if (run < minrun) {
+			force = minrun;
+			if (force > array->count - lo) {
+				force = array->count - lo;
+			}
+			larray_sort_binary_insertion(&sort,
+			                             lo,
+			                             lo + force,
+			                             lo + run);
+			run = force;
+		}
+
+		sort.base[sort.nruns] = lo;
+		sort.length[sort.nruns] = run;
+		sort.nruns += 1;
+		larray_sort_collapse(&sort);
+
+		lo += run;
+	}
+	larray_sort_force_collapse(&sort);
+	lemon_allocator_free(lemon, sort.buffer);
+
+	return lemon->l_nil;
+}
+
 static struct lobject *
 larray_iterator_next(struct lemon *lemon,
                      struct lobject *iterable,
@@ -233,6 +863,46 @@ larray_get_attr(struct lemon *lemon,
 		return lfunction_create(lemon, name, self, larray_pop);
 	}
 
+	if (strcmp(cstr, "shift") == 0) {
+		return lfunction_create(lemon, name, self, larray_shift);
+	}
+
+	if (strcmp(cstr, "unshift") == 0) {
+		return lfunction_create(lemon, name, self, larray_unshift);
+	}
+
+	if (strcmp(cstr, "insert") == 0) {
+		return lfunction_create(lemon, name, self, larray_insert);
+	}
+
+	if (strcmp(cstr, "extend") == 0) {
+		return lfunction_create(lemon, name, self, larray_extend);
+	}
+
+	if (strcmp(cstr, "remove") == 0) {
+		return lfunction_create(lemon, name, self, larray_remove);
+	}
+
+	if (strcmp(cstr, "index") == 0) {
+		return lfunction_create(lemon, name, self, larray_index);
+	}
+
+	if (strcmp(cstr, "count") == 0) {
+		return lfunction_create(lemon, name, self, larray_count);
+	}
+
+	if (strcmp(cstr, "reverse") == 0) {
+		return lfunction_create(lemon, name, self, larray_reverse);
+	}
+
+	if (strcmp(cstr, "clear") == 0) {
+		return lfunction_create(lemon, name, self, larray_clear);
+	}
+
+	if (strcmp(cstr, "sort") == 0) {
+		return lfunction_create(lemon, name, self, larray_sort);
+	}
+
 	if (strcmp(cstr, "__iterator__") == 0) {
 		return lfunction_create(lemon, name, self, larray_iterator);
 	}
@@ -348,7 +1018,7 @@ larray_mark(struct lemon *lemon, struct larray *self)
 static struct lobject *
 larray_destroy(struct lemon *lemon, struct larray *self)
 {
-	lemon_allocator_free(lemon, self->items);
+	lemon_allocator_free(lemon, self->base);
 
 	return NULL;
 }
@@ -437,10 +1107,11 @@ larray_create(struct lemon *lemon, int count, struct lobject *items[])
 	if (self) {
 		if (count) {
 			size = sizeof(struct lobject *) * (count);
-			self->items = lemon_allocator_alloc(lemon, size);
-			if (!self->items) {
+			self->base = lemon_allocator_alloc(lemon, size);
+			if (!self->base) {
 				return NULL;
 			}
+			self->items = self->base;
 			for (i = 0; i < count; i++) {
 				self->items[i] = items[i];
 			}
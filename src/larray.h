@@ -3,11 +3,16 @@
 
 #include "lobject.h"
 
+/*
+ * `items' point to first item inside allocated `base', free slots before
+ * `items' make shift and unshift O(1) as deque, items are still continuous.
+ */
 struct larray {
 	struct lobject object;
 
-	int alloc;
+	int alloc; /* slots of `base' */
 	int count;
+	struct lobject **base;
 	struct lobject **items;
 };
 
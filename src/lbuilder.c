@@ -0,0 +1,368 @@
+#include "lemon.h"
+#include "lstring.h"
+#include "linteger.h"
+#include "lbuilder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LBUILDER_MIN_CAPACITY 32
+
+struct lobject *
+lbuilder_reserve(struct lemon *lemon, struct lobject *self, long capacity)
+{
+	long newcapacity;
+	struct lbuilder *builder;
+	struct lobject *string;
+
+	builder = (struct lbuilder *)self;
+	if (builder->string &&
+	    !builder->shared &&
+	    builder->capacity >= capacity)
+	{
+		return lemon->l_nil;
+	}
+
+	/* grow geometric make appending amortized O(1) */
+	newcapacity = builder->capacity * 2;
+	if (newcapacity < capacity) {
+		newcapacity = capacity;
+	}
+	if (newcapacity < LBUILDER_MIN_CAPACITY) {
+		newcapacity = LBUILDER_MIN_CAPACITY;
+	}
+
+	string = lstring_create(lemon, NULL, newcapacity);
+	if (!string) {
+		return NULL;
+	}
+	if (builder->length) {
+		memcpy(lstring_buffer(lemon, string),
+		       lstring_buffer(lemon, builder->string),
+		       builder->length);
+	}
+	builder->string = string;
+	builder->shared = 0;
+	builder->capacity = newcapacity;
+	lemon_collector_barrierback(lemon, self, string);
+
+	return lemon->l_nil;
+}
+
+struct lobject *
+lbuilder_append(struct lemon *lemon,
+                struct lobject *self,
+                const char *buffer,
+                long length)
+{
+	struct lbuilder *builder;
+
+	builder = (struct lbuilder *)self;
+	if (!lbuilder_reserve(lemon, self, builder->length + length)) {
+		return NULL;
+	}
+	memcpy(lstring_buffer(lemon, builder->string) + builder->length,
+	       buffer,
+	       length);
+	builder->length += length;
+
+	return lemon->l_nil;
+}
+
+struct lobject *
+lbuilder_append_object(struct lemon *lemon,
+                       struct lobject *self,
+                       struct lobject *object)
+{
+	if (!lobject_is_string(lemon, object)) {
+		object = lobject_string(lemon, object);
+		if (!object || lobject_is_error(lemon, object)) {
+			return object;
+		}
+	}
+
+	return lbuilder_append(lemon,
+	                       self,
+	                       lstring_buffer(lemon, object),
+	                       lstring_length(lemon, object));
+}
+
+struct lobject *
+lbuilder_string(struct lemon *lemon, struct lobject *self)
+{
+	struct lstring *string;
+	struct lbuilder *builder;
+
+	builder = (struct lbuilder *)self;
+	if (!builder->length) {
+		return lemon->l_empty_string;
+	}
+
+	/*
+	 * shrink `string' to used bytes and hand it out without copy,
+	 * rest capacity is wasted until next append copy the buffer
+	 */
+	string = (struct lstring *)builder->string;
+	string->length = builder->length;
+	string->buffer[string->length] = '\0';
+	builder->shared = 1;
+
+	return builder->string;
+}
+
+static struct lobject *
+lbuilder_append_function(struct lemon *lemon,
+                         struct lobject *self,
+                         int argc, struct lobject *argv[])
+{
+	int i;
+	struct lobject *value;
+
+	for (i = 0; i < argc; i++) {
+		value = lbuilder_append_object(lemon, self, argv[i]);
+		if (!value || lobject_is_error(lemon, value)) {
+			return value;
+		}
+	}
+
+	return self;
+}
+
+static struct lobject *
+lbuilder_appendf_callback(struct lemon *lemon,
+                          struct lframe *frame,
+                          struct lobject *retval)
+{
+	struct lobject *value;
+
+	if (!lobject_is_string(lemon, retval)) {
+		return lobject_error_type(lemon,
+		                          "'%@' format return non-string",
+		                          frame->self);
+	}
+
+	value = lbuilder_append_object(lemon, frame->self, retval);
+	if (!value || lobject_is_error(lemon, value)) {
+		return value;
+	}
+
+	return frame->self;
+}
+
+static struct lobject *
+lbuilder_appendf(struct lemon *lemon,
+                 struct lobject *self,
+                 int argc, struct lobject *argv[])
+{
+	struct lframe *frame;
+	struct lobject *name;
+
+	if (argc < 1 || !lobject_is_string(lemon, argv[0])) {
+		const char *fmt;
+
+		fmt = "'%@' required format string";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	frame = lemon_machine_push_new_frame(lemon,
+	                                     self,
+	                                     NULL,
+	                                     lbuilder_appendf_callback,
+	                                     0);
+	if (!frame) {
+		return NULL;
+	}
+
+	/* format may call `__string__' of instance, so use callback */
+	name = lstring_create(lemon, "format", 6);
+	if (!name) {
+		return NULL;
+	}
+
+	return lobject_call_attr(lemon, argv[0], name, argc - 1, argv + 1);
+}
+
+static struct lobject *
+lbuilder_reserve_function(struct lemon *lemon,
+                          struct lobject *self,
+                          int argc, struct lobject *argv[])
+{
+	long capacity;
+
+	if (argc != 1 || !lobject_is_integer(lemon, argv[0])) {
+		const char *fmt;
+
+		fmt = "'%@' accept 1 integer argument";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	capacity = linteger_to_long(lemon, argv[0]);
+	if (!lbuilder_reserve(lemon, self, capacity)) {
+		return NULL;
+	}
+
+	return self;
+}
+
+static struct lobject *
+lbuilder_clear(struct lemon *lemon,
+               struct lobject *self,
+               int argc, struct lobject *argv[])
+{
+	((struct lbuilder *)self)->length = 0;
+
+	return self;
+}
+
+static struct lobject *
+lbuilder_tostring(struct lemon *lemon,
+                  struct lobject *self,
+                  int argc, struct lobject *argv[])
+{
+	return lbuilder_string(lemon, self);
+}
+
+static struct lobject *
+lbuilder_get_attr(struct lemon *lemon,
+                  struct lobject *self,
+                  struct lobject *name)
+{
+	const char *cstr;
+
+	cstr = lstring_to_cstr(lemon, name);
+	if (strcmp(cstr, "append") == 0) {
+		return lfunction_create(lemon,
+		                        name,
+		                        self,
+		                        lbuilder_append_function);
+	}
+
+	if (strcmp(cstr, "appendf") == 0) {
+		return lfunction_create(lemon, name, self, lbuilder_appendf);
+	}
+
+	if (strcmp(cstr, "reserve") == 0) {
+		return lfunction_create(lemon,
+		                        name,
+		                        self,
+		                        lbuilder_reserve_function);
+	}
+
+	if (strcmp(cstr, "clear") == 0) {
+		return lfunction_create(lemon, name, self, lbuilder_clear);
+	}
+
+	if (strcmp(cstr, "tostring") == 0) {
+		return lfunction_create(lemon, name, self, lbuilder_tostring);
+	}
+
+	return NULL;
+}
+
+static struct lobject *
+lbuilder_mark(struct lemon *lemon, struct lbuilder *self)
+{
+	if (self->string) {
+		lobject_mark(lemon, self->string);
+	}
+
+	return NULL;
+}
+
+static struct lobject *
+lbuilder_method(struct lemon *lemon,
+                struct lobject *self,
+                int method, int argc, struct lobject *argv[])
+{
+#define cast(a) ((struct lbuilder *)(a))
+
+	switch (method) {
+	case LOBJECT_METHOD_GET_ATTR:
+		return lbuilder_get_attr(lemon, self, argv[0]);
+
+	case LOBJECT_METHOD_STRING:
+		return lbuilder_string(lemon, self);
+
+	case LOBJECT_METHOD_LENGTH:
+		return linteger_create_from_long(lemon, cast(self)->length);
+
+	case LOBJECT_METHOD_BOOLEAN:
+		if (cast(self)->length) {
+			return lemon->l_true;
+		}
+		return lemon->l_false;
+
+	case LOBJECT_METHOD_MARK:
+		return lbuilder_mark(lemon, cast(self));
+
+	case LOBJECT_METHOD_DESTROY:
+		return NULL;
+
+	default:
+		return lobject_default(lemon, self, method, argc, argv);
+	}
+}
+
+void *
+lbuilder_create(struct lemon *lemon, long capacity)
+{
+	struct lbuilder *self;
+
+	self = lobject_create(lemon, sizeof(*self), lbuilder_method);
+	if (self && capacity > 0) {
+		if (!lbuilder_reserve(lemon, (struct lobject *)self, capacity)) {
+			return NULL;
+		}
+	}
+
+	return self;
+}
+
+static struct lobject *
+lbuilder_type_method(struct lemon *lemon,
+                     struct lobject *self,
+                     int method, int argc, struct lobject *argv[])
+{
+	switch (method) {
+	case LOBJECT_METHOD_CALL: {
+		int i;
+		struct lobject *value;
+		struct lobject *builder;
+
+		builder = lbuilder_create(lemon, 0);
+		if (!builder) {
+			return NULL;
+		}
+		for (i = 0; i < argc; i++) {
+			value = lbuilder_append_object(lemon, builder, argv[i]);
+			if (!value || lobject_is_error(lemon, value)) {
+				return value;
+			}
+		}
+
+		return builder;
+	}
+
+	case LOBJECT_METHOD_CALLABLE:
+		return lemon->l_true;
+
+	default:
+		return lobject_default(lemon, self, method, argc, argv);
+	}
+}
+
+struct ltype *
+lbuilder_type_create(struct lemon *lemon)
+{
+	struct ltype *type;
+
+	type = ltype_create(lemon,
+	                    "builder",
+	                    lbuilder_method,
+	                    lbuilder_type_method);
+	if (type) {
+		lemon_add_global(lemon, "builder", type);
+	}
+
+	return type;
+}
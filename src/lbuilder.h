@@ -0,0 +1,50 @@
+#ifndef LEMON_LBUILDER_H
+#define LEMON_LBUILDER_H
+
+#include "lobject.h"
+
+/*
+ * mutable string builder
+ *
+ *     var b = builder();
+ *     b.append('a', 'b');
+ *     b.appendf('{} + {}', 1, 2);
+ *     string(b);
+ *
+ * `string' is an over-allocated lstring, appending write into its buffer
+ * and `lbuilder_string' return `string' directly after terminate it,
+ * the builder copy buffer only when append after `lbuilder_string'.
+ */
+struct lbuilder {
+	struct lobject object;
+
+	int shared; /* `string' has been returned by `lbuilder_string' */
+	long length; /* used bytes of `string' */
+	long capacity; /* available bytes of `string' */
+	struct lobject *string;
+};
+
+struct lobject *
+lbuilder_reserve(struct lemon *lemon, struct lobject *self, long capacity);
+
+struct lobject *
+lbuilder_append(struct lemon *lemon,
+                struct lobject *self,
+                const char *buffer,
+                long length);
+
+struct lobject *
+lbuilder_append_object(struct lemon *lemon,
+                       struct lobject *self,
+                       struct lobject *object);
+
+struct lobject *
+lbuilder_string(struct lemon *lemon, struct lobject *self);
+
+void *
+lbuilder_create(struct lemon *lemon, long capacity);
+
+struct ltype *
+lbuilder_type_create(struct lemon *lemon);
+
+#endif /* LEMON_LBUILDER_H */
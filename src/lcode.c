@@ -0,0 +1,90 @@
+#include "lemon.h"
+#include "lcode.h"
+#include "lstring.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static struct lobject *
+lcode_string(struct lemon *lemon, struct lcode *self)
+{
+	char buffer[64];
+
+	snprintf(buffer,
+	         sizeof(buffer),
+	         "<code %d bytes %d constants>",
+	         self->length,
+	         self->ncpool);
+	buffer[sizeof(buffer) - 1] = '\0';
+
+	return lstring_create(lemon, buffer, strlen(buffer));
+}
+
+static struct lobject *
+lcode_mark(struct lemon *lemon, struct lcode *self)
+{
+	int i;
+
+	for (i = 0; i < self->ncpool; i++) {
+		lobject_mark(lemon, self->cpool[i]);
+	}
+
+	return NULL;
+}
+
+static struct lobject *
+lcode_method(struct lemon *lemon,
+             struct lobject *self,
+             int method, int argc, struct lobject *argv[])
+{
+#define cast(a) ((struct lcode *)(a))
+
+	switch (method) {
+	case LOBJECT_METHOD_STRING:
+		return lcode_string(lemon, cast(self));
+
+	case LOBJECT_METHOD_MARK:
+		return lcode_mark(lemon, cast(self));
+
+	case LOBJECT_METHOD_DESTROY:
+		return NULL;
+
+	default:
+		return lobject_default(lemon, self, method, argc, argv);
+	}
+}
+
+void *
+lcode_create(struct lemon *lemon,
+             int length,
+             int ncpool,
+             struct lobject *cpool[])
+{
+	size_t size;
+	struct lcode *self;
+
+	/* constants and code follow the object in one allocation */
+	size = sizeof(*self);
+	size += sizeof(struct lobject *) * ncpool;
+	size += sizeof(unsigned char) * length;
+	self = lobject_create(lemon, size, lcode_method);
+	if (self) {
+		self->length = length;
+		self->ncpool = ncpool;
+		self->cpool = (struct lobject **)(self + 1);
+		self->code = (unsigned char *)(self->cpool + ncpool);
+		if (ncpool) {
+			memcpy(self->cpool,
+			       cpool,
+			       sizeof(struct lobject *) * ncpool);
+		}
+	}
+
+	return self;
+}
+
+struct ltype *
+lcode_type_create(struct lemon *lemon)
+{
+	return ltype_create(lemon, "code", lcode_method, NULL);
+}
@@ -0,0 +1,35 @@
+#ifndef LEMON_LCODE_H
+#define LEMON_LCODE_H
+
+#include "lobject.h"
+
+/*
+ * bytecode and constants of one compilation (program with its imported
+ * modules, or one lazy function's body).  function and frame reference
+ * their code object, machine switch `code' and `cpool' on call and
+ * return, code no longer referenced is collected like other object.
+ */
+struct lcode {
+	struct lobject object;
+
+	int length; /* bytes of code */
+	int ncpool; /* number of constants */
+
+	unsigned char *code;
+	struct lobject **cpool;
+};
+
+/*
+ * copy `ncpool' constants, `length' bytes of code is zero filled and
+ * written by generator
+ */
+void *
+lcode_create(struct lemon *lemon,
+             int length,
+             int ncpool,
+             struct lobject *cpool[]);
+
+struct ltype *
+lcode_type_create(struct lemon *lemon);
+
+#endif /* LEMON_LCODE_H */
@@ -13,6 +13,7 @@ lcontinuation_call(struct lemon *lemon,
 	int i;
 	int ra;
 	struct lframe *frame;
+	struct lobject *rc;
 
 	lemon_machine_set_sp(lemon, -1);
 	for (i = 0; i < self->stacklen; i++) {
@@ -20,12 +21,14 @@ lcontinuation_call(struct lemon *lemon,
 	}
 
 	ra = lemon_machine_get_ra(lemon);
+	rc = lemon_machine_get_rc(lemon);
 	lemon_machine_set_fp(lemon, -1);
 	for (i = 0; i < self->framelen; i++) {
 		frame = self->frame[i];
 		lemon_machine_push_frame(lemon, frame);
 	}
 	lemon_machine_set_ra(lemon, ra);
+	lemon_machine_set_rc(lemon, rc);
 
 	frame = lemon_machine_pop_frame(lemon);
 	lemon_machine_restore_frame(lemon, frame);
@@ -34,6 +37,7 @@ lcontinuation_call(struct lemon *lemon,
 	} else {
 		lemon_machine_push_object(lemon, lemon->l_nil);
 	}
+	lemon_machine_set_code(lemon, self->code);
 	lemon_machine_set_pc(lemon, self->address);
 	lemon_machine_set_pause(lemon, self->pause);
 
@@ -49,6 +53,10 @@ lcontinuation_mark(struct lemon *lemon, struct lcontinuation *self)
 		lobject_mark(lemon, self->value);
 	}
 
+	if (self->code) {
+		lobject_mark(lemon, self->code);
+	}
+
 	for (i = 0; i < self->framelen; i++) {
 		lobject_mark(lemon, (struct lobject *)self->frame[i]);
 	}
@@ -134,6 +142,7 @@ lcontinuation_callcc(struct lemon *lemon,
 	if (!continuation) {
 		return NULL;
 	}
+	continuation->code = lemon_machine_get_code(lemon);
 	continuation->address = lemon_machine_get_pc(lemon);
 
 	framelen = lemon_machine_get_fp(lemon) + 1;
@@ -145,6 +154,7 @@ lcontinuation_callcc(struct lemon *lemon,
 	}
 	for (i = 0; i < framelen; i++) {
 		continuation->frame[i] = lemon_machine_get_frame(lemon, i);
+		continuation->frame[i]->captured = 1;
 	}
 	continuation->framelen = framelen;
 
@@ -186,7 +196,10 @@ lcontinuation_type_create(struct lemon *lemon)
 
 	cstr = "callcc";
 	name = lstring_create(lemon, cstr, strlen(cstr));
-	function = lfunction_create(lemon, name, NULL, lcontinuation_callcc);
+	function = lfunction_create_framed(lemon,
+	                                   name,
+	                                   NULL,
+	                                   lcontinuation_callcc);
 	lemon_add_global(lemon, cstr, function);
 
 	return type;
@@ -9,6 +9,7 @@ struct lcontinuation {
 	struct lobject object;
 
 	int address;
+	struct lobject *code; /* code object of `address' */
 	int framelen;
 	int stacklen;
 
@@ -68,6 +68,7 @@ lcoroutine_resume(struct lemon *lemon,
 	} else {
 		lemon_machine_push_object(lemon, lemon->l_nil);
 	}
+	lemon_machine_set_code(lemon, coroutine->code);
 	lemon_machine_set_pc(lemon, coroutine->address);
 	coroutine->finished = 1;
 
@@ -97,7 +98,11 @@ lcoroutine_transfer(struct lemon *lemon,
 	/* save old coroutine */
 	coroutine = (struct lcoroutine *)frame->callee;
 	coroutine->frame = frame;
+	coroutine->code = lemon_machine_get_code(lemon);
 	coroutine->address = lemon_machine_get_pc(lemon);
+	lemon_collector_barrier(lemon,
+	                        (struct lobject *)coroutine,
+	                        coroutine->code);
 
 	if (lemon_machine_get_sp(lemon) - frame->sp > 0) {
 		coroutine->stacklen = lemon_machine_get_sp(lemon) - frame->sp;
@@ -128,6 +133,7 @@ lcoroutine_transfer(struct lemon *lemon,
 	} else {
 		lemon_machine_push_object(lemon, lemon->l_nil);
 	}
+	lemon_machine_set_code(lemon, coroutine->code);
 	lemon_machine_set_pc(lemon, coroutine->address);
 
 	return lemon->l_nil;
@@ -142,11 +148,17 @@ lcoroutine_get_attr(struct lemon *lemon,
 
 	cstr = lstring_to_cstr(lemon, name);
 	if (strcmp(cstr, "resume") == 0) {
-		return lfunction_create(lemon, name, self, lcoroutine_resume);
+		return lfunction_create_framed(lemon,
+		                               name,
+		                               self,
+		                               lcoroutine_resume);
 	}
 
 	if (strcmp(cstr, "transfer") == 0) {
-		return lfunction_create(lemon, name, self, lcoroutine_transfer);
+		return lfunction_create_framed(lemon,
+		                               name,
+		                               self,
+		                               lcoroutine_transfer);
 	}
 
 	if (strcmp(cstr, "current") == 0) {
@@ -162,6 +174,9 @@ lcoroutine_mark(struct lemon *lemon, struct lcoroutine *self)
 	int i;
 
 	lobject_mark(lemon, (struct lobject *)self->frame);
+	if (self->code) {
+		lobject_mark(lemon, self->code);
+	}
 	for (i = 0; i < self->stacklen; i++) {
 		lobject_mark(lemon, self->stack[i]);
 	}
@@ -243,7 +258,11 @@ lcoroutine_yield(struct lemon *lemon,
 		coroutine = lcoroutine_create(lemon, frame);
 		frame->callee = (struct lobject *)coroutine;
 	}
+	coroutine->code = lemon_machine_get_code(lemon);
 	coroutine->address = lemon_machine_get_pc(lemon);
+	lemon_collector_barrier(lemon,
+	                        (struct lobject *)coroutine,
+	                        coroutine->code);
 	coroutine->finished = 0;
 
 	if (lemon_machine_get_sp(lemon) - frame->sp > 0) {
@@ -293,7 +312,7 @@ lcoroutine_type_create(struct lemon *lemon)
 
 	cstr = "yield";
 	name = lstring_create(lemon, cstr, strlen(cstr));
-	function = lfunction_create(lemon, name, NULL, lcoroutine_yield);
+	function = lfunction_create_framed(lemon, name, NULL, lcoroutine_yield);
 	lemon_add_global(lemon, cstr, function);
 
 	return type;
@@ -11,6 +11,7 @@ struct lcoroutine {
 	struct lframe *frame;
 
 	int address;
+	struct lobject *code; /* code object of `address' */
 	int stacklen;
 	int finished;
 
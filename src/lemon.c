@@ -10,6 +10,7 @@
 #include "machine.h"
 #include "compiler.h"
 #include "peephole.h"
+#include "flowgraph.h"
 #include "generator.h"
 #include "allocator.h"
 #include "collector.h"
@@ -21,13 +22,17 @@
 #include "larray.h"
 #include "lsuper.h"
 #include "lclass.h"
+#include "lcode.h"
 #include "lnumber.h"
 #include "lstring.h"
+#include "lbuilder.h"
+#include "lrange.h"
 #include "linteger.h"
 #include "lmodule.h"
 #include "lboolean.h"
 #include "linstance.h"
 #include "literator.h"
+#include "ltypedarray.h"
 #include "lsentinel.h"
 #include "lcoroutine.h"
 #include "lcontinuation.h"
@@ -88,6 +93,8 @@ lemon_init_types(struct lemon *lemon)
 	CHECK_NULL(lemon->l_sentinel);
 	lemon->l_frame_type = lframe_type_create(lemon);
 	CHECK_NULL(lemon->l_sentinel);
+	lemon->l_code_type = lcode_type_create(lemon);
+	CHECK_NULL(lemon->l_code_type);
 	lemon->l_array_type = larray_type_create(lemon);
 	CHECK_NULL(lemon->l_sentinel);
 	lemon->l_number_type = lnumber_type_create(lemon);
@@ -112,6 +119,16 @@ lemon_init_types(struct lemon *lemon)
 	CHECK_NULL(lemon->l_sentinel);
 	lemon->l_continuation_type = lcontinuation_type_create(lemon);
 	CHECK_NULL(lemon->l_sentinel);
+	lemon->l_builder_type = lbuilder_type_create(lemon);
+	CHECK_NULL(lemon->l_builder_type);
+	lemon->l_range_type = lrange_type_create(lemon);
+	CHECK_NULL(lemon->l_range_type);
+	lemon->l_int64array_type = ltypedarray_int64_type_create(lemon);
+	CHECK_NULL(lemon->l_int64array_type);
+	lemon->l_float64array_type = ltypedarray_float64_type_create(lemon);
+	CHECK_NULL(lemon->l_float64array_type);
+	lemon->l_uint8array_type = ltypedarray_uint8_type_create(lemon);
+	CHECK_NULL(lemon->l_uint8array_type);
 
 	return lemon->l_nil;
 }
@@ -282,6 +299,10 @@ lemon_create()
 	srandom(0x4c454d9d);
 	lemon->l_random = random();
 #endif
+	lemon->l_optimize = 2;
+	lemon->l_inline = 1;
+	lemon->l_recursion = LEMON_RECURSION_LIMIT;
+
 	lemon->l_allocator = allocator_create(lemon);
 	CHECK_NULL(lemon->l_allocator);
 
@@ -341,6 +362,11 @@ lemon_destroy(struct lemon *lemon)
 	lemon_allocator_free(lemon, lemon->l_types_slots);
 	lemon->l_types_slots = NULL;
 
+	symbol_intern_destroy(lemon);
+
+	lemon_allocator_free(lemon, lemon->l_scratch);
+	lemon->l_scratch = NULL;
+
 	allocator_destroy(lemon, lemon->l_allocator);
 	lemon->l_allocator = NULL;
 
@@ -349,34 +375,158 @@ lemon_destroy(struct lemon *lemon)
 
 #undef CHECK_NULL
 
+/*
+ * front-end memory (source, syntax tree, scopes, symbols and codes) is
+ * only needed until bytecode emitted, release it back to `mark'
+ */
+static void
+lemon_compile_release(struct lemon *lemon, struct arena_mark *mark)
+{
+	lemon->l_scope = NULL;
+	lemon->l_try_enclosing = NULL;
+	lemon->l_loop_enclosing = NULL;
+	lemon->l_stmt_enclosing = NULL;
+	lemon->l_space_enclosing = NULL;
+
+	input_reset(lemon);
+	generator_reset(lemon);
+	arena_reset(lemon, lemon->l_arena, mark);
+}
+
+static void
+lemon_compile_optimize(struct lemon *lemon)
+{
+	int i;
+
+	if (lemon->l_optimize > 0) {
+		peephole_optimize(lemon);
+	}
+	if (lemon->l_optimize > 1) {
+		/* folded branch may make more code unreachable */
+		for (i = 0; i < 4 && flowgraph_optimize(lemon); i++) {
+			peephole_optimize(lemon);
+		}
+	}
+}
+
 int
 lemon_compile(struct lemon *lemon)
 {
 	struct syntax *node;
+	struct lobject *code;
+	struct arena_mark mark;
 
+	arena_mark(lemon, lemon->l_arena, &mark);
 	lexer_next_token(lemon);
 
 	node = parser_parse(lemon);
 	if (!node) {
 		fprintf(stderr, "lemon: syntax error\n");
+		lemon_compile_release(lemon, &mark);
 
 		return 0;
 	}
 
 	if (!compiler_compile(lemon, node)) {
 		fprintf(stderr, "lemon: syntax error\n");
+		lemon_compile_release(lemon, &mark);
 
 		return 0;
 	}
-	peephole_optimize(lemon);
+	lemon_compile_optimize(lemon);
 
+	code = generator_emit(lemon);
+	lemon_compile_release(lemon, &mark);
+	if (!code) {
+		return 0;
+	}
+	lemon_machine_set_code(lemon, code);
 	machine_reset(lemon);
-	generator_emit(lemon);
 	collector_full(lemon);
 
 	return 1;
 }
 
+/*
+ * lazy function's body is compiled in the middle of execution into its
+ * own code object, compiler state (shell's scope) is kept.  code object,
+ * address and nlocals are appended to record for function's bound copy.
+ */
+int
+lemon_compile_lazy(struct lemon *lemon, struct lfunction *function)
+{
+	int done;
+	int nlocals;
+	struct lobject *code;
+	struct arena_mark mark;
+	struct lobject *items[3];
+	struct generator_label *entry;
+
+	void *scope;
+	void *try_enclosing;
+	void *loop_enclosing;
+	void *stmt_enclosing;
+	void *space_enclosing;
+
+	if (larray_length(lemon, function->lazy) > 5) {
+		items[0] = larray_get_item(lemon, function->lazy, 5);
+		items[1] = larray_get_item(lemon, function->lazy, 6);
+		items[2] = larray_get_item(lemon, function->lazy, 7);
+		function->code = items[0];
+		function->address = linteger_to_long(lemon, items[1]);
+		function->nlocals = linteger_to_long(lemon, items[2]);
+		lemon_collector_barrier(lemon,
+		                        (struct lobject *)function,
+		                        function->code);
+
+		return 1;
+	}
+
+	scope = lemon->l_scope;
+	try_enclosing = lemon->l_try_enclosing;
+	loop_enclosing = lemon->l_loop_enclosing;
+	stmt_enclosing = lemon->l_stmt_enclosing;
+	space_enclosing = lemon->l_space_enclosing;
+	lemon->l_scope = NULL;
+	lemon->l_try_enclosing = NULL;
+	lemon->l_loop_enclosing = NULL;
+	lemon->l_stmt_enclosing = NULL;
+	lemon->l_space_enclosing = NULL;
+
+	arena_mark(lemon, lemon->l_arena, &mark);
+	done = compiler_compile_lazy(lemon, function->lazy, &entry, &nlocals);
+	if (done) {
+		lemon_compile_optimize(lemon);
+
+		code = generator_emit(lemon);
+		items[0] = code;
+		items[1] = linteger_create_from_long(lemon, entry->address);
+		items[2] = linteger_create_from_long(lemon, nlocals);
+		if (!items[0] || !items[1] || !items[2] ||
+		    !larray_append(lemon, function->lazy, 3, items))
+		{
+			done = 0;
+		} else {
+			function->code = code;
+			function->address = entry->address;
+			function->nlocals = nlocals;
+			lemon_collector_barrier(lemon,
+			                        (struct lobject *)function,
+			                        code);
+		}
+	}
+	generator_reset(lemon);
+	arena_reset(lemon, lemon->l_arena, &mark);
+
+	lemon->l_scope = scope;
+	lemon->l_try_enclosing = try_enclosing;
+	lemon->l_loop_enclosing = loop_enclosing;
+	lemon->l_stmt_enclosing = stmt_enclosing;
+	lemon->l_space_enclosing = space_enclosing;
+
+	return done;
+}
+
 void
 lemon_mark_types(struct lemon *lemon)
 {
@@ -529,7 +679,10 @@ lemon_add_global(struct lemon *lemon, const char *name, void *object)
 	struct symbol *symbol;
 
 	symbol = scope_add_symbol(lemon, lemon->l_global, name, SYMBOL_GLOBAL);
-	symbol->cpool = machine_add_const(lemon, object);
+	symbol->global = machine_add_global(lemon, object);
+	if (symbol->global < 0) {
+		return NULL;
+	}
 
 	return object;
 }
@@ -9,11 +9,16 @@
 #include "lfunction.h"
 
 #define LEMON_NAME_MAX 256
+#define LEMON_RECURSION_LIMIT 100000 /* default max depth of frame stack */
 
 struct lobject;
 
 struct lemon {
 	long l_random;
+	int l_optimize; /* 0 none, 1 peephole, 2 flowgraph and peephole */
+	int l_lazy; /* 1 compile module level function at first call */
+	int l_inline; /* 1 inline small module level function at `-O2' */
+	int l_recursion; /* max depth of frame stack, 0 is unlimited */
 
 	void *l_arena;
 	void *l_input;
@@ -37,6 +42,19 @@ struct lemon {
 	unsigned long l_types_count;
 	unsigned long l_types_length;
 
+	/*
+	 * interned symbol names, see symbol_intern
+	 */
+	void *l_names_slots;
+	unsigned long l_names_count;
+	unsigned long l_names_length;
+
+	/*
+	 * big integer temporary digits, reused by every operation
+	 */
+	void *l_scratch;
+	long l_scratch_size;
+
 	/*
 	 * use lobject->method and ltype->method to identify lobject's type
 	 */
@@ -48,6 +66,7 @@ struct lemon {
 	struct ltype *l_super_type;
 	struct ltype *l_class_type;
 	struct ltype *l_frame_type;
+	struct ltype *l_code_type;
 	struct ltype *l_array_type;
 	struct ltype *l_number_type;
 	struct ltype *l_string_type;
@@ -61,6 +80,11 @@ struct lemon {
 	struct ltype *l_exception_type;
 	struct ltype *l_dictionary_type;
 	struct ltype *l_continuation_type;
+	struct ltype *l_builder_type;
+	struct ltype *l_range_type;
+	struct ltype *l_int64array_type;
+	struct ltype *l_float64array_type;
+	struct ltype *l_uint8array_type;
 
 	struct lobject *l_nil;
 	struct lobject *l_true;
@@ -112,9 +136,16 @@ lemon_create();
 void
 lemon_destroy(struct lemon *lemon);
 
+/*
+ * compile input into new code object and make it running code at pc 0,
+ * previous code object is collected when no function reference it
+ */
 int
 lemon_compile(struct lemon *lemon);
 
+int
+lemon_compile_lazy(struct lemon *lemon, struct lfunction *function);
+
 int
 lemon_input_set_file(struct lemon *lemon,
                      const char *filename);
@@ -192,6 +223,25 @@ lemon_machine_get_ra(struct lemon *lemon);
 void
 lemon_machine_set_ra(struct lemon *lemon, int ra);
 
+/*
+ * code object of first function frame's ra (machine->frame[1]->code)
+ */
+struct lobject *
+lemon_machine_get_rc(struct lemon *lemon);
+
+void
+lemon_machine_set_rc(struct lemon *lemon, struct lobject *code);
+
+/*
+ * running code object, pc is offset in it.  set code object also set
+ * `maxpc' and constant pool, pc is not changed
+ */
+struct lobject *
+lemon_machine_get_code(struct lemon *lemon);
+
+void
+lemon_machine_set_code(struct lemon *lemon, struct lobject *code);
+
 struct lobject *
 lemon_machine_get_stack(struct lemon *lemon, int sp);
 
@@ -208,6 +258,12 @@ lemon_machine_get_frame(struct lemon *lemon, int fp);
 void
 lemon_machine_set_frame(struct lemon *lemon, int fp, struct lframe *frame);
 
+/*
+ * return `RuntimeError' if call exceed recursion limit, otherwise NULL
+ */
+struct lobject *
+lemon_machine_check_recursion(struct lemon *lemon);
+
 /*
  * 1. create frame
  * 2. store frame
@@ -272,6 +328,22 @@ lemon_machine_parse_args(struct lemon *lemon,
                          int argc,
                          struct lobject *argv[]);
 
+/*
+ * same as `lemon_machine_parse_args', last items of `argv' are keyword
+ * values named by array `keywords' (NULL if none)
+ */
+struct lobject *
+lemon_machine_parse_kargs(struct lemon *lemon,
+                          struct lobject *callee,
+                          struct lframe *frame,
+                          int define,
+                          int nvalues,
+                          int nparams,
+                          struct lobject *params[],
+                          int argc,
+                          struct lobject *argv[],
+                          struct lobject *keywords);
+
 int
 lemon_machine_execute(struct lemon *lemon);
 
@@ -16,6 +16,10 @@ lexception_addtrace_attr(struct lemon *lemon,
 
 	exception = (struct lexception *)self;
 	for (i = 0; i < argc; i++) {
+		/* deep recursion only trace innermost frames */
+		if (exception->nframe == 128) {
+			break;
+		}
 		exception->frame[exception->nframe++] = argv[i];
 	}
 
@@ -2,13 +2,134 @@
 #include "token.h"
 #include "input.h"
 #include "lexer.h"
-#include "symbol.h"
 
-#include <ctype.h>
 #include <stdio.h>
-#include <assert.h>
 #include <string.h>
 
+/*
+ * lexer scan `input->buffer' directly, buffer is always '\0' terminated
+ * so scanning stop at '\0' without check size.  `input->offset' is
+ * updated once per token, line and column are computed from offset only
+ * when required (see `input_line').
+ */
+
+#define LEXER_SPACE 0x1
+#define LEXER_ALPHA 0x2 /* letter and '_' */
+#define LEXER_DIGIT 0x4
+#define LEXER_HEX   0x8 /* 'a' - 'f' and 'A' - 'F' */
+
+#define S LEXER_SPACE
+#define A LEXER_ALPHA
+#define D LEXER_DIGIT
+#define X (LEXER_ALPHA | LEXER_HEX)
+
+/* non-ASCII byte is 0, ctype.h is locale dependent */
+static const unsigned char lexer_class[256] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, S, S, S, S, S, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0,
+	0, X, X, X, X, X, X, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, A,
+	0, X, X, X, X, X, X, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,
+};
+
+#undef S
+#undef A
+#undef D
+#undef X
+
+#define IS_CLASS(c, m) (lexer_class[(unsigned char)(c)] & (m))
+
+/*
+ * perfect hash of keywords, `n' is length of name `s'
+ *
+ *     (s[0] + s[2] * 17 + s[n - 1] * 61 + n) & 63
+ *
+ * s[1] is used if n == 2.  multipliers are brute force searched, search
+ * again and rebuild the table when add keyword.
+ */
+#define LEXER_KEYWORD_MIN 2
+#define LEXER_KEYWORD_MAX 8
+
+#define LEXER_KEYWORD_HASH(s, n)                      \
+	(((unsigned char)(s)[0] +                     \
+	  (unsigned char)(s)[(n) > 2 ? 2 : 1] * 17 +  \
+	  (unsigned char)(s)[(n) - 1] * 61 + (n)) & 63)
+
+struct lexer_keyword {
+	const char *name;
+	int token;
+};
+
+static const struct lexer_keyword lexer_keywords[64] = {
+	/*  0 */ { "class", TOKEN_CLASS },
+	/*  1 */ { "define", TOKEN_DEFINE },
+	/*  2 */ { NULL, 0 },
+	/*  3 */ { "import", TOKEN_IMPORT },
+	/*  4 */ { NULL, 0 },
+	/*  5 */ { "sentinel", TOKEN_SENTINEL },
+	/*  6 */ { "while", TOKEN_WHILE },
+	/*  7 */ { NULL, 0 },
+	/*  8 */ { NULL, 0 },
+	/*  9 */ { NULL, 0 },
+	/* 10 */ { "continue", TOKEN_CONTINUE },
+	/* 11 */ { "getter", TOKEN_ACCESSOR_GETTER },
+	/* 12 */ { NULL, 0 },
+	/* 13 */ { NULL, 0 },
+	/* 14 */ { "true", TOKEN_TRUE },
+	/* 15 */ { NULL, 0 },
+	/* 16 */ { "finally", TOKEN_FINALLY },
+	/* 17 */ { NULL, 0 },
+	/* 18 */ { "super", TOKEN_SUPER },
+	/* 19 */ { NULL, 0 },
+	/* 20 */ { NULL, 0 },
+	/* 21 */ { "try", TOKEN_TRY },
+	/* 22 */ { NULL, 0 },
+	/* 23 */ { "setter", TOKEN_ACCESSOR_SETTER },
+	/* 24 */ { "this", TOKEN_SELF },
+	/* 25 */ { "nil", TOKEN_NIL },
+	/* 26 */ { NULL, 0 },
+	/* 27 */ { "break", TOKEN_BREAK },
+	/* 28 */ { NULL, 0 },
+	/* 29 */ { "else", TOKEN_ELSE },
+	/* 30 */ { NULL, 0 },
+	/* 31 */ { NULL, 0 },
+	/* 32 */ { NULL, 0 },
+	/* 33 */ { NULL, 0 },
+	/* 34 */ { "return", TOKEN_RETURN },
+	/* 35 */ { NULL, 0 },
+	/* 36 */ { "catch", TOKEN_CATCH },
+	/* 37 */ { "for", TOKEN_FOR },
+	/* 38 */ { "throw", TOKEN_THROW },
+	/* 39 */ { "delete", TOKEN_DELETE },
+	/* 40 */ { "false", TOKEN_FALSE },
+	/* 41 */ { NULL, 0 },
+	/* 42 */ { NULL, 0 },
+	/* 43 */ { NULL, 0 },
+	/* 44 */ { NULL, 0 },
+	/* 45 */ { "as", TOKEN_AS },
+	/* 46 */ { NULL, 0 },
+	/* 47 */ { "in", TOKEN_IN },
+	/* 48 */ { NULL, 0 },
+	/* 49 */ { "self", TOKEN_SELF },
+	/* 50 */ { "function", TOKEN_DEFINE },
+	/* 51 */ { NULL, 0 },
+	/* 52 */ { NULL, 0 },
+	/* 53 */ { "var", TOKEN_VAR },
+	/* 54 */ { NULL, 0 },
+	/* 55 */ { NULL, 0 },
+	/* 56 */ { NULL, 0 },
+	/* 57 */ { NULL, 0 },
+	/* 58 */ { NULL, 0 },
+	/* 59 */ { "def", TOKEN_DEFINE },
+	/* 60 */ { NULL, 0 },
+	/* 61 */ { NULL, 0 },
+	/* 62 */ { NULL, 0 },
+	/* 63 */ { "if", TOKEN_IF },
+};
+
 struct lexer *
 lexer_create(struct lemon *lemon)
 {
@@ -26,6 +147,7 @@ lexer_create(struct lemon *lemon)
 void
 lexer_destroy(struct lemon *lemon, struct lexer *lexer)
 {
+	lemon_allocator_free(lemon, lexer->text);
 	lemon_allocator_free(lemon, lexer);
 }
 
@@ -56,154 +178,175 @@ lexer_get_token(struct lemon *lemon)
 	return lexer->lookahead;
 }
 
-void
-lexer_scan_number(struct lemon *lemon, int c)
+int
+lexer_get_depth(struct lemon *lemon)
+{
+	struct lexer *lexer;
+
+	lexer = lemon->l_lexer;
+	return lexer->depth;
+}
+
+long
+lexer_get_offset(struct lemon *lemon)
+{
+	struct lexer *lexer;
+
+	lexer = lemon->l_lexer;
+	return lexer->offset;
+}
+
+static void
+lexer_error(struct lemon *lemon, char *p, const char *message)
+{
+	struct input *input;
+
+	input = lemon->l_input;
+	input->offset = p - input->buffer;
+	fprintf(stderr,
+	        "%s:%ld:%ld: error: %s\n",
+	        input_filename(lemon),
+	        input_line(lemon) + 1,
+	        input_column(lemon) + 1,
+	        message);
+}
+
+static char *
+lexer_scan_number(struct lemon *lemon, char *p)
 {
+	int c;
 	int dot;
 	int oct;
 	int hex;
-	int done;
-	long offset;
-	long length;
-	char *buffer;
+	char *start;
 	struct lexer *lexer;
 
-	assert(isdigit(c) || c == '.');
-
 	dot = 0;
 	oct = 0;
 	hex = 0;
-	done = 0;
-	offset = 0;
-	length = LEMON_NAME_MAX;
-	lexer = lemon->l_lexer;
-	buffer = lemon_allocator_alloc(lemon, length);
-	if (c == '0') {
+	start = p;
+	if (*p == '0') {
 		oct = 1;
 	}
-	while (!done) {
-		switch (c) {
-		case '0':
-		case '1':
-		case '2':
-		case '3':
-		case '4':
-		case '5':
-		case '6':
-		case '7':
-			break;
-		case '8':
-		case '9':
-			if (oct) {
-				done = 1;
+	for (;; p++) {
+		c = *p;
+		if (IS_CLASS(c, LEXER_DIGIT)) {
+			if (oct && (c == '8' || c == '9')) {
+				break;
 			}
-			break;
-		case 'a':
-		case 'A':
-		case 'b':
-		case 'B':
-		case 'c':
-		case 'C':
-		case 'd':
-		case 'D':
-		case 'e':
-		case 'E':
-		case 'f':
-		case 'F':
+		} else if (IS_CLASS(c, LEXER_HEX)) {
 			if (!hex) {
-				done = 1;
+				break;
 			}
-			break;
-		case 'x':
-		case 'X':
-			if (oct && offset == 1) {
-				oct = 0;
-				hex = 1;
-			} else {
-				done = 1;
+		} else if (c == 'x' || c == 'X') {
+			if (!oct || p - start != 1) {
+				break;
 			}
-			break;
-		case '.':
+			oct = 0;
+			hex = 1;
+		} else if (c == '.') {
 			if (hex || dot) {
-				done = 1;
-			} else {
-				oct = 0;
-				dot = 1;
+				break;
 			}
+			oct = 0;
+			dot = 1;
+		} else {
 			break;
-		default:
-			done = 1;
 		}
+	}
 
-		if (done) {
-			break;
+	lexer = lemon->l_lexer;
+	lexer->lookahead = TOKEN_NUMBER;
+	lexer->length = p - start;
+	lexer->buffer = start;
+
+	/* get out of last '.', `1.foo' is attribute of number */
+	if (p[-1] == '.') {
+		lexer->length -= 1;
+		if (*p != '.') {
+			return p - 1;
 		}
+	}
 
-		buffer[offset++] = (char)c;
-		c = input_getchar(lemon);
-		if (offset == length) {
-			length += LEMON_NAME_MAX;
-			buffer = lemon_allocator_realloc(lemon, buffer, length);
-			if (!buffer) {
-				lexer->lookahead = TOKEN_ERROR;
-				return;
-			}
-		}
+	return p;
+}
+
+static int
+lexer_reserve(struct lemon *lemon, long length)
+{
+	char *text;
+	long capacity;
+	struct lexer *lexer;
+
+	lexer = lemon->l_lexer;
+	if (length <= lexer->capacity) {
+		return 1;
 	}
 
-	/* get out of last '.' */
-	if (offset && buffer[offset - 1] == '.') {
-		offset -= 1;
-		if (c != '.') {
-			input_ungetchar(lemon, c);
-		}
+	capacity = lexer->capacity * 2;
+	if (capacity < length) {
+		capacity = length + LEMON_NAME_MAX;
 	}
-	buffer[offset] = '\0';
-	input_ungetchar(lemon, c);
-	lexer->lookahead = TOKEN_NUMBER;
-	lexer->length = offset;
-	lexer->buffer = buffer;
+	text = lemon_allocator_realloc(lemon, lexer->text, capacity);
+	if (!text) {
+		return 0;
+	}
+	lexer->text = text;
+	lexer->capacity = capacity;
+
+	return 1;
 }
 
-void
-lexer_scan_string(struct lemon *lemon, int c)
+static char *
+lexer_scan_string(struct lemon *lemon, char *p)
 {
-	int single;
+	int c;
+	int quote;
 	long offset;
-	long length;
-	char *buffer;
+	char *start;
 	struct lexer *lexer;
 
 	lexer = lemon->l_lexer;
+	quote = *p++;
+	start = p;
+	while (*p != quote && *p != '\\' && *p != '\0') {
+		p++;
+	}
+
+	/* string without escape is used in place */
+	if (*p == quote) {
+		lexer->lookahead = TOKEN_STRING;
+		lexer->length = p - start;
+		lexer->buffer = start;
 
-	single = 0;
-	if (c == '\'') {
-		single = 1;
+		return p + 1;
 	}
 
-	offset = 0;
-	length = LEMON_NAME_MAX;
-	buffer = lemon_allocator_alloc(lemon, length);
-	c = input_getchar(lemon);
+	offset = p - start;
+	if (!lexer_reserve(lemon, offset + 1)) {
+		lexer->lookahead = TOKEN_ERROR;
+		return p;
+	}
+	memcpy(lexer->text, start, offset);
 	for (;;) {
+		c = *p;
 		if (c == '\0') {
-			fprintf(stderr,
-			        "%s:%ld:%ld: error: <eof> in string literal\n",
-			        input_filename(lemon),
-			        input_line(lemon) + 1,
-			        input_column(lemon) + 1);
+			lexer_error(lemon, p, "<eof> in string literal");
 			lexer->lookahead = TOKEN_ERROR;
-			lemon_allocator_free(lemon, buffer);
-			return;
+
+			return p;
 		}
 
-		if ((single && c == '\'') || (!single && c == '"')) {
+		if (c == quote) {
 			break;
 		}
 
 		if (c == '\\') {
-			c = input_getchar(lemon);
+			c = *++p;
 			switch (c) {
+			case '\0':
+				continue;
+
 			case 'n':
 				c = '\n';
 				break;
@@ -216,432 +359,299 @@ lexer_scan_string(struct lemon *lemon, int c)
 				c = '\r';
 				break;
 
-			case '\'':
-				c = '\'';
-				break;
-
-			case '"':
-				c = '"';
-				break;
-
-			case '\\':
-				c = '\\';
-				break;
-
 			default:
+				/* '\'', '"' and '\\' are itself */
 				break;
 			}
 		}
-		buffer[offset++] = (char)c;
-		if (offset == length) {
-			length += LEMON_NAME_MAX;
-			buffer = lemon_allocator_realloc(lemon, buffer, length);
+
+		if (!lexer_reserve(lemon, offset + 1)) {
+			lexer->lookahead = TOKEN_ERROR;
+			return p;
 		}
-		c = input_getchar(lemon);
+		lexer->text[offset++] = (char)c;
+		p++;
 	}
-	buffer[offset] = '\0';
-	/* because last "'" or '"' we don't need ungetchar() */
 	lexer->lookahead = TOKEN_STRING;
 	lexer->length = offset;
-	lexer->buffer = buffer;
+	lexer->buffer = lexer->text;
+
+	return p + 1;
 }
 
-void
-lexer_scan_name(struct lemon *lemon, int c)
+static char *
+lexer_scan_name(struct lemon *lemon, char *p)
 {
-	long offset;
 	long length;
-	char *buffer;
+	char *start;
+	struct input *input;
 	struct lexer *lexer;
+	const struct lexer_keyword *keyword;
 
-	assert(c == '_' || isalpha(c));
+	start = p;
+	while (IS_CLASS(*p, LEXER_ALPHA | LEXER_DIGIT)) {
+		p++;
+	}
+	length = p - start;
 
-	offset = 0;
-	length = LEMON_NAME_MAX;
 	lexer = lemon->l_lexer;
-	buffer = lemon_allocator_alloc(lemon, length);
-	while (c == '_' || isalnum(c)) {
-		buffer[offset++] = (char)c;
-		if (offset == LEMON_NAME_MAX - 1) {
-			buffer[offset] = '\0';
-
-			fprintf(stderr,
-			        "%s:%ld:%ld: error: "
-			        "name '%s...' too long,"
-			        " 255 char max\n",
-			        input_filename(lemon),
-			        input_line(lemon) + 1,
-			        input_column(lemon) + 1,
-			        lexer->buffer);
-			lexer->lookahead = TOKEN_ERROR;
-			lemon_allocator_free(lemon, buffer);
-
-			return;
-		}
-		c = input_getchar(lemon);
+	if (length >= LEMON_NAME_MAX - 1) {
+		input = lemon->l_input;
+		input->offset = start - input->buffer;
+		fprintf(stderr,
+		        "%s:%ld:%ld: error: name '%.*s...' too long,"
+		        " 255 char max\n",
+		        input_filename(lemon),
+		        input_line(lemon) + 1,
+		        input_column(lemon) + 1,
+		        LEMON_NAME_MAX - 1,
+		        start);
+		lexer->lookahead = TOKEN_ERROR;
+
+		return p;
 	}
-	buffer[offset] = '\0';
-	input_ungetchar(lemon, c);
 	lexer->lookahead = TOKEN_NAME;
-	lexer->length = offset;
-	lexer->buffer = buffer;
-}
-
-void
-lexer_scan_line_comment(struct lemon *lemon, int c)
-{
-	while (c != '\n') {
-		c = input_getchar(lemon);
+	lexer->length = length;
+	lexer->buffer = start;
+
+	if (length >= LEXER_KEYWORD_MIN && length <= LEXER_KEYWORD_MAX) {
+		keyword = &lexer_keywords[LEXER_KEYWORD_HASH(start, length)];
+		if (keyword->name &&
+		    strncmp(keyword->name, start, length) == 0 &&
+		    keyword->name[length] == '\0')
+		{
+			lexer->lookahead = keyword->token;
+		}
 	}
+
+	return p;
 }
 
-void
-lexer_scan_block_comment(struct lemon *lemon, int c)
+static char *
+lexer_scan_space(char *p)
 {
-	while (c != '\0') {
-		if (c == '*') {
-			c = input_getchar(lemon);
-			if (c == '/') {
-				return;
+	for (;;) {
+		while (IS_CLASS(*p, LEXER_SPACE)) {
+			p++;
+		}
+
+		if (*p == '#' || (p[0] == '/' && p[1] == '/')) {
+			while (*p != '\n' && *p != '\0') {
+				p++;
+			}
+		} else if (p[0] == '/' && p[1] == '*') {
+			p += 2;
+			while (*p != '\0' && (p[0] != '*' || p[1] != '/')) {
+				p++;
+			}
+			if (*p != '\0') {
+				p += 2;
 			}
 		} else {
-			c = input_getchar(lemon);
+			return p;
 		}
 	}
-
-	input_ungetchar(lemon, c);
 }
 
-int
-lexer_is_keyword(struct lemon *lemon, char *keyword)
-{
-	struct lexer *lexer;
-
-	lexer = lemon->l_lexer;
-	return (strncmp(lexer->buffer, keyword, LEMON_NAME_MAX) == 0);
-}
-
-void
-lexer_scan_keyword(struct lemon *lemon, int c)
-{
-	struct lexer *lexer;
-
-	lexer_scan_name(lemon, c);
-
-	lexer = lemon->l_lexer;
-	if (lexer->lookahead != TOKEN_NAME) {
-		return;
-	}
-
-	if (lexer_is_keyword(lemon, "if")) {
-		lexer->lookahead = TOKEN_IF;
-	} else if (lexer_is_keyword(lemon, "else")) {
-		lexer->lookahead = TOKEN_ELSE;
-	} else if (lexer_is_keyword(lemon, "for")) {
-		lexer->lookahead = TOKEN_FOR;
-	} else if (lexer_is_keyword(lemon, "in")) {
-		lexer->lookahead = TOKEN_IN;
-	} else if (lexer_is_keyword(lemon, "while")) {
-		lexer->lookahead = TOKEN_WHILE;
-	} else if (lexer_is_keyword(lemon, "break")) {
-		lexer->lookahead = TOKEN_BREAK;
-	} else if (lexer_is_keyword(lemon, "continue")) {
-		lexer->lookahead = TOKEN_CONTINUE;
-	} else if (lexer_is_keyword(lemon, "delete")) {
-		lexer->lookahead = TOKEN_DELETE;
-	} else if (lexer_is_keyword(lemon, "return")) {
-		lexer->lookahead = TOKEN_RETURN;
-	} else if (lexer_is_keyword(lemon, "import")) {
-		lexer->lookahead = TOKEN_IMPORT;
-	} else if (lexer_is_keyword(lemon, "as")) {
-		lexer->lookahead = TOKEN_AS;
-	} else if (lexer_is_keyword(lemon, "def")) {
-		lexer->lookahead = TOKEN_DEFINE;
-	} else if (lexer_is_keyword(lemon, "define")) {
-		lexer->lookahead = TOKEN_DEFINE;
-	} else if (lexer_is_keyword(lemon, "function")) {
-		lexer->lookahead = TOKEN_DEFINE;
-	} else if (lexer_is_keyword(lemon, "var")) {
-		lexer->lookahead = TOKEN_VAR;
-	} else if (lexer_is_keyword(lemon, "try")) {
-		lexer->lookahead = TOKEN_TRY;
-	} else if (lexer_is_keyword(lemon, "catch")) {
-		lexer->lookahead = TOKEN_CATCH;
-	} else if (lexer_is_keyword(lemon, "finally")) {
-		lexer->lookahead = TOKEN_FINALLY;
-	} else if (lexer_is_keyword(lemon, "throw")) {
-		lexer->lookahead = TOKEN_THROW;
-	} else if (lexer_is_keyword(lemon, "nil")) {
-		lexer->lookahead = TOKEN_NIL;
-	} else if (lexer_is_keyword(lemon, "true")) {
-		lexer->lookahead = TOKEN_TRUE;
-	} else if (lexer_is_keyword(lemon, "false")) {
-		lexer->lookahead = TOKEN_FALSE;
-	} else if (lexer_is_keyword(lemon, "sentinel")) {
-		lexer->lookahead = TOKEN_SENTINEL;
-	} else if (lexer_is_keyword(lemon, "class")) {
-		lexer->lookahead = TOKEN_CLASS;
-	} else if (lexer_is_keyword(lemon, "self")) {
-		lexer->lookahead = TOKEN_SELF;
-	} else if (lexer_is_keyword(lemon, "this")) {
-		lexer->lookahead = TOKEN_SELF;
-	} else if (lexer_is_keyword(lemon, "super")) {
-		lexer->lookahead = TOKEN_SUPER;
-	} else if (lexer_is_keyword(lemon, "getter")) {
-		lexer->lookahead = TOKEN_ACCESSOR_GETTER;
-	} else if (lexer_is_keyword(lemon, "setter")) {
-		lexer->lookahead = TOKEN_ACCESSOR_SETTER;
-	} else {
-		lexer->lookahead = TOKEN_NAME;
-	}
-}
+/*
+ * `token' if next char is `c' else `other'
+ */
+#define LEXER_EITHER(c, token, other) do { \
+	if (p[1] == (c)) {                 \
+		lexer->lookahead = (token); \
+		p += 2;                    \
+	} else {                           \
+		lexer->lookahead = (other); \
+		p += 1;                    \
+	}                                  \
+} while (0)
 
 int
 lexer_next_token(struct lemon *lemon)
 {
-	int c;
+	char *p;
+	struct input *input;
 	struct lexer *lexer;
 
-	c = input_getchar(lemon);
-	while (isspace(c)) {
-		c = input_getchar(lemon);
-	}
+	input = lemon->l_input;
 	lexer = lemon->l_lexer;
-	lemon_allocator_free(lemon, lexer->buffer);
 	lexer->length = 0;
 	lexer->buffer = NULL;
+	if (!input->offset) {
+		lexer->depth = 0;
+	}
 
-	if (c == '_' || isalpha(c)) {
-		lexer_scan_keyword(lemon, c);
-	} else if (isdigit(c)) {
-		lexer_scan_number(lemon, c);
+	p = lexer_scan_space(input->buffer + input->offset);
+	lexer->offset = p - input->buffer;
+	if (IS_CLASS(*p, LEXER_ALPHA)) {
+		p = lexer_scan_name(lemon, p);
+	} else if (IS_CLASS(*p, LEXER_DIGIT) ||
+	           (p[0] == '.' && IS_CLASS(p[1], LEXER_DIGIT)))
+	{
+		p = lexer_scan_number(lemon, p);
 	} else {
-		switch (c) {
+		switch (*p) {
 		case '\0':
 			lexer->lookahead = TOKEN_EOF;
 			break;
 
-		case '#':
-			lexer_scan_line_comment(lemon, c);
-			return lexer_next_token(lemon);
-
 		case '\'':
 			/* FALLTHROUGH */
 		case '"':
-			lexer_scan_string(lemon, c);
+			p = lexer_scan_string(lemon, p);
 			break;
 
 		case '.':
-			c = input_getchar(lemon);
-			if (isdigit(c)) {
-				input_ungetchar(lemon, c);
-				lexer_scan_number(lemon, '.');
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_DOT;
-			}
+			lexer->lookahead = TOKEN_DOT;
+			p += 1;
 			break;
 
 		case ',':
 			lexer->lookahead = TOKEN_COMMA;
+			p += 1;
 			break;
 
 		case ';':
 			lexer->lookahead = TOKEN_SEMICON;
+			p += 1;
 			break;
 
 		case '(':
 			lexer->lookahead = TOKEN_LPAREN;
+			p += 1;
 			break;
 
 		case ')':
 			lexer->lookahead = TOKEN_RPAREN;
+			p += 1;
 			break;
 
 		case '[':
 			lexer->lookahead = TOKEN_LBRACK;
+			p += 1;
 			break;
 
 		case ']':
 			lexer->lookahead = TOKEN_RBRACK;
+			p += 1;
 			break;
 
 		case '{':
 			lexer->lookahead = TOKEN_LBRACE;
+			lexer->depth += 1;
+			p += 1;
 			break;
 
 		case '}':
 			lexer->lookahead = TOKEN_RBRACE;
+			lexer->depth -= 1;
+			p += 1;
 			break;
 
 		case '+':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_ADD_ASSIGN;
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_ADD;
-			}
+			LEXER_EITHER('=', TOKEN_ADD_ASSIGN, TOKEN_ADD);
 			break;
 
 		case '-':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_SUB_ASSIGN;
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_SUB;
-			}
+			LEXER_EITHER('=', TOKEN_SUB_ASSIGN, TOKEN_SUB);
 			break;
 
 		case '*':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_MUL_ASSIGN;
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_MUL;
-			}
+			LEXER_EITHER('=', TOKEN_MUL_ASSIGN, TOKEN_MUL);
 			break;
 
 		case '/':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_DIV_ASSIGN;
-			} else if (c == '/') {
-				lexer_scan_line_comment(lemon, c);
-				return lexer_next_token(lemon);
-			} else if (c == '*') {
-				lexer_scan_block_comment(lemon, c);
-				return lexer_next_token(lemon);
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_DIV;
-			}
+			/* comment is skipped by `lexer_scan_space' */
+			LEXER_EITHER('=', TOKEN_DIV_ASSIGN, TOKEN_DIV);
 			break;
 
 		case '%':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_MOD_ASSIGN;
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_MOD;
-			}
+			LEXER_EITHER('=', TOKEN_MOD_ASSIGN, TOKEN_MOD);
 			break;
 
 		case '=':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_EQ;
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_ASSIGN;
-			}
+			LEXER_EITHER('=', TOKEN_EQ, TOKEN_ASSIGN);
 			break;
 
 		case '@':
 			lexer->lookahead = TOKEN_ACCESSOR;
+			p += 1;
 			break;
 
 		case '!':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_NE;
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_LOGICAL_NOT;
-			}
+			LEXER_EITHER('=', TOKEN_NE, TOKEN_LOGICAL_NOT);
 			break;
 
 		case '>':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_GE;
-			} else if (c == '>') {
-				c = input_getchar(lemon);
-				if (c == '=') {
-					lexer->lookahead = TOKEN_SHR_ASSIGN;
-				} else {
-					input_ungetchar(lemon, c);
-					lexer->lookahead = TOKEN_SHR;
-				}
+			if (p[1] == '>') {
+				p += 1;
+				LEXER_EITHER('=', TOKEN_SHR_ASSIGN, TOKEN_SHR);
 			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_GT;
+				LEXER_EITHER('=', TOKEN_GE, TOKEN_GT);
 			}
 			break;
 
 		case '<':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_LE;
-			} else if (c == '<') {
-				c = input_getchar(lemon);
-				if (c == '=') {
-					lexer->lookahead = TOKEN_SHL_ASSIGN;
-				} else {
-					input_ungetchar(lemon, c);
-					lexer->lookahead = TOKEN_SHL;
-				}
+			if (p[1] == '<') {
+				p += 1;
+				LEXER_EITHER('=', TOKEN_SHL_ASSIGN, TOKEN_SHL);
 			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_LT;
+				LEXER_EITHER('=', TOKEN_LE, TOKEN_LT);
 			}
 			break;
 
 		case '&':
-			c = input_getchar(lemon);
-			if (c == '&') {
+			if (p[1] == '&') {
 				lexer->lookahead = TOKEN_LOGICAL_AND;
-			} else if (c == '=') {
-				lexer->lookahead = TOKEN_BITWISE_AND_ASSIGN;
+				p += 2;
 			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_BITWISE_AND;
+				LEXER_EITHER('=',
+				             TOKEN_BITWISE_AND_ASSIGN,
+				             TOKEN_BITWISE_AND);
 			}
 			break;
 
 		case '^':
-			c = input_getchar(lemon);
-			if (c == '=') {
-				lexer->lookahead = TOKEN_BITWISE_XOR_ASSIGN;
-			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_BITWISE_XOR;
-			}
+			LEXER_EITHER('=',
+			             TOKEN_BITWISE_XOR_ASSIGN,
+			             TOKEN_BITWISE_XOR);
 			break;
 
 		case '|':
-			c = input_getchar(lemon);
-			if (c == '|') {
+			if (p[1] == '|') {
 				lexer->lookahead = TOKEN_LOGICAL_OR;
-			} else if (c == '=') {
-				lexer->lookahead = TOKEN_BITWISE_OR_ASSIGN;
+				p += 2;
 			} else {
-				input_ungetchar(lemon, c);
-				lexer->lookahead = TOKEN_BITWISE_OR;
+				LEXER_EITHER('=',
+				             TOKEN_BITWISE_OR_ASSIGN,
+				             TOKEN_BITWISE_OR);
 			}
 			break;
 
 		case '~':
 			lexer->lookahead = TOKEN_BITWISE_NOT;
+			p += 1;
 			break;
 
 		case '?':
 			lexer->lookahead = TOKEN_CONDITIONAL;
+			p += 1;
 			break;
 
 		case ':':
 			lexer->lookahead = TOKEN_COLON;
+			p += 1;
 			break;
 
 		default:
-			fprintf(stderr, "unknown token\n");
+			lexer_error(lemon, p, "unknown token");
 			lexer->lookahead = TOKEN_ERROR;
+			input->offset = p - input->buffer;
+
 			return 0;
 		}
 	}
+	input->offset = p - input->buffer;
 
 	return 1;
 }
@@ -5,9 +5,18 @@ struct lemon;
 
 struct lexer {
 	int lookahead;
+	int depth;   /* '{' nesting after lookahead, reset at buffer begin */
+	long offset; /* lookahead's offset in input buffer */
 
+	/*
+	 * name, number and string's text value, not '\0' terminated,
+	 * point into input buffer or `text' if string has escape
+	 */
 	long length;
-	char *buffer; /* name, number and string's text value */
+	char *buffer;
+
+	long capacity;
+	char *text;
 };
 
 struct lexer *
@@ -25,6 +34,12 @@ lexer_get_buffer(struct lemon *lemon);
 int
 lexer_get_token(struct lemon *lemon);
 
+int
+lexer_get_depth(struct lemon *lemon);
+
+long
+lexer_get_offset(struct lemon *lemon);
+
 int
 lexer_next_token(struct lemon *lemon);
 
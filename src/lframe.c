@@ -69,6 +69,10 @@ lframe_mark(struct lemon *lemon, struct lframe *self)
 		lobject_mark(lemon, self->self);
 	}
 
+	if (self->code) {
+		lobject_mark(lemon, self->code);
+	}
+
 	if (self->callee) {
 		lobject_mark(lemon, self->callee);
 	}
@@ -21,8 +21,10 @@ struct lframe {
 	int sp; /* previous operand sp       */
 	int ea; /* exception handler address */
 	int nlocals;
+	int captured; /* referenced by closure or continuation */
 
 	struct lobject *self;
+	struct lobject *code; /* code object of return address */
 	struct lobject *callee;
 	lframe_call_t callback; /* call this function after frame is poped */
 	                        /* also auto return if callback is not NULL */
@@ -3,6 +3,7 @@
 #include "linteger.h"
 
 #include <stdio.h>
+#include <assert.h>
 #include <string.h>
 
 static struct lobject *
@@ -30,6 +31,14 @@ lfunction_mark(struct lemon *lemon, struct lfunction *self)
 		lobject_mark(lemon, self->self);
 	}
 
+	if (self->code) {
+		lobject_mark(lemon, self->code);
+	}
+
+	if (self->lazy) {
+		lobject_mark(lemon, self->lazy);
+	}
+
 	/* C function doesn't have frame */
 	if (self->frame) {
 		lobject_mark(lemon, (struct lobject *)self->frame);
@@ -45,13 +54,27 @@ lfunction_mark(struct lemon *lemon, struct lfunction *self)
 static struct lobject *
 lfunction_call(struct lemon *lemon,
                struct lfunction *self,
-               int argc, struct lobject *argv[])
+               int argc, struct lobject *argv[],
+               struct lobject *keywords)
 {
 	struct lframe *frame;
 	struct lobject *retval;
 	struct lobject *exception;
 
+	retval = lemon_machine_check_recursion(lemon);
+	if (retval) {
+		return retval;
+	}
+
 	retval = lemon->l_nil;
+	if (self->lazy && !self->address) {
+		if (!lemon_compile_lazy(lemon, self)) {
+			return lobject_error_runtime(lemon,
+			                             "compile '%@' fail",
+			                             self->name);
+		}
+	}
+
 	if (self->address > 0) {
 		frame = lemon_machine_push_new_frame(lemon,
 		                                     self->self,
@@ -63,19 +86,21 @@ lfunction_call(struct lemon *lemon,
 		}
 		frame->upframe = self->frame;
 
-		exception = lemon_machine_parse_args(lemon,
-		                                     (struct lobject *)self,
-		                                     frame,
-		                                     self->define,
-		                                     self->nvalues,
-		                                     self->nparams,
-		                                     self->params,
-		                                     argc,
-		                                     argv);
+		exception = lemon_machine_parse_kargs(lemon,
+		                                      (struct lobject *)self,
+		                                      frame,
+		                                      self->define,
+		                                      self->nvalues,
+		                                      self->nparams,
+		                                      self->params,
+		                                      argc,
+		                                      argv,
+		                                      keywords);
 
 		if (exception) {
 			return exception;
 		}
+		lemon_machine_set_code(lemon, self->code);
 		lemon_machine_set_pc(lemon, self->address);
 	} else {
 		frame = lemon_machine_push_new_frame(lemon,
@@ -101,7 +126,7 @@ lfunction_method(struct lemon *lemon,
 
 	switch (method) {
 	case LOBJECT_METHOD_CALL:
-		return lfunction_call(lemon, cast(self), argc, argv);
+		return lfunction_call(lemon, cast(self), argc, argv, NULL);
 
 	case LOBJECT_METHOD_CALLABLE:
 		return lemon->l_true;
@@ -138,6 +163,22 @@ lfunction_create(struct lemon *lemon,
 	return function;
 }
 
+void *
+lfunction_create_framed(struct lemon *lemon,
+                        struct lobject *name,
+                        struct lobject *self,
+                        lfunction_call_t callback)
+{
+	struct lfunction *function;
+
+	function = lfunction_create(lemon, name, self, callback);
+	if (function) {
+		function->framed = 1;
+	}
+
+	return function;
+}
+
 void *
 lfunction_create_with_address(struct lemon *lemon,
                               struct lobject *name,
@@ -170,6 +211,20 @@ lfunction_create_with_address(struct lemon *lemon,
 	return self;
 }
 
+struct lobject *
+lfunction_call_keyword(struct lemon *lemon,
+                       struct lobject *function,
+                       int argc, struct lobject *argv[],
+                       struct lobject *keywords)
+{
+	struct lfunction *self;
+
+	self = (struct lfunction *)function;
+	assert(!self->callback);
+
+	return lfunction_call(lemon, self, argc, argv, keywords);
+}
+
 void *
 lfunction_bind(struct lemon *lemon,
                struct lobject *function,
@@ -184,6 +239,9 @@ lfunction_bind(struct lemon *lemon,
 		                               oldfunction->name,
 		                               self,
 		                               oldfunction->callback);
+		if (newfunction) {
+			newfunction->framed = oldfunction->framed;
+		}
 		return newfunction;
 	}
 
@@ -197,6 +255,8 @@ lfunction_bind(struct lemon *lemon,
 						    oldfunction->params);
 	if (newfunction) {
 		newfunction->self = self;
+		newfunction->code = oldfunction->code;
+		newfunction->lazy = oldfunction->lazy;
 		newfunction->frame = oldfunction->frame;
 	}
 
@@ -37,16 +37,34 @@ struct lfunction {
 	unsigned char nvalues; /* number of parameters has default values */
 	                       /* always nlocals >= nparams >= nvalues */
 
-	int address; /* bytecode entry address */
+	/*
+	 * C function is called without frame by `call' opcode, `framed'
+	 * function always has own frame (operate caller's frame, `yield')
+	 */
+	unsigned char framed;
+
+	int address; /* bytecode entry address, offset in `code' */
 
 	struct lframe *frame;
+	struct lobject *code; /* code object of body */
 	struct lobject *name;
 	struct lobject *self;
+	struct lobject *lazy; /* record of uncompiled body, see compiler_lazy */
 	lfunction_call_t callback; /* C function pointer */
 
 	struct lobject *params[1]; /* parameters name reverse order */
 };
 
+/*
+ * call Lemon function (not C function) from `callkw',
+ * last items of `argv' are keyword values named by array `keywords'
+ */
+struct lobject *
+lfunction_call_keyword(struct lemon *lemon,
+                       struct lobject *function,
+                       int argc, struct lobject *argv[],
+                       struct lobject *keywords);
+
 void *
 lfunction_bind(struct lemon *lemon,
                struct lobject *function,
@@ -58,6 +76,15 @@ lfunction_create(struct lemon *lemon,
                  struct lobject *self,
                  lfunction_call_t callback);
 
+/*
+ * C function always called with own frame
+ */
+void *
+lfunction_create_framed(struct lemon *lemon,
+                        struct lobject *name,
+                        struct lobject *self,
+                        lfunction_call_t callback);
+
 void *
 lfunction_create_with_address(struct lemon *lemon,
                               struct lobject *name,
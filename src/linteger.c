@@ -3,6 +3,7 @@
 #include "lstring.h"
 #include "linteger.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <limits.h>
 #include <assert.h>
@@ -12,6 +13,19 @@
 #define SMALLINT_MAX (long)(ULONG_MAX >> 2)
 #define SMALLINT_MIN (long)(-SMALLINT_MAX)
 
+/* digits to hold any long */
+#define LINTEGER_LONG_DIGITS (sizeof(long) * CHAR_BIT / EXTEND_BITS + 1)
+
+/*
+ * stack storage of small integer operand, same layout as heap linteger
+ * allocated with LINTEGER_LONG_DIGITS digits
+ */
+union linteger_buffer {
+	struct linteger integer;
+	char buffer[sizeof(struct linteger) +
+	            LINTEGER_LONG_DIGITS * sizeof(extend_t)];
+};
+
 void *
 linteger_create(struct lemon *lemon, int digits);
 
@@ -27,16 +41,178 @@ normalize(struct lemon *lemon, struct linteger *a)
 {
 	a->ndigits = extend_length(a->length, a->digits);;
 
-	if (a->ndigits == 0) {
+	if (a->ndigits == 0 || (a->ndigits == 1 && a->digits[0] == 0)) {
 		a->sign = 1;
 	}
 }
 
+/*
+ * big integer of `a', small integer is unpacked into `buffer' without
+ * allocation, the result must not outlive `buffer'
+ */
+static struct linteger *
+linteger_load(struct lemon *lemon,
+              struct lobject *a,
+              union linteger_buffer *buffer)
+{
+	long value;
+	struct linteger *integer;
+
+	if (lobject_is_pointer(lemon, a)) {
+		return (struct linteger *)a;
+	}
+
+	integer = &buffer->integer;
+	memset(buffer, 0, sizeof(*buffer));
+	integer->sign = 1;
+	integer->length = LINTEGER_LONG_DIGITS;
+	value = linteger_to_long(lemon, a);
+	if (value < 0) {
+		integer->sign = 0;
+		value = -value;
+	}
+	extend_from_long(integer->length, integer->digits, value);
+	normalize(lemon, integer);
+
+	return integer;
+}
+
+/*
+ * `ndigits' digits temporary shared by all operations, valid until next
+ * call, don't call other integer operation while using it
+ */
+static extend_t *
+linteger_scratch(struct lemon *lemon, long ndigits)
+{
+	long size;
+
+	size = ndigits * (long)sizeof(extend_t);
+	if (lemon->l_scratch_size < size) {
+		if (size < lemon->l_scratch_size * 2) {
+			size = lemon->l_scratch_size * 2;
+		}
+		lemon_allocator_free(lemon, lemon->l_scratch);
+		lemon->l_scratch = lemon_allocator_alloc(lemon, size);
+		if (!lemon->l_scratch) {
+			lemon->l_scratch_size = 0;
+			return NULL;
+		}
+		lemon->l_scratch_size = size;
+	}
+
+	return lemon->l_scratch;
+}
+
+/*
+ * count of significant bits of |a|
+ */
+static long
+linteger_bit_length(struct linteger *a)
+{
+	long n;
+	extend_t top;
+
+	n = (long)(a->ndigits - 1) * EXTEND_BITS;
+	for (top = a->digits[a->ndigits - 1]; top; top >>= 1) {
+		n += 1;
+	}
+
+	return n;
+}
+
+/*
+ * big integer result fit in small integer is demoted
+ */
+static struct lobject *
+linteger_demote(struct lemon *lemon, struct lobject *a)
+{
+	unsigned long value;
+	struct linteger *integer;
+
+	if (!a || !lobject_is_pointer(lemon, a) ||
+	    !lobject_is_integer(lemon, a))
+	{
+		return a;
+	}
+
+	integer = (struct linteger *)a;
+	if (linteger_bit_length(integer) > (long)sizeof(long) * CHAR_BIT - 2) {
+		return a;
+	}
+	value = extend_to_long(integer->ndigits, integer->digits);
+	if (value >= (unsigned long)SMALLINT_MAX) {
+		return a;
+	}
+
+	if (integer->sign) {
+		return linteger_create_from_long(lemon, (long)value);
+	}
+	return linteger_create_from_long(lemon, -(long)value);
+}
+
+/*
+ * box `n' digits result `z' computed in scratch, if `small' result fit
+ * in small integer is not allocated, else copy to new big integer.
+ * algorithms on big integer (radix, reciprocal) require big result.
+ */
+static struct lobject *
+linteger_box(struct lemon *lemon, int sign, int n, extend_t *z, int small)
+{
+	long bits;
+	extend_t top;
+	unsigned long value;
+	struct linteger *self;
+
+	n = extend_length(n, z);
+	bits = (long)(n - 1) * EXTEND_BITS;
+	for (top = z[n - 1]; top; top >>= 1) {
+		bits += 1;
+	}
+	if (small && bits <= (long)sizeof(long) * CHAR_BIT - 2) {
+		value = extend_to_long(n, z);
+		if (value < (unsigned long)SMALLINT_MAX) {
+			if (sign) {
+				return linteger_create_from_long(lemon,
+				                                 (long)value);
+			}
+			return linteger_create_from_long(lemon, -(long)value);
+		}
+	}
+
+	self = linteger_create(lemon, n);
+	if (self) {
+		memcpy(self->digits, z, sizeof(extend_t) * n);
+		self->sign = sign;
+		normalize(lemon, self);
+	}
+
+	return (struct lobject *)self;
+}
+
+/*
+ * compare magnitude of two big integers
+ */
+static int
+linteger_cmp_digits(struct linteger *ia, struct linteger *ib)
+{
+	if (ia->ndigits > ib->ndigits) {
+		return 1;
+	}
+
+	if (ia->ndigits < ib->ndigits) {
+		return -1;
+	}
+
+	return extend_cmp(ia->ndigits, ia->digits, ib->digits);
+}
+
 int
 linteger_cmp(struct lemon *lemon, struct lobject *a, struct lobject *b)
 {
 	struct linteger *ia;
 	struct linteger *ib;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -56,10 +232,8 @@ linteger_cmp(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return 0;
 	}
 
-	assert(lobject_is_pointer(lemon, a) && lobject_is_pointer(lemon, b));
-
-	ia = (struct linteger *)a;
-	ib = (struct linteger *)b;
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
 	if (ia->sign == 1 && ib->sign == 0) {
 		return 1;
@@ -69,34 +243,30 @@ linteger_cmp(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return -1;
 	}
 
-	if (ia->ndigits > ib->ndigits) {
-		return 1;
-	}
-
-	if (ia->ndigits < ib->ndigits) {
-		return -1;
-	}
-
 	if (ia->sign) {
-		return extend_cmp(ia->ndigits, ia->digits, ib->digits);
-	} else {
-		return extend_cmp(ia->ndigits, ib->digits, ia->digits);
+		return linteger_cmp_digits(ia, ib);
 	}
 
-	return 0;
+	return linteger_cmp_digits(ib, ia);
 }
 
 /*
  * CERT Coding Standard INT32-C Integer Overflow Check Algorithms
  */
 static struct lobject *
-linteger_add(struct lemon *lemon, struct lobject *a, struct lobject *b)
+linteger_add(struct lemon *lemon,
+             struct lobject *a,
+             struct lobject *b,
+             int small)
 {
+	int sign;
 	int ndigits;
+	extend_t *z;
 	struct linteger *ia;
 	struct linteger *ib;
-	struct linteger *ic;
 	unsigned long carry;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -114,67 +284,66 @@ linteger_add(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return linteger_create_from_long(lemon, la + lb);
 	}
 promot:
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
+	/* result is computed in scratch, allocated only if not small */
+	if (ia->ndigits > ib->ndigits) {
+		ndigits = ia->ndigits + 1;
+	} else {
+		ndigits = ib->ndigits + 1;
+	}
+	z = linteger_scratch(lemon, ndigits);
+	if (!z) {
 		return NULL;
 	}
 
 	if (ia->sign == ib->sign) {
-		if (ia->ndigits > ib->ndigits) {
-			ndigits = ia->ndigits + 1;
-		} else {
-			ndigits = ib->ndigits + 1;
-		}
-		ic = linteger_create(lemon, ndigits);
-
-		carry = extend_add(ic->digits,
+		carry = extend_add(z,
 		                   ia->ndigits,
 		                   ia->digits,
 		                   ib->ndigits,
 		                   ib->digits,
 		                   0);
-		ic->digits[ic->length - 1] = (extend_t)(carry % EXTEND_BASE);
-		ic->sign = ia->sign;
-	} else if (linteger_cmp(lemon,
-	                        (struct lobject *)ia,
-	                        (struct lobject *)ib) > 0)
-	{
-		ic = linteger_create(lemon, ia->ndigits);
-		extend_sub(ic->digits,
+		z[ndigits - 1] = (extend_t)(carry % EXTEND_BASE);
+		sign = ia->sign;
+	} else if (linteger_cmp_digits(ia, ib) > 0) {
+		ndigits = ia->ndigits;
+		extend_sub(z,
 		           ia->ndigits,
 		           ia->digits,
 		           ib->ndigits,
 		           ib->digits,
 		           0);
-		ic->sign = ia->sign;
+		sign = ia->sign;
 	} else {
-		ic = linteger_create(lemon, ib->ndigits);
-		extend_sub(ic->digits,
+		ndigits = ib->ndigits;
+		extend_sub(z,
 		           ib->ndigits,
 		           ib->digits,
 		           ia->ndigits,
 		           ia->digits,
 		           0);
-		ic->sign = ib->sign;
+		sign = ib->sign;
 	}
 
-	normalize(lemon, ic);
-	return (struct lobject *)ic;
+	return linteger_box(lemon, sign, ndigits, z, small);
 }
 
 static struct lobject *
-linteger_sub(struct lemon *lemon, struct lobject *a, struct lobject *b)
+linteger_sub(struct lemon *lemon,
+             struct lobject *a,
+             struct lobject *b,
+             int small)
 {
+	int sign;
 	int ndigits;
+	extend_t *z;
 	struct linteger *ia;
 	struct linteger *ib;
-	struct linteger *ic;
 	unsigned long carry;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -193,65 +362,64 @@ linteger_sub(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	}
 
 promot:
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
+	if (ia->ndigits > ib->ndigits) {
+		ndigits = ia->ndigits + 1;
+	} else {
+		ndigits = ib->ndigits + 1;
+	}
+	z = linteger_scratch(lemon, ndigits);
+	if (!z) {
 		return NULL;
 	}
 
 	if (ia->sign != ib->sign) {
-		if (ia->ndigits > ib->ndigits) {
-			ndigits = ia->ndigits + 1;
-		} else {
-			ndigits = ib->ndigits + 1;
-		}
-		ic = linteger_create(lemon, ndigits);
-
-		carry = extend_add(ic->digits,
+		carry = extend_add(z,
 		                   ia->ndigits,
 		                   ia->digits,
 		                   ib->ndigits,
 		                   ib->digits,
 		                   0);
-		ic->digits[ic->length - 1] = (extend_t)(carry & EXTEND_BASE);
-		ic->sign = ia->sign;
-	} else if (linteger_cmp(lemon,
-	                        (struct lobject *)ia,
-	                        (struct lobject *)ib) > 0)
-	{
-		ic = linteger_create(lemon, ia->ndigits);
-		extend_sub(ic->digits,
+		z[ndigits - 1] = (extend_t)(carry % EXTEND_BASE);
+		sign = ia->sign;
+	} else if (linteger_cmp_digits(ia, ib) > 0) {
+		ndigits = ia->ndigits;
+		extend_sub(z,
 		           ia->ndigits,
 		           ia->digits,
 		           ib->ndigits,
 		           ib->digits,
 		           0);
-		ic->sign = ia->sign;
+		sign = ia->sign;
 	} else {
-		ic = linteger_create(lemon, ib->ndigits);
-		extend_sub(ic->digits,
+		ndigits = ib->ndigits;
+		extend_sub(z,
 		           ib->ndigits,
 		           ib->digits,
 		           ia->ndigits,
 		           ia->digits,
 		           0);
-		ic->sign = -ib->sign;
+		sign = !ib->sign;
 	}
 
-	normalize(lemon, ic);
-	return (struct lobject *)ic;
+	return linteger_box(lemon, sign, ndigits, z, small);
 }
 
 static struct lobject *
-linteger_mul(struct lemon *lemon, struct lobject *a, struct lobject *b)
+linteger_mul(struct lemon *lemon,
+             struct lobject *a,
+             struct lobject *b,
+             int small)
 {
+	int ndigits;
+	extend_t *z;
+	extend_t *tmp;
 	struct linteger *ia;
 	struct linteger *ib;
-	struct linteger *ic;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -286,36 +454,43 @@ linteger_mul(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	}
 
 promot:
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
+
+	/*
+	 * product and work space of Karatsuba and Toom-3 are scratch,
+	 * product is allocated only if not small
+	 */
+	ndigits = ia->ndigits + ib->ndigits;
+	z = linteger_scratch(lemon,
+	                     ndigits + extend_mul_tmp(ia->ndigits,
+	                                              ib->ndigits));
+	if (!z) {
 		return NULL;
 	}
-
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
-		return NULL;
+	tmp = NULL;
+	if (extend_mul_tmp(ia->ndigits, ib->ndigits)) {
+		tmp = z + ndigits;
 	}
-
-	ic = linteger_create(lemon, ia->ndigits + ib->ndigits);
-	extend_mul(ic->digits,
+	extend_mul(z,
 	           ia->ndigits,
 	           ia->digits,
 	           ib->ndigits,
-	           ib->digits);
-	ic->sign = ia->sign == ib->sign ? 1 : -1;
+	           ib->digits,
+	           tmp);
 
-	normalize(lemon, ic);
-	return (struct lobject *)ic;
+	return linteger_box(lemon, ia->sign == ib->sign, ndigits, z, small);
 }
 
 static struct lobject *
 linteger_div(struct lemon *lemon, struct lobject *a, struct lobject *b)
 {
+	extend_t *tmp;
 	struct linteger *ia;
 	struct linteger *ib;
 	struct linteger *ic;
-	struct linteger *id;
-	struct linteger *ie;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -339,26 +514,16 @@ linteger_div(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	}
 
 promot:
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
-
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
+	/* quotient is result, remainder and extend_div tmp are scratch */
 	ic = linteger_create(lemon, ia->ndigits);
 	if (!ic) {
 		return NULL;
 	}
-	id = linteger_create(lemon, ib->ndigits);
-	if (!id) {
-		return NULL;
-	}
-	ie = linteger_create(lemon, ia->ndigits + ib->ndigits + 2);
-	if (!ie) {
+	tmp = linteger_scratch(lemon, ia->ndigits + 3 * ib->ndigits + 2);
+	if (!tmp) {
 		return NULL;
 	}
 	extend_div(ic->digits,
@@ -366,9 +531,9 @@ promot:
 	           ia->digits,
 	           ib->ndigits,
 	           ib->digits,
-	           id->digits,
-	           ie->digits);
-	ic->sign = ia->sign == ib->sign ? 1 : -1;
+	           tmp,
+	           tmp + ib->ndigits);
+	ic->sign = ia->sign == ib->sign;
 
 	normalize(lemon, ic);
 	return (struct lobject *)ic;
@@ -377,11 +542,12 @@ promot:
 static struct lobject *
 linteger_mod(struct lemon *lemon, struct lobject *a, struct lobject *b)
 {
+	extend_t *tmp;
 	struct linteger *ia;
 	struct linteger *ib;
 	struct linteger *ic;
-	struct linteger *id;
-	struct linteger *ie;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -404,39 +570,29 @@ linteger_mod(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return linteger_create_from_long(lemon, la % lb);
 	}
 promot:
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
-
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
-	ic = linteger_create(lemon, ia->ndigits);
+	/* remainder is result, quotient and extend_div tmp are scratch */
+	ic = linteger_create(lemon, ib->ndigits);
 	if (!ic) {
 		return NULL;
 	}
-	id = linteger_create(lemon, ib->ndigits);
-	if (!id) {
-		return NULL;
-	}
-	ie = linteger_create(lemon, ia->ndigits + ib->ndigits + 2);
-	if (!ie) {
+	tmp = linteger_scratch(lemon, 2 * ia->ndigits + 2 * ib->ndigits + 2);
+	if (!tmp) {
 		return NULL;
 	}
-	extend_div(ic->digits,
+	extend_div(tmp,
 	           ia->ndigits,
 	           ia->digits,
 	           ib->ndigits,
 	           ib->digits,
-	           id->digits,
-	           ie->digits);
-	ic->sign = ia->sign == ib->sign ? 1 : -1;
+	           ic->digits,
+	           tmp + ia->ndigits);
+	ic->sign = ia->sign;
 
 	normalize(lemon, ic);
-	return (struct lobject *)id;
+	return (struct lobject *)ic;
 }
 
 static struct lobject *
@@ -472,6 +628,7 @@ linteger_shl(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	int ndigits;
 	struct linteger *ia;
 	struct linteger *ic;
+	union linteger_buffer ba;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -494,13 +651,10 @@ linteger_shl(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return linteger_create_from_long(lemon, la << lb);
 	}
 promot:
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
 
-	s = (linteger_to_long(lemon, b) + EXTEND_BITS-1) & ~(EXTEND_BITS-1);
-	ndigits = ia->ndigits + (int)s / EXTEND_BITS;
+	s = linteger_to_long(lemon, b);
+	ndigits = ia->ndigits + (int)s / EXTEND_BITS + 1;
 	ic = linteger_create(lemon, ndigits);
 	if (!ic) {
 		return NULL;
@@ -518,6 +672,7 @@ linteger_shr(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	int s;
 	struct linteger *ia;
 	struct linteger *ic;
+	union linteger_buffer ba;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -533,17 +688,18 @@ linteger_shr(struct lemon *lemon, struct lobject *a, struct lobject *b)
 			return lobject_error_arithmetic(lemon, fmt, a, b);
 		}
 
+		if (lb >= (long)sizeof(la) * 8) {
+			return linteger_create_from_long(lemon, la < 0 ? -1 : 0);
+		}
+
 		return linteger_create_from_long(lemon, la >> lb);
 	}
 
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
 
 	s = (int)linteger_to_long(lemon, b);
-	if (s >= 8 * ia->ndigits) {
-		return linteger_create(lemon, 0);
+	if (s >= EXTEND_BITS * ia->ndigits) {
+		return linteger_create_from_long(lemon, 0);
 	}
 
 	ic = linteger_create(lemon, ia->ndigits - s/EXTEND_BITS);
@@ -595,6 +751,8 @@ linteger_bitwise_and(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	struct linteger *ia;
 	struct linteger *ib;
 	struct linteger *ic;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -606,15 +764,8 @@ linteger_bitwise_and(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return linteger_create_from_long(lemon, la & lb);
 	}
 
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
-
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
 	if (ia->ndigits < ib->ndigits) {
 		ndigits = ia->ndigits;
@@ -646,6 +797,8 @@ linteger_bitwise_xor(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	struct linteger *ib;
 	struct linteger *ic;
 	struct linteger *x;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -657,15 +810,8 @@ linteger_bitwise_xor(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return linteger_create_from_long(lemon, la ^ lb);
 	}
 
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
-
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
 	if (ia->ndigits > ib->ndigits) {
 		max = ia->ndigits;
@@ -704,6 +850,8 @@ linteger_bitwise_or(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	struct linteger *ib;
 	struct linteger *ic;
 	struct linteger *x;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
 
 	if (!lobject_is_pointer(lemon, a) && !lobject_is_pointer(lemon, b)) {
 		long la;
@@ -715,15 +863,8 @@ linteger_bitwise_or(struct lemon *lemon, struct lobject *a, struct lobject *b)
 		return linteger_create_from_long(lemon, la | lb);
 	}
 
-	ia = linteger_create_object_from_integer(lemon, a);
-	if (!ia) {
-		return NULL;
-	}
-
-	ib = linteger_create_object_from_integer(lemon, b);
-	if (!ib) {
-		return NULL;
-	}
+	ia = linteger_load(lemon, a, &ba);
+	ib = linteger_load(lemon, b, &bb);
 
 	if (ia->ndigits > ib->ndigits) {
 		x = ia;
@@ -752,146 +893,1100 @@ linteger_bitwise_or(struct lemon *lemon, struct lobject *a, struct lobject *b)
 	return (struct lobject *)ic;
 }
 
-static struct lobject *
-linteger_string(struct lemon *lemon, struct lobject *self)
+/*
+ * radix conversion
+ *
+ * decimal longer than LINTEGER_RADIX_THRESHOLD digits is split by
+ * power[k] = 10^(chunk << k), `chunk' is decimals fit in one extend_t.
+ * division by power[k] is multiplication by its reciprocal computed
+ * with Newton iteration, so both directions run in O(M(n) log n).
+ */
+#define LINTEGER_RADIX_THRESHOLD 32
+#define LINTEGER_RADIX_MAX 32
+
+struct linteger_radix {
+	int chunk;
+	int npowers;
+	struct linteger *power[LINTEGER_RADIX_MAX];
+	struct lobject *inverse[LINTEGER_RADIX_MAX];
+};
+
+/*
+ * a * BASE^n, or a / BASE^-n truncated if n is negative
+ */
+static struct linteger *
+linteger_shift_digits(struct lemon *lemon, struct lobject *a, int n)
 {
-	char buffer[40960];
-	char *p;
-	int size;
-	struct linteger *a;
-	struct linteger *integer;
+	struct linteger *ia;
+	struct linteger *ic;
+	union linteger_buffer ba;
 
-	if (!lobject_is_pointer(lemon, self)) {
-		snprintf(buffer,
-			 sizeof(buffer),
-			 "%ld",
-			 linteger_to_long(lemon, self));
-	} else {
-		integer = (struct linteger *)self;
-		if (integer->ndigits == 0) {
-			return lstring_create(lemon, "0", 1);
-		}
+	ia = linteger_load(lemon, a, &ba);
 
-		if (integer->sign == 0) {
-			buffer[0] = '-';
-			p = buffer + 1;
-			size = sizeof(buffer) - 1;
-		} else {
-			p = buffer;
-			size = sizeof(buffer);
+	if (n < 0) {
+		if (-n >= ia->ndigits) {
+			return linteger_create_object_from_long(lemon, 0);
+		}
+		ic = linteger_create(lemon, ia->ndigits + n);
+		if (!ic) {
+			return NULL;
+		}
+		memcpy(ic->digits,
+		       ia->digits - n,
+		       (ia->ndigits + n) * sizeof(extend_t));
+	} else {
+		ic = linteger_create(lemon, ia->ndigits + n);
+		if (!ic) {
+			return NULL;
 		}
-		a = linteger_create(lemon, integer->ndigits);
-		memcpy(a->digits,
-		       integer->digits,
-		       integer->ndigits * sizeof(extend_t));
-		a->ndigits = integer->ndigits;
-		extend_to_str(a->ndigits, a->digits, p, size, 10);
+		memcpy(ic->digits + n,
+		       ia->digits,
+		       ia->ndigits * sizeof(extend_t));
 	}
-	buffer[sizeof(buffer) - 1] = '\0';
+	ic->sign = ia->sign;
 
-	return lstring_create(lemon, buffer, strlen(buffer));
+	normalize(lemon, ic);
+	return ic;
 }
 
-struct lobject *
-linteger_method(struct lemon *lemon,
-                struct lobject *self,
-                int method, int argc, struct lobject *argv[])
+static int
+linteger_is_zero(struct lemon *lemon, struct lobject *a)
 {
+	struct linteger *integer;
 
-#define binop(op) do {                                                         \
-	if (lobject_is_integer(lemon, argv[0])) {                              \
-		return linteger_ ## op (lemon, self, argv[0]);                 \
-	}                                                                      \
-	if (lobject_is_number(lemon, argv[0])) {                               \
-		struct lobject *number;                                        \
-		if (lobject_is_pointer(lemon, self)) {                         \
-			const char *cstr;                                      \
-			struct lobject *string;                                \
-			string = linteger_string(lemon, self);                 \
-			cstr = lstring_to_cstr(lemon, string);                 \
-			number = lnumber_create_from_cstr(lemon, cstr);        \
-		} else {                                                       \
-			long value;                                            \
-			value = linteger_to_long(lemon, self);                 \
-			number = lnumber_create_from_long(lemon, value);       \
-		}                                                              \
-		if (!number) {                                                 \
-			return NULL;                                           \
-		}                                                              \
-		return lobject_method_call(lemon, number, method, argc, argv); \
-	}                                                                      \
-	return lobject_default(lemon, self, method, argc, argv);               \
-} while (0)
+	if (lobject_is_pointer(lemon, a)) {
+		integer = (struct linteger *)a;
+		return integer->ndigits == 1 && integer->digits[0] == 0;
+	}
 
-#define cmpop(op) do {                                                         \
-	if (lobject_is_integer(lemon, argv[0])) {                              \
-		struct lobject *a = self;                                      \
-		struct lobject *b = argv[0];                                   \
-		if (lobject_is_pointer(lemon, a) ||                            \
-		    lobject_is_pointer(lemon, b))                              \
-		{                                                              \
-			a = linteger_create_object_from_integer(lemon, a);     \
-			if (!a) {                                              \
-				return NULL;                                   \
-			}                                                      \
-			b = linteger_create_object_from_integer(lemon, b);     \
-			if (!b) {                                              \
-				return NULL;                                   \
-			}                                                      \
-		}                                                              \
-		if (linteger_cmp(lemon, a, b) op 0) {                          \
-			return lemon->l_true;                                  \
-		}                                                              \
-		return lemon->l_false;                                         \
-	}                                                                      \
-	if (lobject_is_number(lemon, argv[0])) {                               \
-		struct lobject *number;                                        \
-		if (lobject_is_pointer(lemon, self)) {                         \
-			const char *cstr;                                      \
-			struct lobject *string;                                \
-			string = linteger_string(lemon, self);                 \
-			cstr = lstring_to_cstr(lemon, string);                 \
-			number = lnumber_create_from_cstr(lemon, cstr);        \
-		} else {                                                       \
-			long value;                                            \
-			value = linteger_to_long(lemon, self);                 \
-			number = lnumber_create_from_long(lemon, value);       \
-		}                                                              \
-		if (!number) {                                                 \
-			return NULL;                                           \
-		}                                                              \
-		return lobject_method_call(lemon, number, method, argc, argv); \
-	}                                                                      \
-	return lobject_default(lemon, self, method, argc, argv);               \
-} while (0)
+	return linteger_to_long(lemon, a) == 0;
+}
 
-	switch (method) {
-	case LOBJECT_METHOD_ADD:
-		binop(add);
+static int
+linteger_is_negative(struct lemon *lemon, struct lobject *a)
+{
+	if (lobject_is_pointer(lemon, a)) {
+		return ((struct linteger *)a)->sign == 0;
+	}
+
+	return linteger_to_long(lemon, a) < 0;
+}
+
+/*
+ * floor(BASE^(2m) / p), m is digits of p
+ */
+static struct lobject *
+linteger_reciprocal(struct lemon *lemon, struct linteger *p)
+{
+	int m;
+	int h;
+	struct lobject *b;
+	struct lobject *x;
+	struct lobject *e;
+	struct lobject *t;
+	struct lobject *one;
+
+	m = p->ndigits;
+	one = linteger_create_from_long(lemon, 1);
+	b = (struct lobject *)linteger_shift_digits(lemon, one, 2 * m);
+	if (!b) {
+		return NULL;
+	}
+
+	if (m < LINTEGER_RADIX_THRESHOLD) {
+		return linteger_div(lemon, b, (struct lobject *)p);
+	}
+
+	/* reciprocal of top h digits is good for about 2 * h - 2 digits */
+	h = m / 2 + 2;
+	t = (struct lobject *)linteger_shift_digits(lemon,
+	                                            (struct lobject *)p,
+	                                            h - m);
+	if (!t) {
+		return NULL;
+	}
+	x = linteger_reciprocal(lemon, (struct linteger *)t);
+	if (!x) {
+		return NULL;
+	}
+	x = (struct lobject *)linteger_shift_digits(lemon, x, m - h);
+	if (!x) {
+		return NULL;
+	}
+
+	/* one Newton step x = x + x * (b - p * x) / b */
+	t = linteger_mul(lemon, (struct lobject *)p, x, 0);
+	if (!t) {
+		return NULL;
+	}
+	e = linteger_sub(lemon, b, t, 0);
+	if (!e) {
+		return NULL;
+	}
+	t = linteger_mul(lemon, x, e, 0);
+	if (!t) {
+		return NULL;
+	}
+	t = (struct lobject *)linteger_shift_digits(lemon, t, -2 * m);
+	if (!t) {
+		return NULL;
+	}
+	x = linteger_add(lemon, x, t, 0);
+	if (!x) {
+		return NULL;
+	}
+
+	/* x is off by a few */
+	t = linteger_mul(lemon, (struct lobject *)p, x, 0);
+	if (!t) {
+		return NULL;
+	}
+	e = linteger_sub(lemon, b, t, 0);
+	while (e && x && linteger_is_negative(lemon, e)) {
+		x = linteger_sub(lemon, x, one, 0);
+		e = linteger_add(lemon, e, (struct lobject *)p, 0);
+	}
+	while (e && x && linteger_cmp(lemon, e, (struct lobject *)p) >= 0) {
+		x = linteger_add(lemon, x, one, 0);
+		e = linteger_sub(lemon, e, (struct lobject *)p, 0);
+	}
+	if (!e) {
+		return NULL;
+	}
+
+	return x;
+}
+
+/*
+ * x = q * power[k] + r, x < power[k]^2
+ */
+static int
+linteger_radix_divmod(struct lemon *lemon,
+                      struct linteger_radix *radix,
+                      int k,
+                      struct lobject *x,
+                      struct lobject **q,
+                      struct lobject **r)
+{
+	struct lobject *t;
+	struct lobject *one;
+	struct linteger *p;
+
+	p = radix->power[k];
+	if (!radix->inverse[k]) {
+		radix->inverse[k] = linteger_reciprocal(lemon, p);
+		if (!radix->inverse[k]) {
+			return 0;
+		}
+	}
+
+	/* q is at most 2 too small */
+	t = linteger_mul(lemon, x, radix->inverse[k], 0);
+	if (!t) {
+		return 0;
+	}
+	*q = (struct lobject *)linteger_shift_digits(lemon, t, -2 * p->ndigits);
+	if (!*q) {
+		return 0;
+	}
+	t = linteger_mul(lemon, *q, (struct lobject *)p, 0);
+	if (!t) {
+		return 0;
+	}
+	*r = linteger_sub(lemon, x, t, 0);
+
+	one = linteger_create_from_long(lemon, 1);
+	while (*q && *r && linteger_cmp(lemon, *r, (struct lobject *)p) >= 0) {
+		*q = linteger_add(lemon, *q, one, 0);
+		*r = linteger_sub(lemon, *r, (struct lobject *)p, 0);
+	}
+
+	return *q && *r;
+}
+
+/*
+ * write decimal of x to p, left padded with '0' to `width', return end
+ */
+static char *
+linteger_radix_basecase(struct lemon *lemon,
+                        struct linteger_radix *radix,
+                        struct lobject *x,
+                        int width,
+                        char *p)
+{
+	int length;
+	struct linteger *a;
+	struct linteger *integer;
+	union linteger_buffer buffer;
+
+	integer = linteger_load(lemon, x, &buffer);
+	a = linteger_create(lemon, integer->ndigits);
+	if (!a) {
+		return NULL;
+	}
+	memcpy(a->digits, integer->digits, integer->ndigits * sizeof(extend_t));
+	extend_to_str(integer->ndigits,
+	              a->digits,
+	              p,
+	              integer->ndigits * (radix->chunk + 1) + 1,
+	              10);
+
+	length = (int)strlen(p);
+	if (width > length) {
+		memmove(p + width - length, p, length);
+		memset(p, '0', width - length);
+		length = width;
+	}
+
+	return p + length;
+}
+
+/*
+ * x < power[k + 1], pad to (chunk << (k + 1)) decimals if `pad'
+ */
+static char *
+linteger_radix_to_str(struct lemon *lemon,
+                      struct linteger_radix *radix,
+                      struct lobject *x,
+                      int k,
+                      char *p,
+                      int pad)
+{
+	int ndigits;
+	struct lobject *q;
+	struct lobject *r;
+
+	ndigits = 1;
+	if (lobject_is_pointer(lemon, x)) {
+		ndigits = ((struct linteger *)x)->ndigits;
+	}
+
+	if (k < 0 || ndigits < LINTEGER_RADIX_THRESHOLD) {
+		return linteger_radix_basecase(lemon,
+		                               radix,
+		                               x,
+		                               pad ? radix->chunk << (k + 1) : 0,
+		                               p);
+	}
+
+	if (!linteger_radix_divmod(lemon, radix, k, x, &q, &r)) {
+		return NULL;
+	}
+
+	/* no leading zero */
+	if (pad || !linteger_is_zero(lemon, q)) {
+		p = linteger_radix_to_str(lemon, radix, q, k - 1, p, pad);
+		if (!p) {
+			return NULL;
+		}
+		pad = 1;
+	}
+
+	return linteger_radix_to_str(lemon, radix, r, k - 1, p, pad);
+}
+
+static struct lobject *
+linteger_radix_from_str(struct lemon *lemon,
+                        struct linteger_radix *radix,
+                        const char *str,
+                        int length)
+{
+	int k;
+	int low;
+	char buffer[LINTEGER_RADIX_THRESHOLD * 20 + 1];
+	struct lobject *a;
+	struct lobject *b;
+	struct linteger *c;
+
+	if (length <= radix->chunk * LINTEGER_RADIX_THRESHOLD) {
+		c = linteger_create(lemon, length / radix->chunk + 1);
+		if (!c) {
+			return NULL;
+		}
+		memcpy(buffer, str, length);
+		buffer[length] = '\0';
+		extend_from_str(c->length, c->digits, buffer, 10, NULL);
+		normalize(lemon, c);
+
+		return (struct lobject *)c;
+	}
+
+	/* low part is (chunk << k) decimals */
+	for (k = 0; (radix->chunk << (k + 1)) < length; k++) {
+		/* NULL */
+	}
+	low = radix->chunk << k;
+
+	a = linteger_radix_from_str(lemon, radix, str, length - low);
+	if (!a) {
+		return NULL;
+	}
+	a = linteger_mul(lemon, a, (struct lobject *)radix->power[k], 0);
+	if (!a) {
+		return NULL;
+	}
+	b = linteger_radix_from_str(lemon, radix, str + length - low, low);
+	if (!b) {
+		return NULL;
+	}
+
+	return linteger_add(lemon, a, b, 0);
+}
+
+static int
+linteger_radix_init(struct lemon *lemon, struct linteger_radix *radix)
+{
+	long power;
+
+	power = (long)extend_radix(10, &radix->chunk);
+	radix->power[0] = linteger_create_object_from_long(lemon, power);
+	radix->inverse[0] = NULL;
+	radix->npowers = 1;
+
+	return radix->power[0] != NULL;
+}
+
+/*
+ * append square of last power
+ */
+static int
+linteger_radix_push(struct lemon *lemon, struct linteger_radix *radix)
+{
+	int n;
+	struct lobject *power;
+
+	n = radix->npowers;
+	if (n == LINTEGER_RADIX_MAX) {
+		return 0;
+	}
+
+	power = (struct lobject *)radix->power[n - 1];
+	power = linteger_mul(lemon, power, power, 0);
+	if (!power) {
+		return 0;
+	}
+	radix->power[n] = (struct linteger *)power;
+	radix->inverse[n] = NULL;
+	radix->npowers += 1;
+
+	return 1;
+}
+
+/*
+ * k (k < EXTEND_BITS) bits of |a| start from bit s
+ */
+static unsigned long
+linteger_get_bits(struct linteger *a, long s, int k)
+{
+	int i;
+	extend_wide_t bits;
+
+	i = (int)(s / EXTEND_BITS);
+	if (i >= a->ndigits) {
+		return 0;
+	}
+	bits = a->digits[i];
+	if (i + 1 < a->ndigits) {
+		bits += a->digits[i + 1] * EXTEND_BASE;
+	}
+	bits >>= s % EXTEND_BITS;
+
+	return (unsigned long)(bits & (((extend_wide_t)1 << k) - 1));
+}
+
+static struct lobject *
+linteger_abs(struct lemon *lemon, struct lobject *a)
+{
+	if (linteger_is_negative(lemon, a)) {
+		return linteger_neg(lemon, a);
+	}
+
+	return a;
+}
+
+/*
+ * a * b, or a * b mod m in [0, m) if `m' is not NULL, a, b and m >= 0
+ */
+static struct lobject *
+linteger_mulmod(struct lemon *lemon,
+                struct lobject *a,
+                struct lobject *b,
+                struct lobject *m)
+{
+	struct lobject *c;
+
+	c = linteger_mul(lemon, a, b, 0);
+	if (c && m) {
+		c = linteger_mod(lemon, c, m);
+	}
+
+	return c;
+}
+
+/*
+ * sliding window of k bits skip zero bits, need 2^(k-1) odd powers
+ */
+static int
+linteger_pow_window(long nbits)
+{
+	if (nbits <= 8) {
+		return 1;
+	}
+	if (nbits <= 24) {
+		return 2;
+	}
+	if (nbits <= 80) {
+		return 3;
+	}
+	if (nbits <= 240) {
+		return 4;
+	}
+	if (nbits <= 672) {
+		return 5;
+	}
+
+	return 6;
+}
+
+/*
+ * find next window of exponent `e' end at bit i, return odd value of
+ * bits [j, i] and set *j
+ */
+static unsigned long
+linteger_pow_next(struct linteger *e, long i, int k, long *j)
+{
+	long lo;
+
+	lo = i - k + 1;
+	if (lo < 0) {
+		lo = 0;
+	}
+	while (!linteger_get_bits(e, lo, 1)) {
+		lo += 1;
+	}
+	*j = lo;
+
+	return linteger_get_bits(e, lo, (int)(i - lo + 1));
+}
+
+/*
+ * left to right sliding window exponentiation on integer objects,
+ * used for no modulus or even modulus.  `base' in [0, m) if `m' given
+ */
+static struct lobject *
+linteger_pow_generic(struct lemon *lemon,
+                     struct lobject *base,
+                     struct linteger *e,
+                     struct lobject *m)
+{
+	int k;
+	long i;
+	long j;
+	long nbits;
+	unsigned long w;
+	struct lobject *r;
+	struct lobject *b2;
+	struct lobject *table[32];
+
+	nbits = linteger_bit_length(e);
+	k = linteger_pow_window(nbits);
+
+	/* table[i] = base^(2i + 1) */
+	table[0] = base;
+	if (k > 1) {
+		b2 = linteger_mulmod(lemon, base, base, m);
+		if (!b2) {
+			return NULL;
+		}
+		for (i = 1; i < (1L << (k - 1)); i++) {
+			table[i] = linteger_mulmod(lemon, table[i - 1], b2, m);
+			if (!table[i]) {
+				return NULL;
+			}
+		}
+	}
+
+	r = NULL;
+	for (i = nbits - 1; i >= 0; i = j - 1) {
+		if (!linteger_get_bits(e, i, 1)) {
+			r = linteger_mulmod(lemon, r, r, m);
+			if (!r) {
+				return NULL;
+			}
+			j = i;
+			continue;
+		}
+
+		w = linteger_pow_next(e, i, k, &j);
+		if (r) {
+			for (; i >= j; i--) {
+				r = linteger_mulmod(lemon, r, r, m);
+				if (!r) {
+					return NULL;
+				}
+			}
+			r = linteger_mulmod(lemon, r, table[w / 2], m);
+		} else {
+			r = table[w / 2];
+		}
+		if (!r) {
+			return NULL;
+		}
+	}
+
+	return r;
+}
+
+/*
+ * Montgomery form exponentiation for odd multi-digits modulus, every
+ * step is one extend_mul and one extend_redc on n digits, no division.
+ * `base' in [0, m)
+ */
+static struct lobject *
+linteger_pow_montgomery(struct lemon *lemon,
+                        struct lobject *base,
+                        struct linteger *e,
+                        struct linteger *m)
+{
+	int n;
+	int k;
+	int ntmp;
+	long i;
+	long j;
+	long nbits;
+	unsigned long w;
+	extend_t minv;
+	extend_t *t;
+	extend_t *r;
+	extend_t *tmp;
+	extend_t *table[32];
+	struct linteger *ir;
+	struct linteger *it;
+	struct linteger *ib;
+
+#define montmul(z, x, y) do {                          \
+	extend_mul(t, n, (x), n, (y), tmp);            \
+	extend_redc((z), n, t, m->digits, minv);       \
+} while (0)
+
+	n = m->ndigits;
+	minv = extend_inverse(m->digits[0]);
+	nbits = linteger_bit_length(e);
+	k = linteger_pow_window(nbits);
+
+	/* digits of r, t, every table item and extend_mul scratch */
+	ntmp = extend_mul_tmp(n, n);
+	it = linteger_create(lemon, n + (2 * n + 1) + (n << (k - 1)) + ntmp);
+	if (!it) {
+		return NULL;
+	}
+	r = it->digits;
+	t = r + n;
+	table[0] = t + 2 * n + 1;
+	tmp = ntmp ? table[0] + (n << (k - 1)) : NULL;
+
+	/* table[0] = base * BASE^n mod m */
+	ib = linteger_shift_digits(lemon, base, n);
+	if (!ib) {
+		return NULL;
+	}
+	ib = (struct linteger *)linteger_mod(lemon,
+	                                     (struct lobject *)ib,
+	                                     (struct lobject *)m);
+	if (!ib) {
+		return NULL;
+	}
+	memcpy(table[0], ib->digits, ib->ndigits * sizeof(extend_t));
+
+	if (k > 1) {
+		montmul(r, table[0], table[0]);
+		for (i = 1; i < (1L << (k - 1)); i++) {
+			table[i] = table[i - 1] + n;
+			montmul(table[i], table[i - 1], r);
+		}
+	}
+
+	/* exponent is not zero, so r is set by first window */
+	memset(r, 0, n * sizeof(extend_t));
+	for (i = nbits - 1; i >= 0; i = j - 1) {
+		if (!linteger_get_bits(e, i, 1)) {
+			montmul(r, r, r);
+			j = i;
+			continue;
+		}
+
+		w = linteger_pow_next(e, i, k, &j);
+		if (i == nbits - 1) {
+			memcpy(r, table[w / 2], n * sizeof(extend_t));
+		} else {
+			for (; i >= j; i--) {
+				montmul(r, r, r);
+			}
+			montmul(r, r, table[w / 2]);
+		}
+	}
+
+	/* leave Montgomery form, r / BASE^n */
+	ir = linteger_create(lemon, n);
+	if (!ir) {
+		return NULL;
+	}
+	memset(t, 0, (2 * n + 1) * sizeof(extend_t));
+	memcpy(t, r, n * sizeof(extend_t));
+	extend_redc(ir->digits, n, t, m->digits, minv);
+
+	normalize(lemon, ir);
+	return (struct lobject *)ir;
+#undef montmul
+}
+
+/*
+ * base ^ exp, or base ^ exp mod |m| in [0, |m|) if `m' is not NULL
+ */
+struct lobject *
+linteger_pow(struct lemon *lemon,
+             struct lobject *base,
+             struct lobject *exp,
+             struct lobject *m)
+{
+	struct linteger *e;
+	union linteger_buffer be;
+
+	if (linteger_is_negative(lemon, exp)) {
+		return lobject_error_arithmetic(lemon,
+		                                "'%@' negative exponent",
+		                                exp);
+	}
+
+	if (m) {
+		if (linteger_is_zero(lemon, m)) {
+			return lobject_error_arithmetic(lemon,
+			                                "divide by zero '%@/0'",
+			                                base);
+		}
+		m = linteger_abs(lemon, m);
+		if (!m) {
+			return NULL;
+		}
+		base = linteger_mod(lemon, base, m);
+		if (base && linteger_is_negative(lemon, base)) {
+			base = linteger_add(lemon, base, m, 0);
+		}
+		if (!base) {
+			return NULL;
+		}
+	}
+
+	if (linteger_is_zero(lemon, exp)) {
+		base = linteger_create_from_long(lemon, 1);
+		if (m) {
+			base = linteger_mod(lemon, base, m);
+		}
+		return linteger_demote(lemon, base);
+	}
+
+	e = linteger_load(lemon, exp, &be);
+
+	if (m &&
+	    lobject_is_pointer(lemon, m) &&
+	    ((struct linteger *)m)->ndigits > 1 &&
+	    ((struct linteger *)m)->digits[0] & 1)
+	{
+		base = linteger_pow_montgomery(lemon,
+		                               base,
+		                               e,
+		                               (struct linteger *)m);
+	} else {
+		base = linteger_pow_generic(lemon, base, e, m);
+	}
+
+	return linteger_demote(lemon, base);
+}
+
+/*
+ * gcd of small |a| and |b|
+ */
+static unsigned long
+linteger_gcd_long(unsigned long a, unsigned long b)
+{
+	int k;
+	unsigned long t;
+
+	if (a == 0) {
+		return b;
+	}
+	if (b == 0) {
+		return a;
+	}
+
+	/* binary gcd, remove common factor 2^k first */
+	for (k = 0; ((a | b) & 1) == 0; k++) {
+		a >>= 1;
+		b >>= 1;
+	}
+	while ((a & 1) == 0) {
+		a >>= 1;
+	}
+	do {
+		while ((b & 1) == 0) {
+			b >>= 1;
+		}
+		if (a > b) {
+			t = a;
+			a = b;
+			b = t;
+		}
+		b -= a;
+	} while (b);
+
+	return a << k;
+}
+
+/*
+ * u * a + v * b
+ */
+static struct lobject *
+linteger_combine(struct lemon *lemon,
+                 long u, struct lobject *a,
+                 long v, struct lobject *b)
+{
+	struct lobject *c;
+	struct lobject *d;
+
+	c = linteger_create_from_long(lemon, u);
+	if (c) {
+		c = linteger_mul(lemon, c, a, 0);
+	}
+	if (!c) {
+		return NULL;
+	}
+
+	d = linteger_create_from_long(lemon, v);
+	if (d) {
+		d = linteger_mul(lemon, d, b, 0);
+	}
+	if (!d) {
+		return NULL;
+	}
+
+	return linteger_add(lemon, c, d, 0);
+}
+
+/*
+ * Lehmer's gcd (Knuth 4.5.2 algorithm L), simulate Euclid steps on
+ * leading EXTEND_BITS - 1 bits in long, then apply the collected
+ * cosequence to full numbers, one multi-digits division only when
+ * single precision can't make progress
+ */
+struct lobject *
+linteger_gcd(struct lemon *lemon, struct lobject *a, struct lobject *b)
+{
+	int k;
+	long s;
+	long q;
+	long t;
+	long x;
+	long y;
+	long A;
+	long B;
+	long C;
+	long D;
+	struct lobject *c;
+	struct lobject *d;
+	struct linteger *ia;
+	struct linteger *ib;
+	union linteger_buffer ba;
+	union linteger_buffer bb;
+
+	a = linteger_abs(lemon, a);
+	if (!a) {
+		return NULL;
+	}
+	b = linteger_abs(lemon, b);
+	if (!b) {
+		return NULL;
+	}
+	if (linteger_cmp(lemon, a, b) < 0) {
+		c = a;
+		a = b;
+		b = c;
+	}
+
+	k = EXTEND_BITS - 1;
+	for (;;) {
+		if (linteger_is_zero(lemon, b)) {
+			return linteger_demote(lemon, a);
+		}
+
+		ia = linteger_load(lemon, a, &ba);
+		ib = linteger_load(lemon, b, &bb);
+		if (ia->ndigits == 1) {
+			unsigned long g;
+
+			g = linteger_gcd_long(ia->digits[0], ib->digits[0]);
+			return linteger_create_from_long(lemon, (long)g);
+		}
+
+		s = linteger_bit_length(ia) - k;
+		x = (long)linteger_get_bits(ia, s, k);
+		y = (long)linteger_get_bits(ib, s, k);
+		A = 1;
+		B = 0;
+		C = 0;
+		D = 1;
+		while (y + C != 0 && y + D != 0) {
+			q = (x + A) / (y + C);
+			if (q != (x + B) / (y + D)) {
+				break;
+			}
+			t = A - q * C;
+			A = C;
+			C = t;
+			t = B - q * D;
+			B = D;
+			D = t;
+			t = x - q * y;
+			x = y;
+			y = t;
+		}
+
+		if (B == 0) {
+			c = linteger_mod(lemon, a, b);
+			a = b;
+			b = c;
+		} else {
+			c = linteger_combine(lemon, A, a, B, b);
+			d = linteger_combine(lemon, C, a, D, b);
+			a = c;
+			b = d;
+		}
+		if (!a || !b) {
+			return NULL;
+		}
+	}
+}
+
+/*
+ * floor(sqrt(n)), Newton iteration with precision double every step
+ * from top bits, so the final step is the only full size division
+ */
+struct lobject *
+linteger_isqrt(struct lemon *lemon, struct lobject *n)
+{
+	int s;
+	long c;
+	long d;
+	long e;
+	struct lobject *a;
+	struct lobject *q;
+	struct lobject *k;
+	struct linteger *in;
+	union linteger_buffer bn;
+
+	if (linteger_is_negative(lemon, n)) {
+		return lobject_error_arithmetic(lemon,
+		                                "'%@' negative square root",
+		                                n);
+	}
+	if (linteger_is_zero(lemon, n)) {
+		return n;
+	}
+
+	in = linteger_load(lemon, n, &bn);
+	c = (linteger_bit_length(in) - 1) / 2;
+	for (s = 0; (c >> s) > 0; s++) {
+		/* NULL */
+	}
+
+	/* a = (a << (d - e - 1)) + (n >> (2c - e - d + 1)) / a */
+	a = linteger_create_from_long(lemon, 1);
+	d = 0;
+	for (s -= 1; s >= 0; s--) {
+		e = d;
+		d = c >> s;
+
+		k = linteger_create_from_long(lemon, 2 * c - e - d + 1);
+		q = linteger_shr(lemon, n, k);
+		if (!q) {
+			return NULL;
+		}
+		q = linteger_div(lemon, q, a);
+		if (!q) {
+			return NULL;
+		}
+		k = linteger_create_from_long(lemon, d - e - 1);
+		a = linteger_shl(lemon, a, k);
+		if (!a) {
+			return NULL;
+		}
+		a = linteger_add(lemon, a, q, 0);
+		if (!a) {
+			return NULL;
+		}
+	}
+
+	/* a is at most one too large */
+	q = linteger_mul(lemon, a, a, 0);
+	if (!q) {
+		return NULL;
+	}
+	if (linteger_cmp(lemon, q, n) > 0) {
+		k = linteger_create_from_long(lemon, 1);
+		a = linteger_sub(lemon, a, k, 0);
+	}
+
+	return linteger_demote(lemon, a);
+}
+
+static struct lobject *
+linteger_string(struct lemon *lemon, struct lobject *self)
+{
+	char buffer[32];
+	char *p;
+	int k;
+	long size;
+	struct lstring *string;
+	struct linteger *integer;
+	struct linteger_radix radix;
+
+	if (!lobject_is_pointer(lemon, self)) {
+		snprintf(buffer,
+			 sizeof(buffer),
+			 "%ld",
+			 linteger_to_long(lemon, self));
+
+		return lstring_create(lemon, buffer, strlen(buffer));
+	}
+
+	integer = (struct linteger *)self;
+	if (!linteger_radix_init(lemon, &radix)) {
+		return NULL;
+	}
+
+	/* until power[k]^2 > self */
+	while (2 * radix.power[radix.npowers - 1]->ndigits - 1 <=
+	       integer->ndigits)
+	{
+		if (!linteger_radix_push(lemon, &radix)) {
+			return NULL;
+		}
+	}
+
+	/* every extend_t digit is at most chunk + 1 decimals */
+	size = (long)integer->ndigits * (radix.chunk + 1) + 2;
+	string = lstring_create(lemon, NULL, size);
+	if (!string) {
+		return NULL;
+	}
+
+	/* convert magnitude */
+	p = string->buffer;
+	if (integer->sign == 0) {
+		*p++ = '-';
+		self = linteger_neg(lemon, self);
+		if (!self) {
+			return NULL;
+		}
+	}
+
+	k = radix.npowers - 1;
+	p = linteger_radix_to_str(lemon, &radix, self, k, p, 0);
+	if (!p) {
+		return NULL;
+	}
+	string->length = (long)(p - string->buffer);
+	string->buffer[string->length] = '\0';
+
+	return (struct lobject *)string;
+}
+
+struct lobject *
+linteger_method(struct lemon *lemon,
+                struct lobject *self,
+                int method, int argc, struct lobject *argv[])
+{
+
+#define binop(call) do {                                                       \
+	if (lobject_is_integer(lemon, argv[0])) {                              \
+		return linteger_demote(lemon, (call));                         \
+	}                                                                      \
+	if (lobject_is_number(lemon, argv[0])) {                               \
+		struct lobject *number;                                        \
+		if (lobject_is_pointer(lemon, self)) {                         \
+			const char *cstr;                                      \
+			struct lobject *string;                                \
+			string = linteger_string(lemon, self);                 \
+			cstr = lstring_to_cstr(lemon, string);                 \
+			number = lnumber_create_from_cstr(lemon, cstr);        \
+		} else {                                                       \
+			long value;                                            \
+			value = linteger_to_long(lemon, self);                 \
+			number = lnumber_create_from_long(lemon, value);       \
+		}                                                              \
+		if (!number) {                                                 \
+			return NULL;                                           \
+		}                                                              \
+		return lobject_method_call(lemon, number, method, argc, argv); \
+	}                                                                      \
+	return lobject_default(lemon, self, method, argc, argv);               \
+} while (0)
+
+#define cmpop(op) do {                                                         \
+	if (lobject_is_integer(lemon, argv[0])) {                              \
+		if (linteger_cmp(lemon, self, argv[0]) op 0) {                 \
+			return lemon->l_true;                                  \
+		}                                                              \
+		return lemon->l_false;                                         \
+	}                                                                      \
+	if (lobject_is_number(lemon, argv[0])) {                               \
+		struct lobject *number;                                        \
+		if (lobject_is_pointer(lemon, self)) {                         \
+			const char *cstr;                                      \
+			struct lobject *string;                                \
+			string = linteger_string(lemon, self);                 \
+			cstr = lstring_to_cstr(lemon, string);                 \
+			number = lnumber_create_from_cstr(lemon, cstr);        \
+		} else {                                                       \
+			long value;                                            \
+			value = linteger_to_long(lemon, self);                 \
+			number = lnumber_create_from_long(lemon, value);       \
+		}                                                              \
+		if (!number) {                                                 \
+			return NULL;                                           \
+		}                                                              \
+		return lobject_method_call(lemon, number, method, argc, argv); \
+	}                                                                      \
+	return lobject_default(lemon, self, method, argc, argv);               \
+} while (0)
+
+	switch (method) {
+	case LOBJECT_METHOD_ADD:
+		binop(linteger_add(lemon, self, argv[0], 1));
 
 	case LOBJECT_METHOD_SUB:
-		binop(sub);
+		binop(linteger_sub(lemon, self, argv[0], 1));
 
 	case LOBJECT_METHOD_MUL:
-		binop(mul);
+		binop(linteger_mul(lemon, self, argv[0], 1));
 
 	case LOBJECT_METHOD_DIV:
-		binop(div);
+		binop(linteger_div(lemon, self, argv[0]));
 
 	case LOBJECT_METHOD_MOD:
-		binop(mod);
+		binop(linteger_mod(lemon, self, argv[0]));
 
 	case LOBJECT_METHOD_POS:
 		return self;
 
 	case LOBJECT_METHOD_NEG:
-		return linteger_neg(lemon, self);
+		self = linteger_neg(lemon, self);
+		return linteger_demote(lemon, self);
 
 	case LOBJECT_METHOD_SHL:
-		binop(shl);
+		binop(linteger_shl(lemon, self, argv[0]));
 
 	case LOBJECT_METHOD_SHR:
-		binop(shr);
+		binop(linteger_shr(lemon, self, argv[0]));
 
 	case LOBJECT_METHOD_LT:
 		cmpop(<);
@@ -912,16 +2007,17 @@ linteger_method(struct lemon *lemon,
 		cmpop(>);
 
 	case LOBJECT_METHOD_BITWISE_NOT:
-		return linteger_bitwise_not(lemon, self);
+		self = linteger_bitwise_not(lemon, self);
+		return linteger_demote(lemon, self);
 
 	case LOBJECT_METHOD_BITWISE_AND:
-		binop(bitwise_and);
+		binop(linteger_bitwise_and(lemon, self, argv[0]));
 
 	case LOBJECT_METHOD_BITWISE_XOR:
-		binop(bitwise_xor);
+		binop(linteger_bitwise_xor(lemon, self, argv[0]));
 
 	case LOBJECT_METHOD_BITWISE_OR:
-		binop(bitwise_or);
+		binop(linteger_bitwise_or(lemon, self, argv[0]));
 
 	case LOBJECT_METHOD_HASH:
 		return self;
@@ -946,6 +2042,35 @@ linteger_method(struct lemon *lemon,
 	}
 }
 
+/*
+ * integer out of long is saturated by `linteger_to_long', check this
+ * first if it matter
+ */
+int
+linteger_fit_long(struct lemon *lemon, struct lobject *object)
+{
+	long bits;
+	long width;
+	struct linteger *integer;
+
+	if (!lobject_is_pointer(lemon, object)) {
+		return 1;
+	}
+
+	integer = (struct linteger *)object;
+	bits = linteger_bit_length(integer);
+	width = (long)sizeof(long) * CHAR_BIT;
+	if (bits < width) {
+		return 1;
+	}
+
+	/* LONG_MIN is the only full width value */
+	return !integer->sign &&
+	       bits == width &&
+	       extend_to_long(integer->ndigits, integer->digits) ==
+	       (unsigned long)LONG_MAX + 1;
+}
+
 long
 linteger_to_long(struct lemon *lemon, struct lobject *object)
 {
@@ -957,14 +2082,15 @@ linteger_to_long(struct lemon *lemon, struct lobject *object)
 		struct linteger *integer;
 
 		integer = (struct linteger *)object;
-		uvalue = extend_to_long(integer->ndigits, integer->digits);
-		if (uvalue > LONG_MAX) {
-			return LONG_MAX;
+		if (!linteger_fit_long(lemon, object)) {
+			return integer->sign ? LONG_MAX : LONG_MIN;
 		}
 
-		value = uvalue;
-		if (integer->sign == -1) {
-			value = -value;
+		uvalue = extend_to_long(integer->ndigits, integer->digits);
+		if (integer->sign) {
+			value = (long)uvalue;
+		} else {
+			value = -(long)(uvalue - 1) - 1;
 		}
 	} else {
 		sign = ((uintptr_t)object) & 0x2;
@@ -977,6 +2103,48 @@ linteger_to_long(struct lemon *lemon, struct lobject *object)
 	return value;
 }
 
+/*
+ * long may be 32 bits (LLP64), int64 is converted by digits
+ */
+int
+linteger_to_int64(struct lemon *lemon,
+                  struct lobject *object,
+                  int64_t *value)
+{
+	int i;
+	uint64_t u;
+	struct linteger *integer;
+
+	if (!lobject_is_pointer(lemon, object)) {
+		*value = linteger_to_long(lemon, object);
+
+		return 1;
+	}
+
+	integer = (struct linteger *)object;
+	if (linteger_bit_length(integer) > 64) {
+		return 0;
+	}
+
+	u = 0;
+	for (i = integer->ndigits - 1; i >= 0; i--) {
+		u = (u << EXTEND_BITS) | integer->digits[i];
+	}
+	if (integer->sign) {
+		if (u > INT64_MAX) {
+			return 0;
+		}
+		*value = (int64_t)u;
+	} else {
+		if (u > (uint64_t)INT64_MAX + 1) {
+			return 0;
+		}
+		*value = -(int64_t)(u - 1) - 1;
+	}
+
+	return 1;
+}
+
 void *
 linteger_create(struct lemon *lemon, int digits)
 {
@@ -998,15 +2166,18 @@ linteger_create(struct lemon *lemon, int digits)
 void *
 linteger_create_object_from_long(struct lemon *lemon, long value)
 {
+	unsigned long u;
 	struct linteger *self;
 
 	self = linteger_create(lemon, sizeof(long));
 	if (self) {
+		/* negate in unsigned, -LONG_MIN overflow long */
+		u = (unsigned long)value;
 		if (value < 0) {
 			self->sign = 0;
-			value = -value;
+			u = 0 - u;
 		}
-		extend_from_long(self->length, self->digits, value);
+		extend_from_long(self->length, self->digits, u);
 		normalize(lemon, self);
 	}
 
@@ -1055,40 +2226,78 @@ linteger_create_from_long(struct lemon *lemon, long value)
 	return linteger_create_object_from_long(lemon, value);
 }
 
+void *
+linteger_create_from_int64(struct lemon *lemon, int64_t value)
+{
+	int i;
+	uint64_t u;
+	struct linteger *self;
+
+	if (value >= LONG_MIN && value <= LONG_MAX) {
+		return linteger_create_from_long(lemon, (long)value);
+	}
+
+	self = linteger_create(lemon, (64 + EXTEND_BITS - 1) / EXTEND_BITS);
+	if (self) {
+		u = (uint64_t)value;
+		if (value < 0) {
+			self->sign = 0;
+			u = 0 - u;
+		}
+		for (i = 0; i < self->length; i++) {
+			self->digits[i] = (extend_t)(u & (EXTEND_BASE - 1));
+			u >>= EXTEND_BITS;
+		}
+		normalize(lemon, self);
+	}
+
+	return self;
+}
+
 void *
 linteger_create_from_cstr(struct lemon *lemon, const char *cstr)
 {
+	int k;
+	int base;
 	long value;
+	long length;
 	struct linteger *self;
+	struct linteger_radix radix;
 
 	value = strtol(cstr, NULL, 0);
 	if (value != LONG_MAX && value != LONG_MIN) {
 		return linteger_create_from_long(lemon, value);
 	}
 
-	self = linteger_create(lemon, (int)strlen(cstr));
-	if (self) {
-		if (cstr[0] == '0') {
-			if (cstr[1] == 'x' || cstr[1] == 'X') {
-				extend_from_str(self->length,
-				                self->digits,
-				                cstr + 2,
-				                16,
-				                NULL);
-			} else {
-				extend_from_str(self->length,
-				                self->digits,
-				                cstr + 1,
-				                8,
-				                NULL);
-			}
+	base = 10;
+	if (cstr[0] == '0') {
+		if (cstr[1] == 'x' || cstr[1] == 'X') {
+			base = 16;
+			cstr += 2;
 		} else {
-			extend_from_str(self->length,
-			                self->digits,
-			                cstr,
-			                10,
-			                NULL);
+			base = 8;
+			cstr += 1;
+		}
+	}
+	length = (long)strlen(cstr);
+
+	extend_radix(base, &k);
+	if (base == 10 && length > k * LINTEGER_RADIX_THRESHOLD) {
+		if (!linteger_radix_init(lemon, &radix)) {
+			return NULL;
+		}
+		while ((radix.chunk << radix.npowers) < length) {
+			if (!linteger_radix_push(lemon, &radix)) {
+				return NULL;
+			}
 		}
+
+		return linteger_radix_from_str(lemon, &radix, cstr, (int)length);
+	}
+
+	self = linteger_create(lemon, (int)(length / k) + 1);
+	if (self) {
+		extend_from_str(self->length, self->digits, cstr, base, NULL);
 		normalize(lemon, self);
 	}
 
@@ -1114,10 +2323,36 @@ linteger_type_method(struct lemon *lemon,
 		}
 
 		if (lobject_is_string(lemon, argv[0])) {
+			int sign;
 			const char *cstr;
+			struct lobject *integer;
 
 			cstr = lstring_to_cstr(lemon, argv[0]);
 			value = strtol(cstr, NULL, 10);
+			if (value != LONG_MAX && value != LONG_MIN) {
+				return linteger_create_from_long(lemon, value);
+			}
+
+			/* out of long, parse decimal digits */
+			sign = 0;
+			while (isspace((unsigned char)*cstr)) {
+				cstr++;
+			}
+			if (*cstr == '-' || *cstr == '+') {
+				sign = *cstr++ == '-';
+			}
+			while (cstr[0] == '0' && isdigit((unsigned char)cstr[1])) {
+				cstr++;
+			}
+			if (cstr[strspn(cstr, "0123456789")] != '\0') {
+				return linteger_create_from_long(lemon, value);
+			}
+			integer = linteger_create_from_cstr(lemon, cstr);
+			if (integer && sign) {
+				return linteger_neg(lemon, integer);
+			}
+
+			return integer;
 		}
 
 		return linteger_create_from_long(lemon, value);
@@ -6,7 +6,7 @@
 struct linteger {
 	struct lobject object;
 
-	int sign; /* 1 postive, -1 negative */
+	int sign; /* 1 postive, 0 negative */
 	int length; /* count of digits[] */
 	int ndigits; /* used digits in digits[] */
 	extend_t digits[1];
@@ -17,15 +17,38 @@ linteger_method(struct lemon *lemon,
                 struct lobject *self,
                 int method, int argc, struct lobject *argv[]);
 
+int
+linteger_fit_long(struct lemon *lemon, struct lobject *self);
+
 long
 linteger_to_long(struct lemon *lemon, struct lobject *self);
 
+int
+linteger_to_int64(struct lemon *lemon,
+                  struct lobject *self,
+                  int64_t *value);
+
 void *
 linteger_create_from_long(struct lemon *lemon, long value);
 
+void *
+linteger_create_from_int64(struct lemon *lemon, int64_t value);
+
 void *
 linteger_create_from_cstr(struct lemon *lemon, const char *cstr);
 
+struct lobject *
+linteger_pow(struct lemon *lemon,
+             struct lobject *base,
+             struct lobject *exp,
+             struct lobject *m);
+
+struct lobject *
+linteger_gcd(struct lemon *lemon, struct lobject *a, struct lobject *b);
+
+struct lobject *
+linteger_isqrt(struct lemon *lemon, struct lobject *n);
+
 struct ltype *
 linteger_type_create(struct lemon *lemon);
 
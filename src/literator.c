@@ -1,6 +1,7 @@
 #include "lemon.h"
 #include "larray.h"
 #include "lstring.h"
+#include "lrange.h"
 #include "linteger.h"
 #include "literator.h"
 
@@ -106,6 +107,33 @@ literator_array(struct lemon *lemon,
 		iterator->max = linteger_to_long(lemon, argv[0]);
 	}
 
+	/* native iterator, collect by `next' without frame */
+	if (iterator->next) {
+		struct lobject *item;
+		struct lobject *array;
+
+		array = larray_create(lemon, 0, NULL);
+		if (!array) {
+			return NULL;
+		}
+		while (larray_length(lemon, array) < iterator->max) {
+			item = iterator->next(lemon,
+			                      iterator->iterable,
+			                      &iterator->context);
+			if (!item || lobject_is_error(lemon, item)) {
+				return item;
+			}
+			if (item == lemon->l_sentinel) {
+				break;
+			}
+			if (!larray_append(lemon, array, 1, &item)) {
+				return NULL;
+			}
+		}
+
+		return array;
+	}
+
 	frame = lemon_machine_push_new_frame(lemon,
 	                                     self,
 	                                     NULL,
@@ -215,6 +243,11 @@ literator_to_array(struct lemon *lemon, struct lobject *iterable, long max)
 		argv[0] = linteger_create_from_long(lemon, max);
 	}
 
+	/* range is filled without iterator */
+	if (lobject_is_range(lemon, iterable)) {
+		return lrange_to_array(lemon, iterable);
+	}
+
 	if (lobject_is_iterator(lemon, iterable)) {
 		iterator = iterable;
 	} else {
@@ -9,22 +9,21 @@
 #include <stdlib.h>
 #include <string.h>
 
-void *
-lnumber_create_from_double(struct lemon *lemon, double value);
-
 static struct lobject *
-lnumber_div(struct lemon *lemon, struct lnumber *a, struct lobject *b)
+lnumber_div(struct lemon *lemon, struct lobject *a, struct lobject *b)
 {
 	double value;
 	if (lobject_is_number(lemon, b)) {
-		value = ((struct lnumber *)b)->value;
+		value = lnumber_to_double(lemon, b);
 		if (value == 0.0) {
 			return lobject_error_arithmetic(lemon,
 			                                "divide by zero '%@/0'",
 			                                a);
 		}
 
-		return lnumber_create_from_double(lemon, a->value / value);
+		value = lnumber_to_double(lemon, a) / value;
+
+		return lnumber_create_from_double(lemon, value);
 	}
 
 	if (lobject_is_integer(lemon, b)) {
@@ -34,13 +33,12 @@ lnumber_div(struct lemon *lemon, struct lnumber *a, struct lobject *b)
 			                                a);
 		}
 		value = linteger_to_long(lemon, b);
+		value = lnumber_to_double(lemon, a) / value;
 
-		return lnumber_create_from_double(lemon, a->value / value);
+		return lnumber_create_from_double(lemon, value);
 	}
 
-	return lobject_default(lemon,
-	                       (struct lobject *)a,
-	                       LOBJECT_METHOD_DIV, 1, &b);
+	return lobject_default(lemon, a, LOBJECT_METHOD_DIV, 1, &b);
 }
 
 static struct lobject *
@@ -50,33 +48,35 @@ lnumber_destroy(struct lemon *lemon, struct lnumber *lnumber)
 }
 
 static struct lobject *
-lnumber_string(struct lemon *lemon, struct lnumber *lnumber)
+lnumber_string(struct lemon *lemon, struct lobject *self)
 {
+	double value;
 	char buffer[256];
 
-	snprintf(buffer, sizeof(buffer), "%f", lnumber->value);
+	value = lnumber_to_double(lemon, self);
+	snprintf(buffer, sizeof(buffer), "%f", value);
 	buffer[sizeof(buffer) - 1] = '\0';
 
 	return lstring_create(lemon, buffer, strlen(buffer));
 }
 
-static struct lobject *
+struct lobject *
 lnumber_method(struct lemon *lemon,
                struct lobject *self,
                int method, int argc, struct lobject *argv[])
 {
-#define cast(a) ((struct lnumber *)(a))
+#define unbox(a) lnumber_to_double(lemon, (a))
 
 #define binop(op) do {                                             \
 	double value;                                              \
 	if (lobject_is_number(lemon, argv[0])) {                   \
-		value = cast(argv[0])->value;                      \
-		value = cast(self)->value op value;                \
+		value = unbox(argv[0]);                            \
+		value = unbox(self) op value;                      \
 		return lnumber_create_from_double(lemon, value);   \
 	}                                                          \
 	if (lobject_is_integer(lemon, argv[0])) {                  \
 		value = (double)linteger_to_long(lemon, argv[0]);  \
-		value = cast(self)->value op value;                \
+		value = unbox(self) op value;                      \
 		return lnumber_create_from_double(lemon, value);   \
 	}                                                          \
 	return lobject_default(lemon, self, method, argc, argv);   \
@@ -85,15 +85,15 @@ lnumber_method(struct lemon *lemon,
 #define cmpop(op) do {                                             \
 	double value;                                              \
 	if (lobject_is_number(lemon, argv[0])) {                   \
-		value = cast(argv[0])->value;                      \
-		if (cast(self)->value op value) {                  \
+		value = unbox(argv[0]);                            \
+		if (unbox(self) op value) {                        \
 			return lemon->l_true;                      \
 		}                                                  \
 		return lemon->l_false;                             \
 	}                                                          \
 	if (lobject_is_integer(lemon, argv[0])) {                  \
 		value = (double)linteger_to_long(lemon, argv[0]);  \
-		if (cast(self)->value op value) {                  \
+		if (unbox(self) op value) {                        \
 			return lemon->l_true;                      \
 		}                                                  \
 		return lemon->l_false;                             \
@@ -112,18 +112,18 @@ lnumber_method(struct lemon *lemon,
 		binop(*);
 
 	case LOBJECT_METHOD_DIV:
-		return lnumber_div(lemon, cast(self), argv[0]);
+		return lnumber_div(lemon, self, argv[0]);
 
 	case LOBJECT_METHOD_MOD: {
 		double value;
 		if (lobject_is_number(lemon, argv[0])) {
-			value = cast(argv[0])->value;
-			value = fmod(cast(self)->value, value);
+			value = unbox(argv[0]);
+			value = fmod(unbox(self), value);
 			return lnumber_create_from_double(lemon, value);
 		}
 		if (lobject_is_integer(lemon, argv[0])) {
 			value = (double)linteger_to_long(lemon, argv[0]);
-			value = fmod(cast(self)->value, value);
+			value = fmod(unbox(self), value);
 			return lnumber_create_from_double(lemon, value);
 		}
 		return lobject_default(lemon, self, method, argc, argv);
@@ -133,7 +133,7 @@ lnumber_method(struct lemon *lemon,
 		return self;
 
 	case LOBJECT_METHOD_NEG:
-		return lnumber_create_from_double(lemon, -cast(self)->value);
+		return lnumber_create_from_double(lemon, -unbox(self));
 
 	case LOBJECT_METHOD_LT:
 		cmpop(<);
@@ -155,26 +155,26 @@ lnumber_method(struct lemon *lemon,
 
 	case LOBJECT_METHOD_HASH:
 		return linteger_create_from_long(lemon,
-		                                 (long)cast(self)->value);
+		                                 (long)unbox(self));
 
 	case LOBJECT_METHOD_NUMBER:
 		return self;
 
 	case LOBJECT_METHOD_BOOLEAN:
-		if (cast(self)->value) {
+		if (unbox(self)) {
 			return lemon->l_true;
 		}
 		return lemon->l_false;
 
 	case LOBJECT_METHOD_STRING:
-		return lnumber_string(lemon, cast(self));
+		return lnumber_string(lemon, self);
 
 	case LOBJECT_METHOD_INTEGER:
 		return linteger_create_from_long(lemon,
-		                                 (long)cast(self)->value);
+		                                 (long)unbox(self));
 
 	case LOBJECT_METHOD_DESTROY:
-		return lnumber_destroy(lemon, cast(self));
+		return lnumber_destroy(lemon, (struct lnumber *)self);
 
 	default:
 		return lobject_default(lemon, self, method, argc, argv);
@@ -184,7 +184,26 @@ lnumber_method(struct lemon *lemon,
 double
 lnumber_to_double(struct lemon *lemon, struct lobject *self)
 {
+#ifdef LNUMBER_IMMEDIATE
+	double value;
+	unsigned long bits;
+
+	if (lobject_is_pointer(lemon, self)) {
+		return ((struct lnumber *)self)->value;
+	}
+
+	/* undo exponent rebias then rotate sign back to bit 63 */
+	bits = (unsigned long)((uintptr_t)self >> 3);
+	if (bits > 1) {
+		bits += LNUMBER_IMMEDIATE_BIAS;
+	}
+	bits = (bits >> 1) | (bits << 63);
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+#else
 	return ((struct lnumber *)self)->value;
+#endif
 }
 
 void *
@@ -200,33 +219,38 @@ lnumber_create(struct lemon *lemon)
 void *
 lnumber_create_from_long(struct lemon *lemon, long value)
 {
-	struct lnumber *self;
-
-	self = lnumber_create(lemon);
-	if (self) {
-		self->value = (double)value;
-	}
-
-	return self;
+	return lnumber_create_from_double(lemon, (double)value);
 }
 
 void *
 lnumber_create_from_cstr(struct lemon *lemon, const char *value)
 {
-	struct lnumber *self;
-
-	self = lnumber_create(lemon);
-	if (self) {
-		self->value = strtod(value, NULL);
-	}
-
-	return self;
+	return lnumber_create_from_double(lemon, strtod(value, NULL));
 }
 
 void *
 lnumber_create_from_double(struct lemon *lemon, double value)
 {
 	struct lnumber *self;
+#ifdef LNUMBER_IMMEDIATE
+	unsigned long bits;
+
+	/*
+	 * rotate sign to bit 0 and rebias exponent so 2^-127 .. 2^128 fit
+	 * in 61 bits, the word then is `bits << 3 | LNUMBER_TAG'.  +0.0 and
+	 * -0.0 rotate to 0 and 1 and skip rebias, others (huge, tiny, inf
+	 * and nan) fall back to boxed number.
+	 */
+	memcpy(&bits, &value, sizeof(bits));
+	bits = (bits << 1) | (bits >> 63);
+	if (bits <= 1) {
+		return (void *)(uintptr_t)((bits << 3) | LNUMBER_TAG);
+	}
+	bits -= LNUMBER_IMMEDIATE_BIAS;
+	if (bits > 1 && (bits >> 61) == 0) {
+		return (void *)(uintptr_t)((bits << 3) | LNUMBER_TAG);
+	}
+#endif
 
 	self = lnumber_create(lemon);
 	if (self) {
@@ -3,12 +3,32 @@
 
 #include "lobject.h"
 
+#include <limits.h>
+
+/*
+ * number is immediate (no allocation) when it fit in tagged word, tag
+ * 0x2 in low 3 bits don't clash with small integer (0x1) and pointer
+ * (aligned 8), require 64 bits long and pointer.
+ */
+#if ULONG_MAX > 0xffffffffUL
+#define LNUMBER_IMMEDIATE
+#endif
+
+#define LNUMBER_TAG 0x2
+#define LNUMBER_TAG_MASK 0x7
+#define LNUMBER_IMMEDIATE_BIAS ((unsigned long)896 << 53)
+
 struct lnumber {
 	struct lobject object;
 
 	double value;
 };
 
+struct lobject *
+lnumber_method(struct lemon *lemon,
+               struct lobject *self,
+               int method, int argc, struct lobject *argv[]);
+
 double
 lnumber_to_double(struct lemon *lemon, struct lobject *self);
 
@@ -18,6 +38,9 @@ lnumber_create_from_long(struct lemon *lemon, long value);
 void *
 lnumber_create_from_cstr(struct lemon *lemon, const char *value);
 
+void *
+lnumber_create_from_double(struct lemon *lemon, double value);
+
 struct ltype *
 lnumber_type_create(struct lemon *lemon);
 
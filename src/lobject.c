@@ -1,6 +1,7 @@
 #include "lemon.h"
 #include "larray.h"
 #include "lclass.h"
+#include "lnumber.h"
 #include "lstring.h"
 #include "linteger.h"
 #include "linstance.h"
@@ -110,6 +111,11 @@ lobject_boolean(struct lemon *lemon, struct lobject *self)
 	                               self,
 	                               LOBJECT_METHOD_BOOLEAN, 0, NULL);
 	}
+	if (!lobject_is_pointer(lemon, self)) {
+		return lobject_method_call(lemon,
+		                           self,
+		                           LOBJECT_METHOD_BOOLEAN, 0, NULL);
+	}
 	if (self->l_method == lemon->l_boolean_type->method) {
 		return self;
 	}
@@ -432,13 +438,18 @@ lobject_is_integer(struct lemon *lemon, struct lobject *object)
 		return 1;
 	}
 
+	if (!lobject_is_pointer(lemon, object)) {
+		return 0;
+	}
+
 	return object->l_method == lemon->l_integer_type->method;
 }
 
 int
 lobject_is_pointer(struct lemon *lemon, struct lobject *object)
 {
-	return ((int)((intptr_t)(object)) & 0x1) == 0;
+	/* small integer tag 0x1, immediate number tag 0x2 */
+	return ((int)((intptr_t)(object)) & 0x7) == 0;
 }
 
 int
@@ -508,7 +519,7 @@ lobject_is_number(struct lemon *lemon, struct lobject *object)
 		return object->l_method == lemon->l_number_type->method;
 	}
 
-	return 0;
+	return ((int)((intptr_t)(object)) & LNUMBER_TAG_MASK) == LNUMBER_TAG;
 }
 
 int
@@ -531,6 +542,16 @@ lobject_is_iterator(struct lemon *lemon, struct lobject *object)
 	return 0;
 }
 
+int
+lobject_is_range(struct lemon *lemon, struct lobject *object)
+{
+	if (lobject_is_pointer(lemon, object)) {
+		return object->l_method == lemon->l_range_type->method;
+	}
+
+	return 0;
+}
+
 int
 lobject_is_instance(struct lemon *lemon, struct lobject *object)
 {
@@ -875,6 +896,10 @@ lobject_method_call(struct lemon *lemon,
 		return linteger_method(lemon, self, method, argc, argv);
 	}
 
+	if (lobject_is_number(lemon, self)) {
+		return lnumber_method(lemon, self, method, argc, argv);
+	}
+
 	return lobject_default(lemon, self, method, argc, argv);
 }
 
@@ -1028,6 +1053,15 @@ lobject_get_default_instanceof(struct lemon *lemon,
 		return lemon->l_false;
 	}
 
+	if (lobject_is_number(lemon, self)) {
+		for (i = 0; i < argc; i++) {
+			if (lemon->l_number_type == (struct ltype *)argv[i]) {
+				return lemon->l_true;
+			}
+		}
+		return lemon->l_false;
+	}
+
 	return lemon->l_false;
 }
 
@@ -1036,7 +1070,9 @@ lobject_get_default_callable(struct lemon *lemon,
                          struct lobject *self,
                          int argc, struct lobject *argv[])
 {
-	return self->l_method(lemon, self, LOBJECT_METHOD_CALLABLE, 0, NULL);
+	return lobject_method_call(lemon,
+	                           self,
+	                           LOBJECT_METHOD_CALLABLE, 0, NULL);
 }
 
 struct lobject *
@@ -307,6 +307,9 @@ lobject_is_string(struct lemon *lemon, struct lobject *object);
 int
 lobject_is_iterator(struct lemon *lemon, struct lobject *object);
 
+int
+lobject_is_range(struct lemon *lemon, struct lobject *object);
+
 int
 lobject_is_instance(struct lemon *lemon, struct lobject *object);
 
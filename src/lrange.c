@@ -0,0 +1,505 @@
+#include "lemon.h"
+#include "larray.h"
+#include "lrange.h"
+#include "lstring.h"
+#include "linteger.h"
+#include "literator.h"
+
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+
+/*
+ * distance is computed in unsigned long, `stop - start' may overflow long
+ */
+static unsigned long
+lrange_count(struct lrange *self)
+{
+	unsigned long start;
+	unsigned long stop;
+	unsigned long step;
+
+	start = (unsigned long)self->start;
+	stop = (unsigned long)self->stop;
+	step = (unsigned long)self->step;
+	if (self->step > 0) {
+		if (self->start >= self->stop) {
+			return 0;
+		}
+
+		return (stop - start - 1) / step + 1;
+	}
+
+	if (self->start <= self->stop) {
+		return 0;
+	}
+
+	return (start - stop - 1) / (0UL - step) + 1;
+}
+
+static long
+lrange_at(struct lrange *self, long i)
+{
+	unsigned long offset;
+
+	offset = (unsigned long)i * (unsigned long)self->step;
+
+	return (long)((unsigned long)self->start + offset);
+}
+
+long
+lrange_length(struct lemon *lemon, struct lobject *self)
+{
+	unsigned long count;
+
+	count = lrange_count((struct lrange *)self);
+	if (count > LONG_MAX) {
+		return LONG_MAX;
+	}
+
+	return (long)count;
+}
+
+struct lobject *
+lrange_to_array(struct lemon *lemon, struct lobject *self)
+{
+	int n;
+	long i;
+	long length;
+	struct lrange *range;
+	struct lobject *array;
+	struct lobject *items[64];
+
+	range = (struct lrange *)self;
+	length = lrange_length(lemon, self);
+	if (length > INT_MAX) {
+		return lemon->l_out_of_memory;
+	}
+
+	array = larray_create(lemon, 0, NULL);
+	if (!array) {
+		return NULL;
+	}
+
+	/* append by chunk, array grow by doubling */
+	n = 0;
+	for (i = 0; i < length; i++) {
+		items[n] = linteger_create_from_long(lemon,
+		                                     lrange_at(range, i));
+		if (!items[n]) {
+			return NULL;
+		}
+		if (++n == 64 || i == length - 1) {
+			if (!larray_append(lemon, array, n, items)) {
+				return NULL;
+			}
+			n = 0;
+		}
+	}
+
+	return array;
+}
+
+static struct lobject *
+lrange_iterator_next(struct lemon *lemon,
+                     struct lobject *iterable,
+                     struct lobject **context)
+{
+	long value;
+	unsigned long left;
+	unsigned long step;
+	struct lrange *range;
+	struct lobject *item;
+
+	range = (struct lrange *)iterable;
+	value = linteger_to_long(lemon, *context);
+	if (range->step > 0) {
+		if (value >= range->stop) {
+			return lemon->l_sentinel;
+		}
+		left = (unsigned long)range->stop - (unsigned long)value;
+		step = (unsigned long)range->step;
+	} else {
+		if (value <= range->stop) {
+			return lemon->l_sentinel;
+		}
+		left = (unsigned long)value - (unsigned long)range->stop;
+		step = 0UL - (unsigned long)range->step;
+	}
+
+	/* `context' is the next item, clamp to `stop' at last step */
+	item = *context;
+	if (left > step) {
+		value += range->step;
+	} else {
+		value = range->stop;
+	}
+	*context = linteger_create_from_long(lemon, value);
+	if (!*context) {
+		return NULL;
+	}
+
+	return item;
+}
+
+static struct lobject *
+lrange_iterator(struct lemon *lemon,
+                struct lobject *self,
+                int argc, struct lobject *argv[])
+{
+	struct lrange *range;
+	struct lobject *context;
+
+	range = (struct lrange *)self;
+	context = linteger_create_from_long(lemon, range->start);
+	if (!context) {
+		return NULL;
+	}
+
+	return literator_create(lemon, self, context, lrange_iterator_next);
+}
+
+static struct lobject *
+lrange_get_item(struct lemon *lemon,
+                struct lrange *self,
+                struct lobject *name)
+{
+	long i;
+	long length;
+
+	if (!lobject_is_integer(lemon, name)) {
+		return NULL;
+	}
+
+	length = lrange_length(lemon, (struct lobject *)self);
+	i = linteger_to_long(lemon, name);
+	if (i < 0) {
+		i = length + i;
+	}
+	if (!linteger_fit_long(lemon, name) || i < 0 || i >= length) {
+		return lobject_error_item(lemon,
+		                          "'%@' index out of range",
+		                          (struct lobject *)self);
+	}
+
+	return linteger_create_from_long(lemon, lrange_at(self, i));
+}
+
+static struct lobject *
+lrange_has_item(struct lemon *lemon,
+                struct lrange *self,
+                struct lobject *item)
+{
+	long value;
+	unsigned long offset;
+
+	if (!lobject_is_integer(lemon, item) ||
+	    !linteger_fit_long(lemon, item))
+	{
+		return lemon->l_false;
+	}
+
+	value = linteger_to_long(lemon, item);
+	if (self->step > 0) {
+		if (value < self->start || value >= self->stop) {
+			return lemon->l_false;
+		}
+		offset = (unsigned long)value - (unsigned long)self->start;
+		if (offset % (unsigned long)self->step) {
+			return lemon->l_false;
+		}
+	} else {
+		if (value > self->start || value <= self->stop) {
+			return lemon->l_false;
+		}
+		offset = (unsigned long)self->start - (unsigned long)value;
+		if (offset % (0UL - (unsigned long)self->step)) {
+			return lemon->l_false;
+		}
+	}
+
+	return lemon->l_true;
+}
+
+static struct lobject *
+lrange_get_slice(struct lemon *lemon,
+                 struct lrange *self,
+                 struct lobject *start,
+                 struct lobject *stop,
+                 struct lobject *step)
+{
+	long last;
+	long first;
+	long count;
+	long istart;
+	long istop;
+	long istep;
+	long length;
+
+	length = lrange_length(lemon, (struct lobject *)self);
+	istart = linteger_to_long(lemon, start);
+	if (stop == lemon->l_nil) {
+		istop = length;
+	} else {
+		istop = linteger_to_long(lemon, stop);
+	}
+	istep = linteger_to_long(lemon, step);
+
+	if (istart < 0) {
+		istart = length + istart;
+	}
+	if (istop < 0) {
+		istop = length + istop;
+	}
+	if (istart < 0) {
+		istart = 0;
+	}
+	if (istop > length) {
+		istop = length;
+	}
+	if (istart > istop) {
+		istart = istop;
+	}
+	if (istep < 1) {
+		return lobject_error_argument(lemon,
+		                              "'%@' slice step must be > 0",
+		                              (struct lobject *)self);
+	}
+
+	first = lrange_at(self, istart);
+	if (istart == istop) {
+		return lrange_create(lemon, first, first, self->step);
+	}
+
+	/* slice of range is range, `stop' is one past the last item */
+	count = (istop - istart - 1) / istep + 1;
+	if (count == 1) {
+		istep = 1;
+	}
+	last = lrange_at(self, istart + (count - 1) * istep);
+
+	/* items fit long but distance of two items may not */
+	if ((self->step > 0 && self->step > LONG_MAX / istep) ||
+	    (self->step < 0 && self->step < LONG_MIN / istep))
+	{
+		return lobject_error_argument(lemon,
+		                              "'%@' slice step out of range",
+		                              (struct lobject *)self);
+	}
+	istep = self->step * istep;
+	if (self->step > 0) {
+		return lrange_create(lemon, first, last + 1, istep);
+	}
+
+	return lrange_create(lemon, first, last - 1, istep);
+}
+
+/*
+ * range equal if they yield same sequence, `range(0, 5, 3) == range(0, 4, 3)'
+ */
+static struct lobject *
+lrange_eq(struct lemon *lemon, struct lrange *a, struct lobject *b)
+{
+	unsigned long count;
+
+	if (!lobject_is_range(lemon, b)) {
+		return lemon->l_false;
+	}
+
+	count = lrange_count(a);
+	if (count != lrange_count((struct lrange *)b)) {
+		return lemon->l_false;
+	}
+	if (count == 0) {
+		return lemon->l_true;
+	}
+	if (a->start != ((struct lrange *)b)->start) {
+		return lemon->l_false;
+	}
+	if (count > 1 && a->step != ((struct lrange *)b)->step) {
+		return lemon->l_false;
+	}
+
+	return lemon->l_true;
+}
+
+static struct lobject *
+lrange_hash(struct lemon *lemon, struct lrange *self)
+{
+	unsigned long hash;
+	unsigned long count;
+
+	count = lrange_count(self);
+	if (count == 0) {
+		return linteger_create_from_long(lemon, 0);
+	}
+
+	hash = count * 31 + (unsigned long)self->start;
+	if (count > 1) {
+		hash = hash * 31 + (unsigned long)self->step;
+	}
+
+	return linteger_create_from_long(lemon, (long)(hash & LONG_MAX));
+}
+
+static struct lobject *
+lrange_get_attr(struct lemon *lemon,
+                struct lobject *self,
+                struct lobject *name)
+{
+	const char *cstr;
+
+	cstr = lstring_to_cstr(lemon, name);
+	if (strcmp(cstr, "__iterator__") == 0) {
+		return lfunction_create(lemon, name, self, lrange_iterator);
+	}
+
+	return NULL;
+}
+
+static struct lobject *
+lrange_string(struct lemon *lemon, struct lrange *self)
+{
+	char buffer[80];
+
+	snprintf(buffer,
+	         sizeof(buffer),
+	         "range(%ld, %ld, %ld)",
+	         self->start,
+	         self->stop,
+	         self->step);
+	buffer[sizeof(buffer) - 1] = '\0';
+
+	return lstring_create(lemon, buffer, strlen(buffer));
+}
+
+static struct lobject *
+lrange_method(struct lemon *lemon,
+              struct lobject *self,
+              int method, int argc, struct lobject *argv[])
+{
+#define cast(a) ((struct lrange *)(a))
+
+	switch (method) {
+	case LOBJECT_METHOD_EQ:
+		return lrange_eq(lemon, cast(self), argv[0]);
+
+	case LOBJECT_METHOD_HASH:
+		return lrange_hash(lemon, cast(self));
+
+	case LOBJECT_METHOD_GET_ITEM:
+		return lrange_get_item(lemon, cast(self), argv[0]);
+
+	case LOBJECT_METHOD_HAS_ITEM:
+		return lrange_has_item(lemon, cast(self), argv[0]);
+
+	case LOBJECT_METHOD_GET_SLICE:
+		return lrange_get_slice(lemon,
+		                        cast(self),
+		                        argv[0],
+		                        argv[1],
+		                        argv[2]);
+
+	case LOBJECT_METHOD_GET_ATTR:
+		return lrange_get_attr(lemon, self, argv[0]);
+
+	case LOBJECT_METHOD_STRING:
+		return lrange_string(lemon, cast(self));
+
+	case LOBJECT_METHOD_LENGTH:
+		return linteger_create_from_long(lemon,
+		                                 lrange_length(lemon, self));
+
+	case LOBJECT_METHOD_BOOLEAN:
+		if (lrange_count(cast(self))) {
+			return lemon->l_true;
+		}
+		return lemon->l_false;
+
+	case LOBJECT_METHOD_MARK:
+		return NULL;
+
+	case LOBJECT_METHOD_DESTROY:
+		return NULL;
+
+	default:
+		return lobject_default(lemon, self, method, argc, argv);
+	}
+}
+
+void *
+lrange_create(struct lemon *lemon, long start, long stop, long step)
+{
+	struct lrange *self;
+
+	self = lobject_create(lemon, sizeof(*self), lrange_method);
+	if (self) {
+		self->start = start;
+		self->stop = stop;
+		self->step = step;
+	}
+
+	return self;
+}
+
+static struct lobject *
+lrange_type_method(struct lemon *lemon,
+                   struct lobject *self,
+                   int method, int argc, struct lobject *argv[])
+{
+	switch (method) {
+	case LOBJECT_METHOD_CALL: {
+		int i;
+		long values[3];
+		const char *fmt;
+
+		if (argc < 1 || argc > 3) {
+			fmt = "range() take 1 to 3 integer arguments";
+			return lobject_error_argument(lemon, fmt);
+		}
+		for (i = 0; i < argc; i++) {
+			if (!lobject_is_integer(lemon, argv[i])) {
+				fmt = "range() take 1 to 3 integer arguments";
+				return lobject_error_argument(lemon, fmt);
+			}
+			if (!linteger_fit_long(lemon, argv[i])) {
+				fmt = "range() argument out of range";
+				return lobject_error_argument(lemon, fmt);
+			}
+			values[i] = linteger_to_long(lemon, argv[i]);
+		}
+
+		if (argc == 1) {
+			return lrange_create(lemon, 0, values[0], 1);
+		}
+		if (argc == 2) {
+			return lrange_create(lemon, values[0], values[1], 1);
+		}
+		if (values[2] == 0) {
+			fmt = "range() step must not be zero";
+			return lobject_error_argument(lemon, fmt);
+		}
+
+		return lrange_create(lemon, values[0], values[1], values[2]);
+	}
+
+	case LOBJECT_METHOD_CALLABLE:
+		return lemon->l_true;
+
+	default:
+		return lobject_default(lemon, self, method, argc, argv);
+	}
+}
+
+struct ltype *
+lrange_type_create(struct lemon *lemon)
+{
+	struct ltype *type;
+
+	type = ltype_create(lemon, "range", lrange_method, lrange_type_method);
+	if (type) {
+		lemon_add_global(lemon, "range", type);
+	}
+
+	return type;
+}
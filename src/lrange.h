@@ -0,0 +1,36 @@
+#ifndef LEMON_LRANGE_H
+#define LEMON_LRANGE_H
+
+#include "lobject.h"
+
+/*
+ * lazy integer sequence
+ *
+ *     range(stop);
+ *     range(start, stop);
+ *     range(start, stop, step);
+ *
+ * only `start', `stop' and `step' are stored, length, item, `in' and
+ * slice are computed, iterator yield smallint without allocation.
+ */
+struct lrange {
+	struct lobject object;
+
+	long start;
+	long stop;
+	long step; /* never 0 */
+};
+
+long
+lrange_length(struct lemon *lemon, struct lobject *self);
+
+struct lobject *
+lrange_to_array(struct lemon *lemon, struct lobject *self);
+
+void *
+lrange_create(struct lemon *lemon, long start, long stop, long step);
+
+struct ltype *
+lrange_type_create(struct lemon *lemon);
+
+#endif /* LEMON_LRANGE_H */
@@ -2,6 +2,7 @@
 #include "hash.h"
 #include "larray.h"
 #include "lstring.h"
+#include "lbuilder.h"
 #include "linteger.h"
 #include "literator.h"
 #include "lib/builtin.h"
@@ -10,6 +11,9 @@
 #include <stdio.h>
 #include <string.h>
 
+/* shorter piece is copied, cheaper than header and not pin big parent */
+#define LSTRING_VIEW_MIN 64
+
 static struct lobject *
 lstring_format_string_function(struct lemon *lemon,
                                struct lobject *self,
@@ -32,67 +36,63 @@ lstring_format_callback(struct lemon *lemon,
                         struct lframe *frame,
                         struct lobject *retval)
 {
-	int i;
-	int j;
-	int k;
-	int r;
+	long i;
+	long k;
 	long n;
-	long len;
-	long count;
+	long last;
 	struct lobject *item;
+	struct lobject *value;
 	struct lobject *array;
+	struct lobject *builder;
 	struct lstring *string;
-	struct lstring *newstring;
 
 	array = retval;
 	string = (struct lstring *)frame->self;
-
-	count = 0;
-	for (i = 0; i < string->length - 1; i++) {
-		if (string->buffer[i] == '{' &&
-		    string->buffer[i + 1] == '}')
-		{
-			count += 1;
-		}
-	}
-
 	n = larray_length(lemon, array);
-	if (count > n) {
-		return lobject_error_item(lemon,
-		                          "'%@' index out of range",
-		                          string);
-	}
 
-	len = string->length;
-	for (i = 0; i < n; i++) {
-		item = larray_get_item(lemon, array, i);
-		len = len - 2 + lstring_length(lemon, item);
+	builder = lbuilder_create(lemon, string->length);
+	if (!builder) {
+		return NULL;
 	}
 
-	j = 0;
 	k = 0;
-	newstring = lstring_create(lemon, NULL, len);
-	if (!newstring) {
-		return NULL;
-	}
+	last = 0;
 	for (i = 0; i < string->length - 1; i++) {
 		if (string->buffer[i] == '{' &&
 		    string->buffer[i + 1] == '}')
 		{
+			if (k >= n) {
+				return lobject_error_item(lemon,
+				                          "'%@' index out of range",
+				                          string);
+			}
+
+			/* copy literal run before `{}' in one append */
 			item = larray_get_item(lemon, array, k++);
-			memcpy(newstring->buffer + j,
-			       ((struct lstring *)item)->buffer,
-			       ((struct lstring *)item)->length);
-			j += ((struct lstring *)item)->length;
+			if (!lbuilder_append(lemon,
+			                     builder,
+			                     string->buffer + last,
+			                     i - last))
+			{
+				return NULL;
+			}
+			value = lbuilder_append_object(lemon, builder, item);
+			if (!value || lobject_is_error(lemon, value)) {
+				return value;
+			}
 			i += 1;
-		} else {
-			r = string->buffer[i];
-			newstring->buffer[j++] = (char)r;
+			last = i + 1;
 		}
 	}
-	newstring->buffer[j++] = string->buffer[i];
+	if (!lbuilder_append(lemon,
+	                     builder,
+	                     string->buffer + last,
+	                     string->length - last))
+	{
+		return NULL;
+	}
 
-	return (struct lobject *)newstring;
+	return lbuilder_string(lemon, builder);
 }
 
 static struct lobject *
@@ -139,12 +139,16 @@ lstring_join_array(struct lemon *lemon,
 {
 	long i;
 	long n;
-	long off;
 	long len;
 	struct lobject *item;
-	struct lstring *string;
+	struct lobject *value;
+	struct lobject *builder;
 
 	n = larray_length(lemon, array);
+	if (!n) {
+		return lemon->l_empty_string;
+	}
+
 	len = 0;
 	for (i = 0; i < n; i++) {
 		item = larray_get_item(lemon, array, i);
@@ -159,38 +163,27 @@ lstring_join_array(struct lemon *lemon,
 		len += ((struct lstring *)item)->length;
 	}
 	len += ((struct lstring *)join)->length * (n - 1);
-	string = lstring_create(lemon, NULL, len);
-	if (!string) {
+
+	builder = lbuilder_create(lemon, len);
+	if (!builder) {
 		return NULL;
 	}
-
-	off = 0;
 	for (i = 0; i < n; i++) {
-		item = larray_get_item(lemon, array, i);
-
-		if (off) {
-			memcpy(string->buffer + off,
-			       ((struct lstring *)join)->buffer,
-			       ((struct lstring *)join)->length);
-			off += ((struct lstring *)join)->length;
-
-			memcpy(string->buffer + off,
-			       ((struct lstring *)item)->buffer,
-			       ((struct lstring *)item)->length);
-			off += ((struct lstring *)item)->length;
-		} else {
-			memcpy(string->buffer + off,
-			       ((struct lstring *)item)->buffer,
-			       ((struct lstring *)item)->length);
-			off += ((struct lstring *)item)->length;
+		if (i) {
+			value = lbuilder_append_object(lemon, builder, join);
+			if (!value || lobject_is_error(lemon, value)) {
+				return value;
+			}
 		}
-	}
 
-	if (string) {
-		return (struct lobject *)string;
+		item = larray_get_item(lemon, array, i);
+		value = lbuilder_append_object(lemon, builder, item);
+		if (!value || lobject_is_error(lemon, value)) {
+			return value;
+		}
 	}
 
-	return lemon->l_empty_string;
+	return lbuilder_string(lemon, builder);
 }
 
 static struct lobject *
@@ -289,7 +282,7 @@ lstring_trim(struct lemon *lemon,
 		return lemon->l_empty_string;
 	}
 
-	return lstring_create(lemon, &string->buffer[i], j - i);
+	return lstring_create_view(lemon, self, i, j - i);
 }
 
 static struct lobject *
@@ -336,7 +329,7 @@ lstring_ltrim(struct lemon *lemon,
 		return lemon->l_empty_string;
 	}
 
-	return lstring_create(lemon, &string->buffer[i], string->length - i);
+	return lstring_create_view(lemon, self, i, string->length - i);
 }
 
 static struct lobject *
@@ -383,7 +376,7 @@ lstring_rtrim(struct lemon *lemon,
 		return lemon->l_empty_string;
 	}
 
-	return lstring_create(lemon, string->buffer, j);
+	return lstring_create_view(lemon, self, 0, j);
 }
 
 static struct lobject *
@@ -430,46 +423,139 @@ lstring_upper(struct lemon *lemon,
 	return (struct lobject *)newstring;
 }
 
+/*
+ * substring search
+ *
+ * single byte needle use `memchr' (libc's vectorized scanner), short needle
+ * use `memchr' to find candidate of first byte then `memcmp' rest bytes,
+ * long needle use Horspool's bad character skip, so mismatched window
+ * skip up to needle length bytes at once.
+ */
+#define LSTRING_SEARCH_HORSPOOL 8
+
+struct lstring_search {
+	const char *needle;
+	long length;
+	long skip[256];
+};
+
+static void
+lstring_search_init(struct lstring_search *search,
+                    const char *needle,
+                    long length)
+{
+	long i;
+
+	search->needle = needle;
+	search->length = length;
+	if (length < LSTRING_SEARCH_HORSPOOL) {
+		return;
+	}
+
+	for (i = 0; i < 256; i++) {
+		search->skip[i] = length;
+	}
+	for (i = 0; i < length - 1; i++) {
+		search->skip[(unsigned char)needle[i]] = length - 1 - i;
+	}
+}
+
+/*
+ * return offset of first needle in buffer[start, length) or -1
+ */
+static long
+lstring_search_next(struct lstring_search *search,
+                    const char *buffer,
+                    long start,
+                    long length)
+{
+	long i;
+	long last;
+	const char *p;
+	const char *needle;
+
+	needle = search->needle;
+	last = length - search->length;
+	if (search->length == 0) {
+		return start <= length ? start : -1;
+	}
+
+	if (search->length < LSTRING_SEARCH_HORSPOOL) {
+		i = start;
+		while (i <= last) {
+			p = memchr(buffer + i, needle[0], last - i + 1);
+			if (!p) {
+				return -1;
+			}
+			i = p - buffer;
+			if (memcmp(p + 1, needle + 1, search->length - 1) == 0) {
+				return i;
+			}
+			i += 1;
+		}
+
+		return -1;
+	}
+
+	i = start;
+	while (i <= last) {
+		p = buffer + i;
+		if (p[search->length - 1] == needle[search->length - 1] &&
+		    memcmp(p, needle, search->length - 1) == 0)
+		{
+			return i;
+		}
+		i += search->skip[(unsigned char)p[search->length - 1]];
+	}
+
+	return -1;
+}
+
+/*
+ * return offset of last needle in buffer[0, length) or -1
+ */
+static long
+lstring_search_prev(const char *buffer,
+                    long length,
+                    const char *needle,
+                    long nlength)
+{
+	long i;
+
+	for (i = length - nlength; i >= 0; i--) {
+		if (buffer[i] == needle[0] &&
+		    memcmp(buffer + i, needle, nlength) == 0)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
 static struct lobject *
 lstring_find(struct lemon *lemon,
              struct lobject *self,
              int argc, struct lobject *argv[])
 {
-	int i;
-	int c;
-	long len;
+	long i;
 	struct lstring *string;
 	struct lstring *substring;
+	struct lstring_search search;
 
 	if (argc && lobject_is_string(lemon, argv[0])) {
 		string = (struct lstring *)self;
 		substring = (struct lstring *)argv[0];
 
-		if (substring->length == 0) {
-			return linteger_create_from_long(lemon, 0);
-		}
+		lstring_search_init(&search,
+		                    substring->buffer,
+		                    substring->length);
+		i = lstring_search_next(&search,
+		                        string->buffer,
+		                        0,
+		                        string->length);
 
-		if (substring->length == 1) {
-			c = substring->buffer[0];
-			for (i = 0; i < string->length; i++) {
-				if (string->buffer[i] == c) {
-					return linteger_create_from_long(lemon,
-					                                 i);
-				}
-			}
-
-			return linteger_create_from_long(lemon, -1);
-		}
-
-		len = string->length - substring->length + 1;
-		for (i = 0; i < len; i++) {
-			if (strncmp(string->buffer + i,
-			            substring->buffer,
-			            substring->length) == 0)
-			{
-				return linteger_create_from_long(lemon, i);
-			}
-		}
+		return linteger_create_from_long(lemon, i);
 	}
 
 	return linteger_create_from_long(lemon, -1);
@@ -480,9 +566,7 @@ lstring_rfind(struct lemon *lemon,
               struct lobject *self,
               int argc, struct lobject *argv[])
 {
-	int c;
 	long i;
-	long len;
 	struct lstring *string;
 	struct lstring *substring;
 
@@ -494,27 +578,12 @@ lstring_rfind(struct lemon *lemon,
 			return linteger_create_from_long(lemon, 0);
 		}
 
-		if (substring->length == 1) {
-			c = substring->buffer[0];
-			for (i = string->length; i > 0; i--) {
-				if (string->buffer[i - 1] == c) {
-					return linteger_create_from_long(lemon,
-					                                 i - 1);
-				}
-			}
-
-			return linteger_create_from_long(lemon, -1);
-		}
+		i = lstring_search_prev(string->buffer,
+		                        string->length,
+		                        substring->buffer,
+		                        substring->length);
 
-		len = string->length - substring->length + 1;
-		for (i = len; i > 0; i--) {
-			if (strncmp(string->buffer + i - 1,
-			            substring->buffer,
-			            substring->length) == 0)
-			{
-				return linteger_create_from_long(lemon, i - 1);
-			}
-		}
+		return linteger_create_from_long(lemon, i);
 	}
 
 	return linteger_create_from_long(lemon, -1);
@@ -525,18 +594,13 @@ lstring_replace(struct lemon *lemon,
                 struct lobject *self,
                 int argc, struct lobject *argv[])
 {
-	int i;
-	int j;
-	int c;
-	int r;
-	int o;
-	long len;
-	long diff;
-	int count;
+	long i;
+	long j;
+	struct lobject *builder;
 	struct lstring *string;
 	struct lstring *substring;
 	struct lstring *repstring;
-	struct lstring *newstring;
+	struct lstring_search search;
 
 	if (argc == 2 &&
 	    lobject_is_string(lemon, argv[0]) &&
@@ -550,108 +614,50 @@ lstring_replace(struct lemon *lemon,
 			return self;
 		}
 
-		count = 0;
-		if (substring->length == 1) {
-			c = substring->buffer[0];
-			for (i = 0; i < string->length; i++) {
-				if (string->buffer[i] == c) {
-					count += 1;
-				}
-			}
-		} else {
-			len = string->length - substring->length + 1;
-			for (i = 0; i < len; i++) {
-				if (strncmp(string->buffer + i,
-				            substring->buffer,
-				            substring->length) == 0)
-				{
-					count += 1;
-				}
-			}
-		}
-		if (!count) {
+		lstring_search_init(&search,
+		                    substring->buffer,
+		                    substring->length);
+		i = lstring_search_next(&search,
+		                        string->buffer,
+		                        0,
+		                        string->length);
+		if (i < 0) {
 			return self;
 		}
 
-		diff = repstring->length - substring->length;
-		len = string->length + diff * count;
-		newstring = lstring_create(lemon, NULL, len);
-		if (!newstring) {
+		/* single pass, copy run between matches then replacement */
+		builder = lbuilder_create(lemon, string->length);
+		if (!builder) {
 			return NULL;
 		}
-
 		j = 0;
-		/* replace('x', 'y') */
-		if (substring->length == 1 && repstring->length == 1) {
-			c = substring->buffer[0];
-			r = repstring->buffer[0];
-			memcpy(newstring->buffer,
-			       string->buffer,
-			       string->length);
-			for (i = 0; i < newstring->length; i++) {
-				if (newstring->buffer[i] == c) {
-					newstring->buffer[j++] = (char)r;
-				} else {
-					o = string->buffer[i];
-					newstring->buffer[j++] = (char)o;
-				}
-			}
-
-		/* replace('x', 'yyy') */
-		} else if (substring->length == 1) {
-			c = substring->buffer[0];
-			for (i = 0; i < string->length; i++) {
-				if (string->buffer[i] == c) {
-					if (repstring->length >= 1) {
-						memcpy(newstring->buffer + j,
-						       repstring->buffer,
-						       repstring->length);
-						j += repstring->length;
-					}
-				} else {
-					o = string->buffer[i];
-					newstring->buffer[j++] = (char)o;
-				}
-			}
-
-		/* replace('xxx', 'y') */
-		} else if (repstring->length == 1) {
-			for (i = 0; i < string->length; i++) {
-				r = repstring->buffer[0];
-				if (string->length - i >= substring->length &&
-				    strncmp(string->buffer + i,
-				            substring->buffer,
-				            substring->length) == 0)
-				{
-					newstring->buffer[j++] = (char)r;
-					i += substring->length - 1;
-				} else {
-					o = string->buffer[i];
-					newstring->buffer[j++] = (char)o;
-				}
-			}
-
-		/* replace('xxx', 'yyy') */
-		} else {
-			for (i = 0; i < string->length; i++) {
-				if (string->length - i >= substring->length &&
-				    strncmp(string->buffer + i,
-				            substring->buffer,
-				            substring->length) == 0)
-				{
-					memcpy(newstring->buffer + j,
-					       repstring->buffer,
-					       repstring->length);
-					j += repstring->length;
-					i += substring->length - 1;
-				} else {
-					o = string->buffer[i];
-					newstring->buffer[j++] = (char)o;
-				}
+		while (i >= 0) {
+			if (!lbuilder_append(lemon,
+			                     builder,
+			                     string->buffer + j,
+			                     i - j) ||
+			    !lbuilder_append(lemon,
+			                     builder,
+			                     repstring->buffer,
+			                     repstring->length))
+			{
+				return NULL;
 			}
+			j = i + substring->length;
+			i = lstring_search_next(&search,
+			                        string->buffer,
+			                        j,
+			                        string->length);
+		}
+		if (!lbuilder_append(lemon,
+		                     builder,
+		                     string->buffer + j,
+		                     string->length - j))
+		{
+			return NULL;
 		}
 
-		return (struct lobject *)newstring;
+		return lbuilder_string(lemon, builder);
 	}
 
 	return lemon->l_nil;
@@ -662,15 +668,14 @@ lstring_split(struct lemon *lemon,
               struct lobject *self,
               int argc, struct lobject *argv[])
 {
-	int c;
 	long i;
 	long j;
 	long max;
-	long len;
 	struct lstring *string;
 	struct lstring *substring;
 	struct lobject *item;
 	struct lobject *array;
+	struct lstring_search search;
 
 	if (argc && lobject_is_string(lemon, argv[0])) {
 		string = (struct lstring *)self;
@@ -680,31 +685,26 @@ lstring_split(struct lemon *lemon,
 			return larray_create(lemon, 1, &self);
 		}
 
+		/* unlimited without `max', negative `max' split nothing */
+		max = -1;
 		if (argc == 2 && lobject_is_integer(lemon, argv[1])) {
 			max = linteger_to_long(lemon, argv[1]);
-		} else {
-			max = 0;
-			if (substring->length == 1) {
-				c = substring->buffer[0];
-				for (i = 0; i < string->length; i++) {
-					if (string->buffer[i] == c) {
-						max += 1;
-					}
-				}
-			} else {
-				len = string->length - substring->length + 1;
-				for (i = 0; i < len; i++) {
-					if (strncmp(string->buffer + i,
-					            substring->buffer,
-					            substring->length) == 0)
-					{
-						max += 1;
-					}
-				}
+			if (max < 0) {
+				max = 0;
 			}
 		}
 
-		if (max == 0) {
+		lstring_search_init(&search,
+		                    substring->buffer,
+		                    substring->length);
+		i = -1;
+		if (max) {
+			i = lstring_search_next(&search,
+			                        string->buffer,
+			                        0,
+			                        string->length);
+		}
+		if (i < 0) {
 			return larray_create(lemon, 1, &self);
 		}
 
@@ -713,52 +713,8 @@ lstring_split(struct lemon *lemon,
 			return NULL;
 		}
 		j = 0;
-		if (substring->length == 1) {
-			c = substring->buffer[0];
-			for (i = 0; i < string->length && max > 0; i++) {
-				if (string->buffer[i] != c) {
-					continue;
-				}
-				item = lstring_create(lemon,
-				                      string->buffer + j,
-				                      i - j);
-				if (!item) {
-					return NULL;
-				}
-				if (!larray_append(lemon, array, 1, &item)) {
-					return NULL;
-				}
-
-				j = i + 1;
-				max -= 1;
-			}
-
-			if (j < string->length) {
-				item = lstring_create(lemon,
-				                      string->buffer + j,
-				                      string->length - j);
-				if (!item) {
-					return NULL;
-				}
-				if (!larray_append(lemon, array, 1, &item)) {
-					return NULL;
-				}
-			}
-
-			return array;
-		}
-
-		len = string->length - substring->length + 1;
-		for (i = 0; i < len && max > 0; i++) {
-			if (strncmp(string->buffer + i,
-			            substring->buffer,
-			            substring->length) != 0)
-			{
-				continue;
-			}
-			item = lstring_create(lemon,
-			                      string->buffer + j,
-			                      i - j);
+		while (i >= 0 && max) {
+			item = lstring_create_view(lemon, self, j, i - j);
 			if (!item) {
 				return NULL;
 			}
@@ -766,13 +722,17 @@ lstring_split(struct lemon *lemon,
 				return NULL;
 			}
 			j = i + substring->length;
-			i = i + substring->length - 1;
 			max -= 1;
+			i = lstring_search_next(&search,
+			                        string->buffer,
+			                        j,
+			                        string->length);
 		}
 		if (j < string->length) {
-			item = lstring_create(lemon,
-			                      string->buffer + j,
-			                      string->length - j);
+			item = lstring_create_view(lemon,
+			                           self,
+			                           j,
+			                           string->length - j);
 			if (!item) {
 				return NULL;
 			}
@@ -908,6 +868,36 @@ lstring_has_item(struct lemon *lemon,
 	return lemon->l_true;
 }
 
+static struct lobject *
+lstring_iterator_next(struct lemon *lemon,
+                      struct lobject *iterable,
+                      struct lobject **context)
+{
+	long i;
+	struct lstring *string;
+
+	string = (struct lstring *)iterable;
+	i = linteger_to_long(lemon, *context);
+	if (i >= string->length) {
+		return lemon->l_sentinel;
+	}
+	*context = linteger_create_from_long(lemon, i + 1);
+
+	return lstring_create(lemon, string->buffer + i, 1);
+}
+
+static struct lobject *
+lstring_iterator(struct lemon *lemon,
+                 struct lobject *self,
+                 int argc, struct lobject *argv[])
+{
+	struct lobject *context;
+
+	context = linteger_create_from_long(lemon, 0);
+
+	return literator_create(lemon, self, context, lstring_iterator_next);
+}
+
 static struct lobject *
 lstring_get_attr(struct lemon *lemon,
                  struct lobject *self,
@@ -968,6 +958,10 @@ lstring_get_attr(struct lemon *lemon,
 		return lfunction_create(lemon, name, self, lstring_endswith);
 	}
 
+	if (strcmp(cstr, "__iterator__") == 0) {
+		return lfunction_create(lemon, name, self, lstring_iterator);
+	}
+
 	return NULL;
 }
 
@@ -998,11 +992,26 @@ lstring_get_slice(struct lemon *lemon,
 	if (istop < 0) {
 		istop = self->length + istop;
 	}
+	if (istart < 0) {
+		istart = 0;
+	}
+	if (istop > self->length) {
+		istop = self->length;
+	}
 	if (istart >= istop) {
 		return lemon->l_empty_string;
 	}
 
-	string = lstring_create(lemon, NULL, (istop - istart) / istep);
+	if (istep == 1) {
+		return lstring_create_view(lemon,
+		                           (struct lobject *)self,
+		                           istart,
+		                           istop - istart);
+	}
+
+	string = lstring_create(lemon,
+	                        NULL,
+	                        (istop - istart + istep - 1) / istep);
 	if (string) {
 		off = 0;
 		for (; istart < istop; istart += istep) {
@@ -1013,6 +1022,32 @@ lstring_get_slice(struct lemon *lemon,
 	return (struct lobject *)string;
 }
 
+static int
+lstring_compare(struct lstring *a, struct lstring *b)
+{
+	int r;
+	long n;
+
+	/* compare with length, view is not '\0' terminated */
+	n = a->length < b->length ? a->length : b->length;
+	r = memcmp(a->buffer, b->buffer, n);
+	if (r == 0 && a->length != b->length) {
+		return a->length < b->length ? -1 : 1;
+	}
+
+	return r;
+}
+
+static struct lobject *
+lstring_mark(struct lemon *lemon, struct lstring *self)
+{
+	if (self->parent) {
+		lobject_mark(lemon, self->parent);
+	}
+
+	return NULL;
+}
+
 static struct lobject *
 lstring_method(struct lemon *lemon,
                struct lobject *self,
@@ -1022,8 +1057,8 @@ lstring_method(struct lemon *lemon,
 
 #define cmpop(op) do {                                            \
 	if (lobject_is_string(lemon, argv[0])) {                  \
-		if (strcmp(lstring_to_cstr(lemon, self),          \
-		           lstring_to_cstr(lemon, argv[0])) op 0) \
+		if (lstring_compare(cast(self),                   \
+		                    cast(argv[0])) op 0)          \
 		{                                                 \
 			return lemon->l_true;                     \
 		}                                                 \
@@ -1088,6 +1123,9 @@ lstring_method(struct lemon *lemon,
 		}
 		return lemon->l_false;
 
+	case LOBJECT_METHOD_MARK:
+		return lstring_mark(lemon, cast(self));
+
 	case LOBJECT_METHOD_DESTROY:
 		return NULL;
 
@@ -1099,7 +1137,25 @@ lstring_method(struct lemon *lemon,
 const char *
 lstring_to_cstr(struct lemon *lemon, struct lobject *object)
 {
-	return ((struct lstring *)object)->buffer;
+	struct lstring *self;
+	struct lstring *string;
+
+	/*
+	 * view's buffer is inside parent's, and parent is '\0' terminated,
+	 * so byte after view is readable, flatten if it is not '\0'.
+	 */
+	self = (struct lstring *)object;
+	if (self->buffer[self->length] != '\0') {
+		string = lstring_create(lemon, self->buffer, self->length);
+		if (!string) {
+			return NULL;
+		}
+		self->buffer = string->buffer;
+		self->parent = (struct lobject *)string;
+		lemon_collector_barrierback(lemon, object, self->parent);
+	}
+
+	return self->buffer;
 }
 
 char *
@@ -1125,6 +1181,7 @@ lstring_create(struct lemon *lemon, const char *buffer, long length)
 	self = lobject_create(lemon, sizeof(*self) + length, lstring_method);
 	if (self) {
 		self->length = length;
+		self->buffer = self->data;
 
 		if (buffer) {
 			memcpy(self->buffer, buffer, length);
@@ -1135,6 +1192,35 @@ lstring_create(struct lemon *lemon, const char *buffer, long length)
 	return self;
 }
 
+void *
+lstring_create_view(struct lemon *lemon,
+                    struct lobject *string,
+                    long offset,
+                    long length)
+{
+	struct lstring *self;
+	struct lstring *parent;
+
+	parent = (struct lstring *)string;
+	if (offset == 0 && length == parent->length) {
+		return string;
+	}
+	if (length < LSTRING_VIEW_MIN) {
+		return lstring_create(lemon, parent->buffer + offset, length);
+	}
+
+	self = lobject_create(lemon, sizeof(*self), lstring_method);
+	if (self) {
+		self->length = length;
+		self->buffer = parent->buffer + offset;
+
+		/* view of view share root parent */
+		self->parent = parent->parent ? parent->parent : string;
+	}
+
+	return self;
+}
+
 static struct lobject *
 lstring_type_method(struct lemon *lemon,
                     struct lobject *self,
@@ -3,13 +3,19 @@
 
 #include "lobject.h"
 
+/*
+ * string view share `buffer' of `parent' instead of copy bytes into `data',
+ * view is not '\0' terminated, `lstring_to_cstr' flatten it when required.
+ */
 struct lstring {
 	struct lobject object;
 
 	long length;
+	char *buffer; /* point to `data' or `parent''s buffer */
+	struct lobject *parent; /* owner of `buffer' if view */
 
 	/* lstring is dynamic size */
-	char buffer[1];
+	char data[1];
 };
 
 const char *
@@ -24,6 +30,12 @@ lstring_length(struct lemon *lemon, struct lobject *object);
 void *
 lstring_create(struct lemon *lemon, const char *buffer, long length);
 
+void *
+lstring_create_view(struct lemon *lemon,
+                    struct lobject *string,
+                    long offset,
+                    long length);
+
 struct ltype *
 lstring_type_create(struct lemon *);
 
@@ -119,6 +119,10 @@ ltype_type_method(struct lemon *lemon,
 			return (struct lobject *)lemon->l_integer_type;
 		}
 
+		if (lobject_is_number(lemon, argv[0])) {
+			return (struct lobject *)lemon->l_number_type;
+		}
+
 		return lemon_get_type(lemon, argv[0]->l_method);
 	}
 
@@ -0,0 +1,1188 @@
+#include "lemon.h"
+#include "larray.h"
+#include "lnumber.h"
+#include "lstring.h"
+#include "lbuilder.h"
+#include "linteger.h"
+#include "literator.h"
+#include "ltypedarray.h"
+
+#include <stdio.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INT64(a) ((int64_t *)((struct ltypedarray *)(a))->items)
+#define FLOAT64(a) ((double *)((struct ltypedarray *)(a))->items)
+#define UINT8(a) ((uint8_t *)((struct ltypedarray *)(a))->items)
+
+/* byte size of items must fit in long */
+#define LTYPEDARRAY_MAX_LENGTH(kind) \
+	(LONG_MAX / (long)ltypedarray_item_size(kind))
+
+/*
+ * kernels are plain loops over contiguous items without call or branch
+ * in the body, leave compiler to vectorize them. integer kernels compute
+ * in uint64_t and wrap around on overflow like fixed width integer, only
+ * `sum' and `dot' promote to big integer.
+ */
+#define MAP(type, expr) do {                                  \
+	type *x = (type *)array->items;                       \
+	type *r = (type *)result->items;                      \
+	for (i = 0; i < array->length; i++) {                 \
+		r[i] = (type)(expr);                          \
+	}                                                     \
+} while (0)
+
+#define ZIP(type, expr) do {                                  \
+	type *x = (type *)array->items;                       \
+	type *y = (type *)other->items;                       \
+	type *r = (type *)result->items;                      \
+	for (i = 0; i < array->length; i++) {                 \
+		r[i] = (type)(expr);                          \
+	}                                                     \
+} while (0)
+
+static const char *
+ltypedarray_name(int kind)
+{
+	switch (kind) {
+	case LTYPEDARRAY_INT64:
+		return "int64array";
+	case LTYPEDARRAY_FLOAT64:
+		return "float64array";
+	default:
+		return "uint8array";
+	}
+}
+
+static size_t
+ltypedarray_item_size(int kind)
+{
+	switch (kind) {
+	case LTYPEDARRAY_INT64:
+		return sizeof(int64_t);
+	case LTYPEDARRAY_FLOAT64:
+		return sizeof(double);
+	default:
+		return sizeof(uint8_t);
+	}
+}
+
+static int
+ltypedarray_is_typedarray(struct lemon *lemon, struct lobject *object)
+{
+	if (lobject_is_pointer(lemon, object)) {
+		return object->l_method == lemon->l_int64array_type->method ||
+		       object->l_method == lemon->l_float64array_type->method ||
+		       object->l_method == lemon->l_uint8array_type->method;
+	}
+
+	return 0;
+}
+
+/*
+ * double to int64 is undefined out of range, saturate it and NaN is 0
+ */
+static int64_t
+ltypedarray_double_to_int64(double d)
+{
+	if (d != d) {
+		return 0;
+	}
+	if (d >= 9223372036854775808.0) {
+		return INT64_MAX;
+	}
+	if (d < -9223372036854775808.0) {
+		return INT64_MIN;
+	}
+
+	return (int64_t)d;
+}
+
+/*
+ * unbox integer or number to both integer and double, return 0 if not,
+ * `fit' is 0 if value is not exact or out of int64
+ */
+static int
+ltypedarray_unbox(struct lemon *lemon,
+                  struct lobject *object,
+                  int64_t *i,
+                  double *d,
+                  int *fit)
+{
+	struct lobject *string;
+
+	if (lobject_is_integer(lemon, object)) {
+		*fit = linteger_to_int64(lemon, object, i);
+		if (*fit) {
+			*d = (double)*i;
+		} else {
+			/* big integer to double by its decimal string */
+			string = lobject_string(lemon, object);
+			if (!string || !lobject_is_string(lemon, string)) {
+				return 0;
+			}
+			*d = strtod(lstring_to_cstr(lemon, string), NULL);
+		}
+
+		return 1;
+	}
+
+	if (lobject_is_number(lemon, object)) {
+		*d = lnumber_to_double(lemon, object);
+		*i = ltypedarray_double_to_int64(*d);
+		*fit = *d >= -9223372036854775808.0 &&
+		       *d < 9223372036854775808.0;
+
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * add `n' to big integer `total' (NULL is 0)
+ */
+static struct lobject *
+ltypedarray_spill(struct lemon *lemon, struct lobject *total, int64_t n)
+{
+	struct lobject *value;
+
+	value = linteger_create_from_int64(lemon, n);
+	if (!value || !total) {
+		return value;
+	}
+
+	return lobject_binop(lemon, LOBJECT_METHOD_ADD, total, value);
+}
+
+/*
+ * add `x * y' to big integer `total' (NULL is 0)
+ */
+static struct lobject *
+ltypedarray_spill_product(struct lemon *lemon,
+                          struct lobject *total,
+                          int64_t x,
+                          int64_t y)
+{
+	struct lobject *a;
+	struct lobject *b;
+	struct lobject *product;
+
+	a = linteger_create_from_int64(lemon, x);
+	b = linteger_create_from_int64(lemon, y);
+	if (!a || !b) {
+		return NULL;
+	}
+	product = lobject_binop(lemon, LOBJECT_METHOD_MUL, a, b);
+	if (!product || lobject_is_error(lemon, product) || !total) {
+		return product;
+	}
+
+	return lobject_binop(lemon, LOBJECT_METHOD_ADD, total, product);
+}
+
+struct lobject *
+ltypedarray_get_item(struct lemon *lemon, struct lobject *self, long i)
+{
+	struct ltypedarray *array;
+
+	array = (struct ltypedarray *)self;
+	if (i < 0) {
+		i = array->length + i;
+	}
+	if (i < 0 || i >= array->length) {
+		return lobject_error_item(lemon,
+		                          "'%@' index out of range",
+		                          self);
+	}
+
+	switch (array->kind) {
+	case LTYPEDARRAY_INT64:
+		return linteger_create_from_int64(lemon, INT64(array)[i]);
+	case LTYPEDARRAY_FLOAT64:
+		return lnumber_create_from_double(lemon, FLOAT64(array)[i]);
+	default:
+		return linteger_create_from_long(lemon, UINT8(array)[i]);
+	}
+}
+
+static struct lobject *
+ltypedarray_out_of_range(struct lemon *lemon, struct ltypedarray *array)
+{
+	return lobject_error_argument(lemon,
+	                              "'%@' value out of int64",
+	                              (struct lobject *)array);
+}
+
+struct lobject *
+ltypedarray_set_item(struct lemon *lemon,
+                     struct lobject *self,
+                     long i,
+                     struct lobject *value)
+{
+	int fit;
+	double d;
+	int64_t n;
+	struct ltypedarray *array;
+
+	array = (struct ltypedarray *)self;
+	if (i < 0) {
+		i = array->length + i;
+	}
+	if (i < 0 || i >= array->length) {
+		return lobject_error_item(lemon,
+		                          "'%@' index out of range",
+		                          self);
+	}
+	if (!ltypedarray_unbox(lemon, value, &n, &d, &fit)) {
+		return lobject_error_type(lemon,
+		                          "'%@' required number value",
+		                          self);
+	}
+	if (!fit && array->kind != LTYPEDARRAY_FLOAT64) {
+		return ltypedarray_out_of_range(lemon, array);
+	}
+
+	switch (array->kind) {
+	case LTYPEDARRAY_INT64:
+		INT64(array)[i] = n;
+		break;
+	case LTYPEDARRAY_FLOAT64:
+		FLOAT64(array)[i] = d;
+		break;
+	default:
+		/* wrap around modulo 256 like uint8array kernels */
+		UINT8(array)[i] = (uint8_t)n;
+		break;
+	}
+
+	return value;
+}
+
+static struct lobject *
+ltypedarray_sum(struct lemon *lemon,
+                struct lobject *self,
+                int argc, struct lobject *argv[])
+{
+	long i;
+	double d;
+	int64_t n;
+	int64_t x;
+	struct lobject *total;
+	struct ltypedarray *array;
+
+	array = (struct ltypedarray *)self;
+	switch (array->kind) {
+	case LTYPEDARRAY_INT64:
+		/* spill into big integer before overflow */
+		n = 0;
+		total = NULL;
+		for (i = 0; i < array->length; i++) {
+			x = INT64(array)[i];
+			if ((x > 0 && n > INT64_MAX - x) ||
+			    (x < 0 && n < INT64_MIN - x))
+			{
+				total = ltypedarray_spill(lemon, total, n);
+				if (!total || lobject_is_error(lemon, total)) {
+					return total;
+				}
+				n = 0;
+			}
+			n += x;
+		}
+		return ltypedarray_spill(lemon, total, n);
+
+	case LTYPEDARRAY_FLOAT64:
+		d = 0.0;
+		for (i = 0; i < array->length; i++) {
+			d += FLOAT64(array)[i];
+		}
+		return lnumber_create_from_double(lemon, d);
+
+	default:
+		n = 0;
+		for (i = 0; i < array->length; i++) {
+			n += UINT8(array)[i];
+		}
+		return linteger_create_from_int64(lemon, n);
+	}
+}
+
+static struct lobject *
+ltypedarray_minmax(struct lemon *lemon, struct ltypedarray *array, int max)
+{
+	long i;
+	long m;
+
+	if (!array->length) {
+		return lemon->l_nil;
+	}
+
+	/* find index of result, box only once */
+	m = 0;
+	switch (array->kind) {
+	case LTYPEDARRAY_INT64: {
+		int64_t *x = INT64(array);
+		for (i = 1; i < array->length; i++) {
+			if (max ? x[i] > x[m] : x[i] < x[m]) {
+				m = i;
+			}
+		}
+		break;
+	}
+
+	case LTYPEDARRAY_FLOAT64: {
+		double *x = FLOAT64(array);
+		for (i = 1; i < array->length; i++) {
+			if (max ? x[i] > x[m] : x[i] < x[m]) {
+				m = i;
+			}
+		}
+		break;
+	}
+
+	default: {
+		uint8_t *x = UINT8(array);
+		for (i = 1; i < array->length; i++) {
+			if (max ? x[i] > x[m] : x[i] < x[m]) {
+				m = i;
+			}
+		}
+		break;
+	}
+	}
+
+	return ltypedarray_get_item(lemon, (struct lobject *)array, m);
+}
+
+static struct lobject *
+ltypedarray_min(struct lemon *lemon,
+                struct lobject *self,
+                int argc, struct lobject *argv[])
+{
+	return ltypedarray_minmax(lemon, (struct ltypedarray *)self, 0);
+}
+
+static struct lobject *
+ltypedarray_max(struct lemon *lemon,
+                struct lobject *self,
+                int argc, struct lobject *argv[])
+{
+	return ltypedarray_minmax(lemon, (struct ltypedarray *)self, 1);
+}
+
+/*
+ * return `argv[0]' if it is same kind and length typedarray or NULL
+ */
+static struct ltypedarray *
+ltypedarray_other(struct lemon *lemon,
+                  struct lobject *self,
+                  int argc, struct lobject *argv[])
+{
+	struct ltypedarray *other;
+
+	if (argc != 1 || !ltypedarray_is_typedarray(lemon, argv[0])) {
+		return NULL;
+	}
+
+	other = (struct ltypedarray *)argv[0];
+	if (other->kind != ((struct ltypedarray *)self)->kind ||
+	    other->length != ((struct ltypedarray *)self)->length)
+	{
+		return NULL;
+	}
+
+	return other;
+}
+
+static struct lobject *
+ltypedarray_dot(struct lemon *lemon,
+                struct lobject *self,
+                int argc, struct lobject *argv[])
+{
+	long i;
+	double d;
+	int64_t n;
+	int64_t x;
+	int64_t y;
+	struct lobject *total;
+	struct ltypedarray *array;
+	struct ltypedarray *other;
+
+	array = (struct ltypedarray *)self;
+	other = ltypedarray_other(lemon, self, argc, argv);
+	if (!other) {
+		const char *fmt;
+
+		fmt = "'%@' required same kind and length array";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	switch (array->kind) {
+	case LTYPEDARRAY_INT64:
+		/*
+		 * product of 32 bits items is exact in int64, others and
+		 * overflowed sum spill into big integer
+		 */
+		n = 0;
+		total = NULL;
+		for (i = 0; i < array->length; i++) {
+			x = INT64(array)[i];
+			y = INT64(other)[i];
+			if (x < INT32_MIN || x > INT32_MAX ||
+			    y < INT32_MIN || y > INT32_MAX)
+			{
+				total = ltypedarray_spill_product(lemon,
+				                                  total,
+				                                  x,
+				                                  y);
+				if (!total || lobject_is_error(lemon, total)) {
+					return total;
+				}
+				continue;
+			}
+
+			x = x * y;
+			if ((x > 0 && n > INT64_MAX - x) ||
+			    (x < 0 && n < INT64_MIN - x))
+			{
+				total = ltypedarray_spill(lemon, total, n);
+				if (!total || lobject_is_error(lemon, total)) {
+					return total;
+				}
+				n = 0;
+			}
+			n += x;
+		}
+		return ltypedarray_spill(lemon, total, n);
+
+	case LTYPEDARRAY_FLOAT64:
+		d = 0.0;
+		for (i = 0; i < array->length; i++) {
+			d += FLOAT64(array)[i] * FLOAT64(other)[i];
+		}
+		return lnumber_create_from_double(lemon, d);
+
+	default:
+		n = 0;
+		for (i = 0; i < array->length; i++) {
+			n += (int64_t)UINT8(array)[i] * UINT8(other)[i];
+		}
+		return linteger_create_from_int64(lemon, n);
+	}
+}
+
+static struct lobject *
+ltypedarray_scale(struct lemon *lemon,
+                  struct lobject *self,
+                  int argc, struct lobject *argv[])
+{
+	long i;
+	int fit;
+	double d;
+	int64_t n;
+	struct ltypedarray *array;
+	struct ltypedarray *result;
+
+	array = (struct ltypedarray *)self;
+	if (argc != 1 || !ltypedarray_unbox(lemon, argv[0], &n, &d, &fit) ||
+	    (!fit && lobject_is_integer(lemon, argv[0]) &&
+	     array->kind != LTYPEDARRAY_FLOAT64))
+	{
+		const char *fmt;
+
+		fmt = "'%@' accept 1 number argument in int64";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	result = ltypedarray_create(lemon, array->kind, array->length);
+	if (!result) {
+		return NULL;
+	}
+
+	switch (array->kind) {
+	case LTYPEDARRAY_INT64:
+		if (lobject_is_integer(lemon, argv[0])) {
+			MAP(int64_t, (uint64_t)x[i] * (uint64_t)n);
+		} else {
+			MAP(int64_t, ltypedarray_double_to_int64(x[i] * d));
+		}
+		break;
+
+	case LTYPEDARRAY_FLOAT64:
+		MAP(double, x[i] * d);
+		break;
+
+	default:
+		if (lobject_is_integer(lemon, argv[0])) {
+			MAP(uint8_t, x[i] * (uint64_t)n);
+		} else {
+			MAP(uint8_t, ltypedarray_double_to_int64(x[i] * d));
+		}
+		break;
+	}
+
+	return (struct lobject *)result;
+}
+
+static struct lobject *
+ltypedarray_add(struct lemon *lemon,
+                struct lobject *self,
+                int argc, struct lobject *argv[])
+{
+	long i;
+	int fit;
+	double d;
+	int64_t n;
+	struct ltypedarray *array;
+	struct ltypedarray *other;
+	struct ltypedarray *result;
+
+	array = (struct ltypedarray *)self;
+	other = ltypedarray_other(lemon, self, argc, argv);
+	if (!other &&
+	    (argc != 1 || !ltypedarray_unbox(lemon, argv[0], &n, &d, &fit) ||
+	     (!fit && array->kind != LTYPEDARRAY_FLOAT64)))
+	{
+		const char *fmt;
+
+		fmt = "'%@' required number in int64 or same kind and length "
+		      "array";
+		return lobject_error_argument(lemon, fmt, self);
+	}
+
+	result = ltypedarray_create(lemon, array->kind, array->length);
+	if (!result) {
+		return NULL;
+	}
+
+	switch (array->kind) {
+	case LTYPEDARRAY_INT64:
+		if (other) {
+			ZIP(int64_t, (uint64_t)x[i] + (uint64_t)y[i]);
+		} else {
+			MAP(int64_t, (uint64_t)x[i] + (uint64_t)n);
+		}
+		break;
+
+	case LTYPEDARRAY_FLOAT64:
+		if (other) {
+			ZIP(double, x[i] + y[i]);
+		} else {
+			MAP(double, x[i] + d);
+		}
+		break;
+
+	default:
+		if (other) {
+			ZIP(uint8_t, x[i] + y[i]);
+		} else {
+			MAP(uint8_t, x[i] + (uint64_t)n);
+		}
+		break;
+	}
+
+	return (struct lobject *)result;
+}
+
+static struct lobject *
+ltypedarray_toarray(struct lemon *lemon,
+                    struct lobject *self,
+                    int argc, struct lobject *argv[])
+{
+	long i;
+	struct lobject *item;
+	struct lobject *array;
+
+	array = larray_create(lemon, 0, NULL);
+	if (!array) {
+		return NULL;
+	}
+	for (i = 0; i < ((struct ltypedarray *)self)->length; i++) {
+		item = ltypedarray_get_item(lemon, self, i);
+		if (!item || !larray_append(lemon, array, 1, &item)) {
+			return NULL;
+		}
+	}
+
+	return array;
+}
+
+static struct lobject *
+ltypedarray_iterator_next(struct lemon *lemon,
+                          struct lobject *iterable,
+                          struct lobject **context)
+{
+	long i;
+	struct ltypedarray *array;
+
+	array = (struct ltypedarray *)iterable;
+	if (array == NULL) {
+		return lemon->l_nil;
+	}
+
+	i = linteger_to_long(lemon, *context);
+	if (i >= array->length) {
+		return lemon->l_sentinel;
+	}
+	*context = linteger_create_from_long(lemon, i + 1);
+
+	return ltypedarray_get_item(lemon, iterable, i);
+}
+
+static struct lobject *
+ltypedarray_iterator(struct lemon *lemon,
+                     struct lobject *self,
+                     int argc, struct lobject *argv[])
+{
+	struct lobject *context;
+
+	context = linteger_create_from_long(lemon, 0);
+
+	return literator_create(lemon,
+	                        self,
+	                        context,
+	                        ltypedarray_iterator_next);
+}
+
+static struct lobject *
+ltypedarray_get_attr(struct lemon *lemon,
+                     struct lobject *self,
+                     struct lobject *name)
+{
+	const char *cstr;
+
+	cstr = lstring_to_cstr(lemon, name);
+	if (strcmp(cstr, "sum") == 0) {
+		return lfunction_create(lemon, name, self, ltypedarray_sum);
+	}
+
+	if (strcmp(cstr, "min") == 0) {
+		return lfunction_create(lemon, name, self, ltypedarray_min);
+	}
+
+	if (strcmp(cstr, "max") == 0) {
+		return lfunction_create(lemon, name, self, ltypedarray_max);
+	}
+
+	if (strcmp(cstr, "dot") == 0) {
+		return lfunction_create(lemon, name, self, ltypedarray_dot);
+	}
+
+	if (strcmp(cstr, "scale") == 0) {
+		return lfunction_create(lemon, name, self, ltypedarray_scale);
+	}
+
+	if (strcmp(cstr, "add") == 0) {
+		return lfunction_create(lemon, name, self, ltypedarray_add);
+	}
+
+	if (strcmp(cstr, "toarray") == 0) {
+		return lfunction_create(lemon, name, self, ltypedarray_toarray);
+	}
+
+	if (strcmp(cstr, "__iterator__") == 0) {
+		return lfunction_create(lemon,
+		                        name,
+		                        self,
+		                        ltypedarray_iterator);
+	}
+
+	return NULL;
+}
+
+static struct lobject *
+ltypedarray_get_slice(struct lemon *lemon,
+                      struct ltypedarray *self,
+                      struct lobject *start,
+                      struct lobject *stop,
+                      struct lobject *step)
+{
+	long i;
+	long istart;
+	long istop;
+	long istep;
+	size_t size;
+	struct lobject *item;
+	struct ltypedarray *slice;
+
+	istart = linteger_to_long(lemon, start);
+	if (stop == lemon->l_nil) {
+		istop = self->length;
+	} else {
+		istop = linteger_to_long(lemon, stop);
+	}
+	istep = linteger_to_long(lemon, step);
+
+	if (istart < 0) {
+		istart = self->length + istart;
+	}
+	if (istop < 0) {
+		istop = self->length + istop;
+	}
+	if (istart < 0) {
+		istart = 0;
+	}
+	if (istop > self->length) {
+		istop = self->length;
+	}
+	if (istart > istop) {
+		istart = istop;
+	}
+	if (istep < 1) {
+		istep = 1;
+	}
+
+	/* continuous slice share items with parent */
+	if (istep == 1) {
+		slice = lobject_create(lemon,
+		                       sizeof(*slice),
+		                       ((struct lobject *)self)->l_method);
+		if (slice) {
+			size = ltypedarray_item_size(self->kind);
+			slice->kind = self->kind;
+			slice->length = istop - istart;
+			slice->items = (char *)self->items + size * istart;
+			if (self->parent) {
+				slice->parent = self->parent;
+			} else {
+				slice->parent = (struct lobject *)self;
+			}
+		}
+
+		return (struct lobject *)slice;
+	}
+
+	slice = ltypedarray_create(lemon,
+	                           self->kind,
+	                           (istop - istart + istep - 1) / istep);
+	if (slice) {
+		for (i = 0; istart < istop; istart += istep) {
+			item = ltypedarray_get_item(lemon,
+			                            (struct lobject *)self,
+			                            istart);
+			if (!item) {
+				return NULL;
+			}
+			ltypedarray_set_item(lemon, (struct lobject *)slice, i++, item);
+		}
+	}
+
+	return (struct lobject *)slice;
+}
+
+static struct lobject *
+ltypedarray_string(struct lemon *lemon, struct ltypedarray *self)
+{
+	long i;
+	const char *name;
+	struct lobject *item;
+	struct lobject *builder;
+
+	builder = lbuilder_create(lemon, 0);
+	if (!builder) {
+		return NULL;
+	}
+
+	name = ltypedarray_name(self->kind);
+	if (!lbuilder_append(lemon, builder, name, strlen(name)) ||
+	    !lbuilder_append(lemon, builder, "([", 2))
+	{
+		return NULL;
+	}
+	for (i = 0; i < self->length; i++) {
+		if (i && !lbuilder_append(lemon, builder, ", ", 2)) {
+			return NULL;
+		}
+
+		item = ltypedarray_get_item(lemon, (struct lobject *)self, i);
+		if (!item || !lbuilder_append_object(lemon, builder, item)) {
+			return NULL;
+		}
+	}
+	if (!lbuilder_append(lemon, builder, "])", 2)) {
+		return NULL;
+	}
+
+	return lbuilder_string(lemon, builder);
+}
+
+static struct lobject *
+ltypedarray_mark(struct lemon *lemon, struct ltypedarray *self)
+{
+	if (self->parent) {
+		lobject_mark(lemon, self->parent);
+	}
+
+	return NULL;
+}
+
+static struct lobject *
+ltypedarray_destroy(struct lemon *lemon, struct ltypedarray *self)
+{
+	if (!self->parent) {
+		lemon_allocator_free(lemon, self->items);
+	}
+
+	return NULL;
+}
+
+static struct lobject *
+ltypedarray_method(struct lemon *lemon,
+                   struct lobject *self,
+                   int method, int argc, struct lobject *argv[])
+{
+#define cast(a) ((struct ltypedarray *)(a))
+
+	switch (method) {
+	case LOBJECT_METHOD_GET_ITEM:
+		if (lobject_is_integer(lemon, argv[0])) {
+			long i = linteger_to_long(lemon, argv[0]);
+			return ltypedarray_get_item(lemon, self, i);
+		}
+		return NULL;
+
+	case LOBJECT_METHOD_SET_ITEM:
+		if (lobject_is_integer(lemon, argv[0])) {
+			long i = linteger_to_long(lemon, argv[0]);
+			return ltypedarray_set_item(lemon, self, i, argv[1]);
+		}
+		return NULL;
+
+	case LOBJECT_METHOD_GET_ATTR:
+		return ltypedarray_get_attr(lemon, self, argv[0]);
+
+	case LOBJECT_METHOD_GET_SLICE:
+		return ltypedarray_get_slice(lemon,
+		                             cast(self),
+		                             argv[0],
+		                             argv[1],
+		                             argv[2]);
+
+	case LOBJECT_METHOD_STRING:
+		return ltypedarray_string(lemon, cast(self));
+
+	case LOBJECT_METHOD_LENGTH:
+		return linteger_create_from_long(lemon, cast(self)->length);
+
+	case LOBJECT_METHOD_BOOLEAN:
+		if (cast(self)->length) {
+			return lemon->l_true;
+		}
+		return lemon->l_false;
+
+	case LOBJECT_METHOD_MARK:
+		return ltypedarray_mark(lemon, cast(self));
+
+	case LOBJECT_METHOD_DESTROY:
+		return ltypedarray_destroy(lemon, cast(self));
+
+	default:
+		return lobject_default(lemon, self, method, argc, argv);
+	}
+}
+
+/*
+ * every kind has own method make `type()' and `instanceof' distinguish
+ * them, they all forward to `ltypedarray_method'.
+ */
+static struct lobject *
+ltypedarray_int64_method(struct lemon *lemon,
+                         struct lobject *self,
+                         int method, int argc, struct lobject *argv[])
+{
+	return ltypedarray_method(lemon, self, method, argc, argv);
+}
+
+static struct lobject *
+ltypedarray_float64_method(struct lemon *lemon,
+                           struct lobject *self,
+                           int method, int argc, struct lobject *argv[])
+{
+	return ltypedarray_method(lemon, self, method, argc, argv);
+}
+
+static struct lobject *
+ltypedarray_uint8_method(struct lemon *lemon,
+                         struct lobject *self,
+                         int method, int argc, struct lobject *argv[])
+{
+	return ltypedarray_method(lemon, self, method, argc, argv);
+}
+
+void *
+ltypedarray_create(struct lemon *lemon, int kind, long length)
+{
+	size_t size;
+	lobject_method_t method;
+	struct ltypedarray *self;
+
+	switch (kind) {
+	case LTYPEDARRAY_INT64:
+		method = ltypedarray_int64_method;
+		break;
+	case LTYPEDARRAY_FLOAT64:
+		method = ltypedarray_float64_method;
+		break;
+	default:
+		method = ltypedarray_uint8_method;
+		break;
+	}
+
+	self = lobject_create(lemon, sizeof(*self), method);
+	if (self) {
+		self->kind = kind;
+		self->length = length;
+		if (length > LTYPEDARRAY_MAX_LENGTH(kind)) {
+			return NULL;
+		}
+		if (length) {
+			size = ltypedarray_item_size(kind) * length;
+			self->items = lemon_allocator_alloc(lemon, size);
+			if (!self->items) {
+				return NULL;
+			}
+			memset(self->items, 0, size);
+		}
+	}
+
+	return self;
+}
+
+static struct lobject *
+ltypedarray_create_from_array(struct lemon *lemon,
+                              int kind,
+                              struct lobject *array)
+{
+	long i;
+	long n;
+	struct lobject *item;
+	struct lobject *self;
+
+	n = larray_length(lemon, array);
+	self = ltypedarray_create(lemon, kind, n);
+	if (!self) {
+		return NULL;
+	}
+	for (i = 0; i < n; i++) {
+		item = larray_get_item(lemon, array, i);
+		item = ltypedarray_set_item(lemon, self, i, item);
+		if (!item || lobject_is_error(lemon, item)) {
+			return item;
+		}
+	}
+
+	return self;
+}
+
+/*
+ * convert between kinds without box, same rule as `set_item'
+ */
+static struct lobject *
+ltypedarray_convert(struct lemon *lemon, int kind, struct ltypedarray *from)
+{
+	long i;
+	int fit;
+	double d;
+	int64_t n;
+	struct ltypedarray *array;
+
+	array = ltypedarray_create(lemon, kind, from->length);
+	if (!array) {
+		return NULL;
+	}
+	if (kind == from->kind) {
+		memcpy(array->items,
+		       from->items,
+		       ltypedarray_item_size(kind) * from->length);
+
+		return (struct lobject *)array;
+	}
+
+	for (i = 0; i < from->length; i++) {
+		switch (from->kind) {
+		case LTYPEDARRAY_INT64:
+			n = INT64(from)[i];
+			d = (double)n;
+			fit = 1;
+			break;
+		case LTYPEDARRAY_FLOAT64:
+			d = FLOAT64(from)[i];
+			n = ltypedarray_double_to_int64(d);
+			fit = d >= -9223372036854775808.0 &&
+			      d < 9223372036854775808.0;
+			break;
+		default:
+			n = UINT8(from)[i];
+			d = (double)n;
+			fit = 1;
+			break;
+		}
+
+		switch (kind) {
+		case LTYPEDARRAY_INT64:
+			if (!fit) {
+				return ltypedarray_out_of_range(lemon, array);
+			}
+			INT64(array)[i] = n;
+			break;
+		case LTYPEDARRAY_FLOAT64:
+			FLOAT64(array)[i] = d;
+			break;
+		default:
+			if (!fit) {
+				return ltypedarray_out_of_range(lemon, array);
+			}
+			UINT8(array)[i] = (uint8_t)n;
+			break;
+		}
+	}
+
+	return (struct lobject *)array;
+}
+
+static int
+ltypedarray_type_kind(struct lemon *lemon, struct lobject *type)
+{
+	if ((struct ltype *)type == lemon->l_int64array_type) {
+		return LTYPEDARRAY_INT64;
+	}
+	if ((struct ltype *)type == lemon->l_float64array_type) {
+		return LTYPEDARRAY_FLOAT64;
+	}
+
+	return LTYPEDARRAY_UINT8;
+}
+
+static struct lobject *
+ltypedarray_create_callback(struct lemon *lemon,
+                            struct lframe *frame,
+                            struct lobject *retval)
+{
+	int kind;
+
+	kind = ltypedarray_type_kind(lemon, frame->self);
+	if (!lobject_is_array(lemon, retval)) {
+		return retval;
+	}
+
+	return ltypedarray_create_from_array(lemon, kind, retval);
+}
+
+static struct lobject *
+ltypedarray_type_method(struct lemon *lemon,
+                        struct lobject *self,
+                        int method, int argc, struct lobject *argv[])
+{
+	switch (method) {
+	case LOBJECT_METHOD_CALL: {
+		int kind;
+		long length;
+		struct lframe *frame;
+
+		kind = ltypedarray_type_kind(lemon, self);
+		if (!argc) {
+			return ltypedarray_create(lemon, kind, 0);
+		}
+
+		/* int64array(n) is n zeros */
+		if (lobject_is_integer(lemon, argv[0])) {
+			length = linteger_to_long(lemon, argv[0]);
+			if (length < 0) {
+				length = 0;
+			}
+			if (length > LTYPEDARRAY_MAX_LENGTH(kind)) {
+				const char *fmt;
+				const char *name;
+
+				fmt = "%s() length too large";
+				name = ltypedarray_name(kind);
+				return lobject_error_argument(lemon, fmt, name);
+			}
+
+			return ltypedarray_create(lemon, kind, length);
+		}
+
+		if (lobject_is_array(lemon, argv[0])) {
+			return ltypedarray_create_from_array(lemon,
+			                                     kind,
+			                                     argv[0]);
+		}
+
+		if (ltypedarray_is_typedarray(lemon, argv[0])) {
+			struct ltypedarray *from;
+
+			from = (struct ltypedarray *)argv[0];
+			return ltypedarray_convert(lemon, kind, from);
+		}
+
+		/* other iterable, collect by callback */
+		frame = lemon_machine_push_new_frame(lemon,
+		                                     self,
+		                                     NULL,
+		                                     ltypedarray_create_callback,
+		                                     0);
+		if (!frame) {
+			return NULL;
+		}
+
+		return literator_to_array(lemon, argv[0], 0);
+	}
+
+	case LOBJECT_METHOD_CALLABLE:
+		return lemon->l_true;
+
+	default:
+		return lobject_default(lemon, self, method, argc, argv);
+	}
+}
+
+struct ltype *
+ltypedarray_int64_type_create(struct lemon *lemon)
+{
+	struct ltype *type;
+
+	type = ltype_create(lemon,
+	                    "int64array",
+	                    ltypedarray_int64_method,
+	                    ltypedarray_type_method);
+	if (type) {
+		lemon_add_global(lemon, "int64array", type);
+	}
+
+	return type;
+}
+
+struct ltype *
+ltypedarray_float64_type_create(struct lemon *lemon)
+{
+	struct ltype *type;
+
+	type = ltype_create(lemon,
+	                    "float64array",
+	                    ltypedarray_float64_method,
+	                    ltypedarray_type_method);
+	if (type) {
+		lemon_add_global(lemon, "float64array", type);
+	}
+
+	return type;
+}
+
+struct ltype *
+ltypedarray_uint8_type_create(struct lemon *lemon)
+{
+	struct ltype *type;
+
+	type = ltype_create(lemon,
+	                    "uint8array",
+	                    ltypedarray_uint8_method,
+	                    ltypedarray_type_method);
+	if (type) {
+		lemon_add_global(lemon, "uint8array", type);
+	}
+
+	return type;
+}
@@ -0,0 +1,51 @@
+#ifndef LEMON_LTYPEDARRAY_H
+#define LEMON_LTYPEDARRAY_H
+
+#include "lobject.h"
+
+/*
+ * packed array of unboxed numbers
+ *
+ *     var a = float64array([1.5, 2.5, 3.0]);
+ *     a.sum();
+ *     a[1:].scale(2.0);
+ *
+ * slice share `items' of `parent', set item of slice also change parent.
+ */
+enum {
+	LTYPEDARRAY_INT64,
+	LTYPEDARRAY_FLOAT64,
+	LTYPEDARRAY_UINT8
+};
+
+struct ltypedarray {
+	struct lobject object;
+
+	int kind;
+	long length;
+	void *items; /* owned or inside `parent''s items */
+	struct lobject *parent; /* owner of `items' if slice */
+};
+
+struct lobject *
+ltypedarray_get_item(struct lemon *lemon, struct lobject *self, long i);
+
+struct lobject *
+ltypedarray_set_item(struct lemon *lemon,
+                     struct lobject *self,
+                     long i,
+                     struct lobject *value);
+
+void *
+ltypedarray_create(struct lemon *lemon, int kind, long length);
+
+struct ltype *
+ltypedarray_int64_type_create(struct lemon *lemon);
+
+struct ltype *
+ltypedarray_float64_type_create(struct lemon *lemon);
+
+struct ltype *
+ltypedarray_uint8_type_create(struct lemon *lemon);
+
+#endif /* LEMON_LTYPEDARRAY_H */
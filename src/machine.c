@@ -8,6 +8,7 @@
 #include "lvkarg.h"
 #include "larray.h"
 #include "lclass.h"
+#include "lcode.h"
 #include "lsuper.h"
 #include "lmodule.h"
 #include "lstring.h"
@@ -33,24 +34,16 @@ machine_create(struct lemon *lemon)
 	machine->fp = -1;
 	machine->sp = -1;
 
-	machine->codelen = 4096;
-	machine->cpoollen = 256;
 	machine->framelen = 256;
 	machine->stacklen = 256;
+	machine->globallen = 64;
 
-	size = sizeof(unsigned char) * machine->codelen;
-	machine->code = allocator_alloc(lemon, size);
-	if (!machine->code) {
+	size = sizeof(struct lobject *) * machine->globallen;
+	machine->globals = allocator_alloc(lemon, size);
+	if (!machine->globals) {
 		return NULL;
 	}
-	memset(machine->code, 0, size);
-
-	size = sizeof(struct lobject *) * machine->cpoollen;
-	machine->cpool = allocator_alloc(lemon, size);
-	if (!machine->cpool) {
-		return NULL;
-	}
-	memset(machine->cpool, 0, size);
+	memset(machine->globals, 0, size);
 
 	size = sizeof(struct lframe *) * machine->framelen;
 	machine->frame = allocator_alloc(lemon, size);
@@ -72,8 +65,7 @@ machine_create(struct lemon *lemon)
 void
 machine_destroy(struct lemon *lemon, struct machine *machine)
 {
-	allocator_free(lemon, machine->code);
-	allocator_free(lemon, machine->cpool);
+	allocator_free(lemon, machine->globals);
 	allocator_free(lemon, machine->frame);
 	allocator_free(lemon, machine->stack);
 	allocator_free(lemon, machine);
@@ -91,82 +83,6 @@ lemon_machine_reset(struct lemon *lemon)
 	machine_reset(lemon);
 }
 
-int
-machine_add_code1(struct lemon *lemon, int value)
-{
-	int location;
-	struct machine *machine;
-
-	machine = lemon->l_machine;
-	if (machine->pc + 1 >= machine->codelen) {
-		size_t size;
-
-		size = sizeof(unsigned char) * machine->codelen * 2;
-		machine->code = allocator_realloc(lemon, machine->code, size);
-		if (!machine->code) {
-			return 0;
-		}
-
-		machine->codelen *= 2;
-	}
-
-	location = machine->pc;
-	machine_set_code1(lemon, location, value);
-	machine->pc += 1;
-
-	return location;
-}
-
-int
-machine_set_code1(struct lemon *lemon, int location, int opcode)
-{
-	struct machine *machine;
-
-	machine = lemon->l_machine;
-	machine->code[location] = (unsigned char)opcode;
-
-	return location;
-}
-
-int
-machine_add_code4(struct lemon *lemon, int value)
-{
-	int location;
-	struct machine *machine;
-
-	machine = lemon->l_machine;
-	if (machine->pc + 4 >= machine->codelen) {
-		size_t size;
-
-		size = sizeof(unsigned char) * machine->codelen * 2;
-		machine->code = allocator_realloc(lemon, machine->code, size);
-		if (!machine->code) {
-			return 0;
-		}
-
-		machine->codelen *= 2;
-	}
-	location = machine->pc;
-	machine_set_code4(lemon, location, value);
-	machine->pc += 4;
-
-	return location;
-}
-
-int
-machine_set_code4(struct lemon *lemon, int location, int value)
-{
-	struct machine *machine;
-
-	machine = lemon->l_machine;
-	machine->code[location + 0] = (unsigned char)((value >> 24) & 0xFF);
-	machine->code[location + 1] = (unsigned char)((value >> 16) & 0xFF);
-	machine->code[location + 2] = (unsigned char)((value >> 8)  & 0xFF);
-	machine->code[location + 3] = (unsigned char)(value         & 0xFF);
-
-	return location;
-}
-
 int
 machine_fetch_code1(struct lemon *lemon)
 {
@@ -209,42 +125,36 @@ machine_fetch_code4(struct lemon *lemon)
 }
 
 int
-machine_add_const(struct lemon *lemon, struct lobject *object)
+machine_add_global(struct lemon *lemon, struct lobject *object)
 {
-	int i;
+	int globallen;
 	struct machine *machine;
+	struct lobject **globals;
 
 	machine = lemon->l_machine;
-	for (i = 0; i < machine->cpoollen; i++) {
-		if (machine->cpool[i] == NULL) {
-			machine->cpool[i] = object;
-
-			return i;
-		}
-
-		if (object == machine->cpool[i]) {
-			return i;
-		}
-
-		if (lobject_is_pointer(lemon, object) &&
-		    lobject_is_pointer(lemon, machine->cpool[i]) &&
-		    object->l_method == machine->cpool[i]->l_method &&
-		    lobject_is_equal(lemon, object, machine->cpool[i]))
-		{
-			return i;
+	if (machine->nglobals == machine->globallen) {
+		globallen = machine->globallen * 2;
+		globals = allocator_realloc(lemon,
+		                            machine->globals,
+		                            sizeof(*globals) * globallen);
+		if (!globals) {
+			return -1;
 		}
+		machine->globals = globals;
+		machine->globallen = globallen;
 	}
+	machine->globals[machine->nglobals] = object;
 
-	return 0;
+	return machine->nglobals++;
 }
 
 struct lobject *
-machine_get_const(struct lemon *lemon, int pool)
+machine_get_global(struct lemon *lemon, int global)
 {
 	struct machine *machine;
 
 	machine = lemon->l_machine;
-	return machine->cpool[pool];
+	return machine->globals[global];
 }
 
 struct lobject *
@@ -318,6 +228,62 @@ lemon_machine_set_ra(struct lemon *lemon, int ra)
 	}
 }
 
+struct lobject *
+lemon_machine_get_rc(struct lemon *lemon)
+{
+	struct machine *machine;
+
+	machine = lemon->l_machine;
+	if (machine->fp >= 1) {
+		return machine->frame[1]->code;
+	}
+
+	return machine->lcode;
+}
+
+void
+lemon_machine_set_rc(struct lemon *lemon, struct lobject *code)
+{
+	struct machine *machine;
+
+	machine = lemon->l_machine;
+	if (machine->fp >= 1) {
+		machine->frame[1]->code = code;
+		lemon_collector_barrier(lemon,
+		                        (struct lobject *)machine->frame[1],
+		                        code);
+	}
+}
+
+struct lobject *
+lemon_machine_get_code(struct lemon *lemon)
+{
+	struct machine *machine;
+
+	machine = lemon->l_machine;
+	return machine->lcode;
+}
+
+void
+lemon_machine_set_code(struct lemon *lemon, struct lobject *code)
+{
+	struct lcode *lcode;
+	struct machine *machine;
+
+	machine = lemon->l_machine;
+	machine->lcode = code;
+	if (code) {
+		lcode = (struct lcode *)code;
+		machine->code = lcode->code;
+		machine->cpool = lcode->cpool;
+		machine->maxpc = lcode->length;
+	} else {
+		machine->code = NULL;
+		machine->cpool = NULL;
+		machine->maxpc = 0;
+	}
+}
+
 int
 lemon_machine_get_pc(struct lemon *lemon)
 {
@@ -460,6 +426,30 @@ lemon_machine_pop_object(struct lemon *lemon)
 	return machine_pop_object(lemon);
 }
 
+/*
+ * frame stack grow by doubling like operand stack, halt if out of memory
+ */
+static int
+machine_extend_frame(struct lemon *lemon)
+{
+	size_t size;
+	struct machine *machine;
+	struct lframe **frame;
+
+	machine = lemon->l_machine;
+	size = sizeof(struct lframe *) * machine->framelen * 2;
+	frame = allocator_realloc(lemon, machine->frame, size);
+	if (!frame) {
+		machine_frame_overflow(lemon);
+
+		return 0;
+	}
+	machine->frame = frame;
+	machine->framelen *= 2;
+
+	return 1;
+}
+
 struct lframe *
 machine_push_new_frame(struct lemon *lemon,
                        struct lobject *self,
@@ -471,19 +461,19 @@ machine_push_new_frame(struct lemon *lemon,
 	struct machine *machine;
 
 	machine = lemon->l_machine;
-	if (machine->fp < machine->framelen) {
-		frame = lframe_create(lemon, self, callee, callback, nlocals);
-		if (frame) {
-			machine_store_frame(lemon, frame);
-			machine_push_frame(lemon, frame);
-		}
-
-		return frame;
+	if (machine->fp == machine->framelen - 1 &&
+	    !machine_extend_frame(lemon))
+	{
+		return NULL;
 	}
 
-	machine_frame_overflow(lemon);
+	frame = lframe_create(lemon, self, callee, callback, nlocals);
+	if (frame) {
+		machine_store_frame(lemon, frame);
+		machine_push_frame(lemon, frame);
+	}
 
-	return NULL;
+	return frame;
 }
 
 struct lframe *
@@ -496,6 +486,47 @@ lemon_machine_push_new_frame(struct lemon *lemon,
 	return machine_push_new_frame(lemon, self, callee, callback, nlocals);
 }
 
+/*
+ * depth of frame stack exceed `lemon->l_recursion'
+ */
+struct lobject *
+machine_check_recursion(struct lemon *lemon)
+{
+	int limit;
+	struct lframe *frame;
+	struct machine *machine;
+	struct lobject *error;
+
+	machine = lemon->l_machine;
+	limit = lemon->l_recursion;
+	if (limit > 0 && machine->fp + 1 >= limit) {
+		/*
+		 * create exception call its class with frames, no callback
+		 * frame stop returning into caller's callback frames
+		 */
+		frame = machine_push_new_frame(lemon, NULL, NULL, NULL, 0);
+		if (!frame) {
+			return NULL;
+		}
+		lemon->l_recursion = 0;
+		error = lobject_error_runtime(lemon,
+		                              "maximum recursion depth %d",
+		                              limit);
+		machine_restore_frame(lemon, machine_pop_frame(lemon));
+		lemon->l_recursion = limit;
+
+		return error;
+	}
+
+	return NULL;
+}
+
+struct lobject *
+lemon_machine_check_recursion(struct lemon *lemon)
+{
+	return machine_check_recursion(lemon);
+}
+
 struct lobject *
 machine_return_frame(struct lemon *lemon, struct lobject *retval)
 {
@@ -539,9 +570,8 @@ machine_push_frame(struct lemon *lemon, struct lframe *frame)
 	machine = lemon->l_machine;
 	if (machine->fp < machine->framelen - 1) {
 		machine->frame[++machine->fp] = frame;
-	} else {
-		printf("frame overflow\n");
-		machine->halt = 1;
+	} else if (machine_extend_frame(lemon)) {
+		machine->frame[++machine->fp] = frame;
 	}
 }
 
@@ -601,6 +631,8 @@ machine_store_frame(struct lemon *lemon, struct lframe *frame)
 	machine = lemon->l_machine;
 	frame->sp = machine->sp;
 	frame->ra = machine->pc;
+	frame->code = machine->lcode;
+	lemon_collector_barrier(lemon, (struct lobject *)frame, frame->code);
 }
 
 void
@@ -617,6 +649,9 @@ machine_restore_frame(struct lemon *lemon, struct lframe *frame)
 	machine = lemon->l_machine;
 	machine->sp = frame->sp;
 	machine->pc = frame->ra;
+	if (frame->code != machine->lcode) {
+		lemon_machine_set_code(lemon, frame->code);
+	}
 }
 
 void
@@ -625,6 +660,77 @@ lemon_machine_restore_frame(struct lemon *lemon, struct lframe *frame)
 	machine_restore_frame(lemon, frame);
 }
 
+/*
+ * slot of parameter `key', -1 if not found
+ *
+ * `params' is layout of function locals, keyword name and parameter
+ * name compiled in one module are same constant, compare address first
+ */
+static int
+machine_parse_args_slot(struct lemon *lemon,
+                        int nparams,
+                        struct lobject *params[],
+                        struct lobject *key)
+{
+	int i;
+
+	for (i = 0; i < nparams; i++) {
+		if (params[i] == key) {
+			return i;
+		}
+	}
+
+	for (i = 0; i < nparams; i++) {
+		if (lobject_is_equal(lemon, params[i], key)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * check required args and set default value of rest locals
+ */
+static struct lobject *
+machine_parse_args_check(struct lemon *lemon,
+                         struct lobject *callee,
+                         struct lframe *frame,
+                         int nvalues,
+                         int nparams)
+{
+	int i;
+	const char *fmt;
+
+	/* check required args */
+	for (i = 0; i < nparams - nvalues; i++) {
+		if (frame->locals[i] == NULL) {
+			fmt = "%@() takes %d arguments (%d given)";
+			return lobject_error_argument(lemon,
+			                              fmt,
+			                              callee,
+			                              nparams,
+			                              i);
+		}
+	}
+
+	/* set sentinel for optional args */
+	for (; i < nparams; i++) {
+		if (frame->locals[i] == NULL) {
+			frame->locals[i] = lemon->l_sentinel;
+		}
+	}
+
+	/* set nil for non args */
+	for (; i < frame->nlocals; i++) {
+		if (frame->locals[i] == NULL) {
+			frame->locals[i] = lemon->l_nil;
+		}
+	}
+
+	return NULL;
+}
+
 struct lobject *
 lemon_machine_parse_args(struct lemon *lemon,
                     struct lobject *callee,
@@ -635,10 +741,36 @@ lemon_machine_parse_args(struct lemon *lemon,
                     struct lobject *params[],
                     int argc,
                     struct lobject *argv[])
+{
+	return lemon_machine_parse_kargs(lemon,
+	                                 callee,
+	                                 frame,
+	                                 define,
+	                                 nvalues,
+	                                 nparams,
+	                                 params,
+	                                 argc,
+	                                 argv,
+	                                 NULL);
+}
+
+struct lobject *
+lemon_machine_parse_kargs(struct lemon *lemon,
+                          struct lobject *callee,
+                          struct lframe *frame,
+                          int define,
+                          int nvalues,
+                          int nparams,
+                          struct lobject *params[],
+                          int argc,
+                          struct lobject *argv[],
+                          struct lobject *keywords)
 {
 	int i;
 	int a; /* index of argv */
+	int k; /* index of frame->locals for keyword */
 	int local; /* index of frame->locals */
+	int nargs; /* number of argv before keyword values */
 	const char *fmt; /* error format string */
 
 	struct lobject *key;
@@ -648,13 +780,13 @@ lemon_machine_parse_args(struct lemon *lemon,
 	struct lobject *v_arg;
 	struct lobject *v_args;
 
-	int x_argc;
-	struct lobject *x_argv[256];
-	struct lobject *x_args;
+	struct lobject *x_args; /* array of extra arguments */
+	struct lobject *x_kargs; /* dictionary of extra keyword arguments */
 
-	int x_kargc;
-	struct lobject *x_kargv[512];
-	struct lobject *x_kargs;
+	nargs = argc;
+	if (keywords) {
+		nargs -= larray_length(lemon, keywords);
+	}
 
 	/* too many arguments */
 	if (define == 0 && argc > nparams) {
@@ -666,6 +798,28 @@ lemon_machine_parse_args(struct lemon *lemon,
 		                              argc);
 	}
 
+	/* fixed arity positional call, copy args straight into locals */
+	if (define == 0 && nargs == argc) {
+		for (a = 0; a < argc; a++) {
+			arg = argv[a];
+			if (lobject_is_karg(lemon, arg) ||
+			    lobject_is_varg(lemon, arg) ||
+			    lobject_is_vkarg(lemon, arg))
+			{
+				break;
+			}
+			lframe_set_item(lemon, frame, a, arg);
+		}
+
+		if (a == argc) {
+			return machine_parse_args_check(lemon,
+			                                callee,
+			                                frame,
+			                                nvalues,
+			                                nparams);
+		}
+	}
+
 	/* remove not assignable params */
 	if (define == 1) {
 		nparams -= 1;
@@ -679,17 +833,32 @@ lemon_machine_parse_args(struct lemon *lemon,
 		return NULL;
 	}
 
+	x_args = NULL;
+	if (define == 1 || define == 3) {
+		x_args = larray_create(lemon, 0, NULL);
+		if (!x_args) {
+			return NULL;
+		}
+	}
+
+	x_kargs = NULL;
+	if (define == 2 || define == 3) {
+		x_kargs = ldictionary_create(lemon, 0, NULL);
+		if (!x_kargs) {
+			return NULL;
+		}
+	}
+
 #define machine_parse_args_set_arg(arg) do {                \
 	if (local < nparams) {                              \
 		lframe_set_item(lemon,                      \
 		                frame,                      \
 		                local++,                    \
 		                (arg));                     \
-	} else if (define == 1 || define == 3) {            \
-		if (x_argc == 256) {                        \
+	} else if (x_args) {                                \
+		if (!larray_append(lemon, x_args, 1, &(arg))) { \
 			return NULL;                        \
 		}                                           \
-		x_argv[x_argc++] = (arg);                   \
 	} else {                                            \
 		fmt = "%@() takes %d arguments (%d given)"; \
 		return lobject_error_argument(lemon,        \
@@ -701,21 +870,16 @@ lemon_machine_parse_args(struct lemon *lemon,
 } while (0)
 
 #define machine_parse_args_set_karg(key, arg) do {                      \
-	int j;                                                          \
-	int k = -1;                                                     \
-	for (j = 0; j < nparams; j++) {                                 \
-		if (lobject_is_equal(lemon, params[j], key)) {          \
-			k = j;                                          \
-			break;                                          \
-		}                                                       \
-	}                                                               \
+	k = machine_parse_args_slot(lemon, nparams, params, (key));     \
 	if (k < 0) {                                                    \
-		if (define == 2 || define == 3) {                       \
-			if (x_kargc == 512) {                           \
+		if (x_kargs) {                                          \
+			if (!lobject_set_item(lemon,                    \
+			                      x_kargs,                  \
+			                      (key),                    \
+			                      (arg)))                   \
+			{                                               \
 				return NULL;                            \
 			}                                               \
-			x_kargv[x_kargc++] = (key);                     \
-			x_kargv[x_kargc++] = (arg);                     \
 		} else {                                                \
 			fmt = "'%@'() don't have parameter '%@'";       \
 			return lobject_error_argument(lemon,            \
@@ -736,9 +900,8 @@ lemon_machine_parse_args(struct lemon *lemon,
 } while (0)
 
 	local = 0;
-	x_argc = 0;
 	for (a = 0;
-	     a < argc &&
+	     a < nargs &&
 	     !lobject_is_karg(lemon, argv[a]) &&
 	     !lobject_is_varg(lemon, argv[a]) &&
 	     !lobject_is_vkarg(lemon, argv[a]);
@@ -747,7 +910,7 @@ lemon_machine_parse_args(struct lemon *lemon,
 		machine_parse_args_set_arg(argv[a]);
 	}
 
-	if (a < argc && lobject_is_varg(lemon, argv[a])) {
+	if (a < nargs && lobject_is_varg(lemon, argv[a])) {
 		v_args = ((struct lvarg *)argv[a++])->arguments;
 
 		if (!lobject_is_array(lemon, v_args)) {
@@ -762,15 +925,21 @@ lemon_machine_parse_args(struct lemon *lemon,
 		}
 	}
 
-	x_kargc = 0;
-	for (; a < argc && lobject_is_karg(lemon, argv[a]); a++) {
+	for (; a < nargs && lobject_is_karg(lemon, argv[a]); a++) {
 		key = ((struct lkarg *)argv[a])->keyword;
 		arg = ((struct lkarg *)argv[a])->argument;
 
 		machine_parse_args_set_karg(key, arg);
 	}
 
-	if (a < argc && lobject_is_vkarg(lemon, argv[a])) {
+	/* keyword values of `callkw' are last of argv */
+	for (i = 0; i < argc - nargs; i++) {
+		key = larray_get_item(lemon, keywords, i);
+
+		machine_parse_args_set_karg(key, argv[nargs + i]);
+	}
+
+	if (a < nargs && lobject_is_vkarg(lemon, argv[a])) {
 		v_args = lobject_map_item(lemon, argv[a]);
 
 		assert(lobject_is_array(lemon, v_args));
@@ -790,46 +959,19 @@ lemon_machine_parse_args(struct lemon *lemon,
 	}
 
 	if (define == 1) {
-		x_args = larray_create(lemon, x_argc, x_argv);
 		lframe_set_item(lemon, frame, nparams, x_args);
 	} else if (define == 2) {
-		x_kargs = ldictionary_create(lemon, x_kargc, x_kargv);
 		lframe_set_item(lemon, frame, nparams, x_kargs);
 	} else if (define == 3) {
-		x_args = larray_create(lemon, x_argc, x_argv);
 		lframe_set_item(lemon, frame, nparams++, x_args);
-
-		x_kargs = ldictionary_create(lemon, x_kargc, x_kargv);
 		lframe_set_item(lemon, frame, nparams, x_kargs);
 	}
 
-	/* check required args */
-	for (i = 0; i < nparams - nvalues; i++) {
-		if (lframe_get_item(lemon, frame, i) == NULL) {
-			fmt = "%@() takes %d arguments (%d given)";
-			return lobject_error_argument(lemon,
-			                              fmt,
-			                              callee,
-			                              nparams,
-			                              i);
-		}
-	}
-
-	/* set sentinel for optional args */
-	for (; i < nparams; i++) {
-		if (lframe_get_item(lemon, frame, i) == NULL) {
-			lframe_set_item(lemon, frame, i, lemon->l_sentinel);
-		}
-	}
-
-	/* set nil for non args */
-	for (; i < frame->nlocals; i++) {
-		if (lframe_get_item(lemon, frame, i) == NULL) {
-			lframe_set_item(lemon, frame, i, lemon->l_nil);
-		}
-	}
-
-	return NULL;
+	return machine_parse_args_check(lemon,
+	                                callee,
+	                                frame,
+	                                nvalues,
+	                                nparams);
 }
 
 struct lframe *
@@ -947,7 +1089,11 @@ machine_throw(struct lemon *lemon, struct lobject *exception)
 		}
 		machine_pop_frame(lemon);
 		machine_restore_frame(lemon, frame);
-		argv[argc++] = (struct lobject *)frame;
+
+		/* deep recursion only trace innermost frames */
+		if (argc < 128) {
+			argv[argc++] = (struct lobject *)frame;
+		}
 	}
 
 	printf("Uncaught Exception: ");
@@ -1087,6 +1233,196 @@ machine_varg_iterable(struct lemon *lemon, struct lobject *iterable)
 	return literator_to_array(lemon, iterable, 256);
 }
 
+/*
+ * C function called by `call' opcode without frame, if C function
+ * re-enter machine (push frame to call Lemon function), insert the frame
+ * it would have below the pushed frames, return value passing through it
+ */
+struct lobject *
+machine_call_native(struct lemon *lemon,
+                    struct lobject *callee,
+                    int argc, struct lobject *argv[])
+{
+	int i;
+	int fp;
+	int sp;
+	int pc;
+	struct lobject *code;
+	struct lobject *retval;
+	struct lframe *frame;
+	struct lfunction *function;
+	struct machine *machine;
+
+	machine = lemon->l_machine;
+	fp = machine->fp;
+	sp = machine->sp;
+	pc = machine->pc;
+	code = machine->lcode;
+
+	function = (struct lfunction *)callee;
+	retval = function->callback(lemon, function->self, argc, argv);
+	if (machine->fp == fp) {
+		return retval;
+	}
+
+	if (machine->fp == machine->framelen - 1 &&
+	    !machine_extend_frame(lemon))
+	{
+		return NULL;
+	}
+	frame = lframe_create(lemon,
+	                      NULL,
+	                      callee,
+	                      lframe_default_callback,
+	                      0);
+	if (!frame) {
+		return NULL;
+	}
+	frame->sp = sp;
+	frame->ra = pc;
+	frame->code = code;
+	lemon_collector_barrier(lemon, (struct lobject *)frame, code);
+
+	for (i = machine->fp; i > fp; i--) {
+		machine->frame[i + 1] = machine->frame[i];
+	}
+	machine->frame[fp + 1] = frame;
+	machine->fp += 1;
+
+	return retval;
+}
+
+/*
+ * running frame is reused by tail call if it's a Lemon function's frame
+ * nothing else reference and callee's locals fit in
+ */
+static int
+machine_tailcall_reusable(struct lemon *lemon,
+                          struct lframe *frame,
+                          struct lobject *callee)
+{
+	struct lfunction *function;
+
+	if (frame->captured ||
+	    frame->callback ||
+	    !lobject_is_function(lemon, frame->callee) ||
+	    !lobject_is_function(lemon, callee))
+	{
+		return 0;
+	}
+
+	function = (struct lfunction *)callee;
+	if (function->callback) {
+		return 0;
+	}
+
+	/* compile error is reported by normal call */
+	if (function->lazy && !function->address) {
+		if (!lemon_compile_lazy(lemon, function)) {
+			return 0;
+		}
+	}
+
+	return function->address > 0 && function->nlocals <= frame->nlocals;
+}
+
+/*
+ * overwrite running frame with callee and jump to its address,
+ * frame keep caller's return address, return exception of binding
+ */
+static struct lobject *
+machine_tailcall(struct lemon *lemon,
+                 struct lframe *frame,
+                 struct lobject *callee,
+                 int argc, struct lobject *argv[])
+{
+	int i;
+	struct machine *machine;
+	struct lobject *exception;
+	struct lfunction *function;
+
+	machine = lemon->l_machine;
+	function = (struct lfunction *)callee;
+
+	/* drop operands of replaced function */
+	machine->sp = frame->sp;
+
+	frame->ea = 0;
+	frame->self = function->self;
+	frame->callee = callee;
+	frame->upframe = function->frame;
+	if (frame->self) {
+		lemon_collector_barrier(lemon, (struct lobject *)frame,
+		                        frame->self);
+	}
+	lemon_collector_barrier(lemon, (struct lobject *)frame, callee);
+	if (frame->upframe) {
+		lemon_collector_barrier(lemon, (struct lobject *)frame,
+		                        (struct lobject *)frame->upframe);
+	}
+	for (i = 0; i < frame->nlocals; i++) {
+		frame->locals[i] = NULL;
+	}
+
+	exception = lemon_machine_parse_args(lemon,
+	                                     callee,
+	                                     frame,
+	                                     function->define,
+	                                     function->nvalues,
+	                                     function->nparams,
+	                                     function->params,
+	                                     argc,
+	                                     argv);
+	if (exception) {
+		return exception;
+	}
+
+	if (function->code != machine->lcode) {
+		lemon_machine_set_code(lemon, function->code);
+	}
+	machine->pc = function->address;
+
+	return NULL;
+}
+
+/*
+ * Lemon function bind keyword values directly,
+ * other callee take lkarg as `call' opcode
+ */
+struct lobject *
+machine_call_keyword(struct lemon *lemon,
+                     struct lobject *callee,
+                     int argc, struct lobject *argv[],
+                     struct lobject *keywords)
+{
+	int i;
+	int nargs;
+	struct lobject *karg;
+
+	if (lobject_is_function(lemon, callee) &&
+	    !((struct lfunction *)callee)->callback)
+	{
+		return lfunction_call_keyword(lemon,
+		                              callee,
+		                              argc,
+		                              argv,
+		                              keywords);
+	}
+
+	nargs = argc - larray_length(lemon, keywords);
+	for (i = nargs; i < argc; i++) {
+		karg = lkarg_create(lemon,
+		                    larray_get_item(lemon, keywords, i - nargs),
+		                    argv[i]);
+		if (!karg || lobject_is_error(lemon, karg)) {
+			return karg;
+		}
+		argv[i] = karg;
+	}
+
+	return lobject_call(lemon, callee, argc, argv);
+}
+
 struct lobject *
 machine_call_getter(struct lemon *lemon,
                struct lobject *getter,
@@ -1713,6 +2049,72 @@ lemon_machine_execute_loop(struct lemon *lemon)
 			break;
 		}
 
+		case OPCODE_INLINE: {
+			int entry;
+			int address;
+			struct lfunction *function;
+
+			/*
+			 * pop function and run inlined body if top is
+			 * unbound function of `entry' in running code
+			 * object, else keep it and jump to normal call
+			 */
+			CHECK_FETCH(8);
+			entry = FETCH_CODE4();
+			address = FETCH_CODE4();
+			CHECK_STACK(1);
+			a = machine->stack[machine->sp];
+			function = (struct lfunction *)a;
+			if (lobject_is_function(lemon, a) &&
+			    function->address == entry &&
+			    function->code == machine->lcode &&
+			    !function->self)
+			{
+				machine->sp -= 1;
+			} else {
+				machine->pc = address;
+			}
+			break;
+		}
+
+		case OPCODE_FORITER: {
+			int exit;
+			int local;
+			int address;
+			struct literator *iterator;
+
+			/*
+			 * advance native iterator in `local' and push item
+			 * without `__next__', jump to `exit' if exhausted,
+			 * jump to `address' (`__next__' call) for others
+			 */
+			CHECK_FETCH(9);
+			local = FETCH_CODE1();
+			address = FETCH_CODE4();
+			exit = FETCH_CODE4();
+			frame = machine_peek_frame(lemon);
+			a = lframe_get_item(lemon, frame, local);
+			iterator = (struct literator *)a;
+			if (!lobject_is_iterator(lemon, a) || !iterator->next) {
+				machine->pc = address;
+				break;
+			}
+
+			c = iterator->next(lemon,
+			                   iterator->iterable,
+			                   &iterator->context);
+			if (!c) {
+				machine_out_of_memory(lemon);
+			} else if (lobject_is_error(lemon, c)) {
+				CHECK_ERROR(c);
+			} else if (c == lemon->l_sentinel) {
+				machine->pc = exit;
+			} else {
+				PUSH_OBJECT(c);
+			}
+			break;
+		}
+
 		case OPCODE_ARRAY: {
 			size_t size;
 			struct lobject **items;
@@ -1799,7 +2201,9 @@ lemon_machine_execute_loop(struct lemon *lemon)
 			CHECK_NULL(function);
 			CHECK_ERROR((struct lobject *)function);
 
+			function->code = machine->lcode;
 			function->frame = machine_peek_frame(lemon);
+			function->frame->captured = 1;
 			PUSH_OBJECT((struct lobject *)function);
 
 			machine = lemon->l_machine;
@@ -1807,6 +2211,53 @@ lemon_machine_execute_loop(struct lemon *lemon)
 			break;
 		}
 
+		case OPCODE_LAZY: {
+			int define;
+			int nvalues;
+			int nparams;
+			int record;
+
+			struct lobject *lazy;
+			struct lobject *name;
+			struct lobject **params;
+			struct lfunction *function;
+
+			CHECK_FETCH(7);
+			define = FETCH_CODE1();
+			nvalues = FETCH_CODE1();
+			nparams = FETCH_CODE1();
+			record = FETCH_CODE4();
+
+			CHECK_STACK(2);
+			lazy = POP_OBJECT();
+			lazy = larray_get_item(lemon, lazy, record);
+			name = POP_OBJECT();
+
+			CHECK_STACK(nparams);
+			params = argv;
+			for (i = nparams; i > 0; i--) {
+				params[i - 1] = POP_OBJECT();
+			}
+
+			/* `address' is 0 until body compiled at first call */
+			function = lfunction_create_with_address(lemon,
+			                                         name,
+			                                         define,
+			                                         0,
+			                                         nparams,
+			                                         nvalues,
+			                                         0,
+			                                         params);
+			CHECK_NULL(function);
+			CHECK_ERROR((struct lobject *)function);
+
+			function->lazy = lazy;
+			function->frame = machine_peek_frame(lemon);
+			function->frame->captured = 1;
+			PUSH_OBJECT((struct lobject *)function);
+			break;
+		}
+
 		case OPCODE_KARG: {
 			CHECK_STACK(2);
 			b = POP_OBJECT();
@@ -1853,7 +2304,41 @@ lemon_machine_execute_loop(struct lemon *lemon)
 			}
 
 			a = POP_OBJECT();
-			c = lobject_call(lemon, a, argc, argv);
+			if (lobject_is_function(lemon, a) &&
+			    ((struct lfunction *)a)->callback &&
+			    !((struct lfunction *)a)->framed)
+			{
+				i = machine->fp;
+				c = machine_call_native(lemon, a, argc, argv);
+				CHECK_NULL(c);
+				CHECK_ERROR(c);
+				if (c &&
+				    machine->fp == i &&
+				    !lobject_is_error(lemon, c))
+				{
+					PUSH_OBJECT(c);
+					break;
+				}
+			} else {
+				c = lobject_call(lemon, a, argc, argv);
+				CHECK_NULL(c);
+				CHECK_ERROR(c);
+			}
+			POP_CALLBACK_FRAME(c);
+			break;
+		}
+
+		case OPCODE_CALLKW: {
+			CHECK_FETCH(5);
+			argc = FETCH_CODE1();
+			b = machine->cpool[FETCH_CODE4()];
+			CHECK_STACK(argc);
+			for (i = 0; i < argc; i++) {
+				argv[i] = POP_OBJECT();
+			}
+
+			a = POP_OBJECT();
+			c = machine_call_keyword(lemon, a, argc, argv, b);
 			CHECK_NULL(c);
 			CHECK_ERROR(c);
 			POP_CALLBACK_FRAME(c);
@@ -1873,6 +2358,19 @@ lemon_machine_execute_loop(struct lemon *lemon)
 
 			/* pop the function */
 			a = POP_OBJECT();
+			frame = machine_peek_frame(lemon);
+			if (machine_tailcall_reusable(lemon, frame, a)) {
+				c = machine_tailcall(lemon,
+				                     frame,
+				                     a,
+				                     argc,
+				                     argv);
+				if (c) {
+					CHECK_ERROR(c);
+				}
+				break;
+			}
+
 			c = lobject_call(lemon, a, argc, argv);
 			/*
 			 * make sure callee is a Lemon function
@@ -1882,6 +2380,7 @@ lemon_machine_execute_loop(struct lemon *lemon)
 				newframe = machine_pop_frame(lemon);
 				oldframe = machine_pop_frame(lemon);
 				newframe->ra = oldframe->ra;
+				newframe->code = oldframe->code;
 				machine_push_frame(lemon, newframe);
 			}
 
@@ -2250,6 +2749,19 @@ machine_disassemble(struct lemon *lemon)
 			printf("jmp %d\n", a);
 			break;
 
+		case OPCODE_INLINE:
+			a = machine_fetch_code4(lemon);
+			b = machine_fetch_code4(lemon);
+			printf("inline %d %d\n", a, b);
+			break;
+
+		case OPCODE_FORITER:
+			a = machine_fetch_code1(lemon);
+			b = machine_fetch_code4(lemon);
+			c = machine_fetch_code4(lemon);
+			printf("foriter %d %d %d\n", a, b, c);
+			break;
+
 		case OPCODE_ARRAY:
 			printf("array %d\n", machine_fetch_code4(lemon));
 			break;
@@ -2267,6 +2779,14 @@ machine_disassemble(struct lemon *lemon)
 			printf("define %d %d %d %d %d\n", a, b, c, d, e);
 			break;
 
+		case OPCODE_LAZY:
+			a = machine_fetch_code1(lemon);
+			b = machine_fetch_code1(lemon);
+			c = machine_fetch_code1(lemon);
+			d = machine_fetch_code4(lemon);
+			printf("lazy %d %d %d %d\n", a, b, c, d);
+			break;
+
 		case OPCODE_KARG:
 			printf("karg\n");
 			break;
@@ -2284,6 +2804,12 @@ machine_disassemble(struct lemon *lemon)
 			printf("call %d\n", a);
 			break;
 
+		case OPCODE_CALLKW:
+			a = machine_fetch_code1(lemon);
+			b = machine_fetch_code4(lemon);
+			printf("callkw %d %d\n", a, b);
+			break;
+
 		case OPCODE_TAILCALL:
 			a = machine_fetch_code1(lemon);
 			printf("tailcall %d\n", a);
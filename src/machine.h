@@ -12,21 +12,24 @@ struct machine {
 	int sp; /* stack pointer */
 
 	int halt;
-	int maxpc;
-
-	int codelen;
+	int maxpc; /* length of running code */
 
 	int framelen;
 	int stacklen;
-	int cpoollen;
 
+	int nglobals;
+	int globallen;
+
+	/* running code object (lcode), switched on call and return */
+	struct lobject *lcode;
 	unsigned char *code;
+	struct lobject **cpool;
 
 	struct lframe *pause;
 
 	struct lframe **frame;
 	struct lobject **stack;
-	struct lobject **cpool;
+	struct lobject **globals; /* value of global symbol */
 
 	struct lobject *exception;
 };
@@ -40,23 +43,14 @@ machine_destroy(struct lemon *lemon, struct machine *machine);
 void
 machine_reset(struct lemon *lemon);
 
+/*
+ * return index of global value, -1 if out of memory
+ */
 int
-machine_add_const(struct lemon *lemon, struct lobject *object);
+machine_add_global(struct lemon *lemon, struct lobject *object);
 
 struct lobject *
-machine_get_const(struct lemon *lemon, int pool);
-
-int
-machine_add_code1(struct lemon *lemon, int value);
-
-int
-machine_set_code1(struct lemon *lemon, int location, int value);
-
-int
-machine_add_code4(struct lemon *lemon, int value);
-
-int
-machine_set_code4(struct lemon *lemon, int location, int value);
+machine_get_global(struct lemon *lemon, int global);
 
 struct lobject *
 machine_pop_object(struct lemon *lemon);
@@ -64,6 +58,12 @@ machine_pop_object(struct lemon *lemon);
 void
 machine_push_object(struct lemon *lemon, struct lobject *object);
 
+/*
+ * return `RuntimeError' if call exceed recursion limit, otherwise NULL
+ */
+struct lobject *
+machine_check_recursion(struct lemon *lemon);
+
 struct lframe *
 lemon_machine_push_new_frame(struct lemon *lemon,
                              struct lobject *self,
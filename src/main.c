@@ -12,6 +12,10 @@
 #include "lib/socket.h"
 #endif
 
+#ifdef MODULE_MATH
+#include "lib/math.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +24,7 @@ int
 main(int argc, char *argv[])
 {
 	int i;
+	int argi;
 	struct lemon *lemon;
 	struct lobject *objects;
 
@@ -45,17 +50,45 @@ main(int argc, char *argv[])
 	                 socket_module(lemon));
 #endif
 
-	if (argc < 2) {
+#ifdef MODULE_MATH
+	lobject_set_item(lemon,
+	                 lemon->l_modules,
+	                 lstring_create(lemon, "math", 4),
+	                 math_module(lemon));
+#endif
+
+	/*
+	 * `-O<level>' select optimization level, `-O' alone is highest
+	 * `-L' compile module level function at first call
+	 * `-R<depth>' limit depth of recursion, `-R0' is unlimited
+	 */
+	for (argi = 1; argi < argc; argi++) {
+		if (strncmp(argv[argi], "-O", 2) == 0) {
+			if (argv[argi][2]) {
+				lemon->l_optimize = atoi(argv[argi] + 2);
+			} else {
+				lemon->l_optimize = 2;
+			}
+		} else if (strcmp(argv[argi], "-L") == 0) {
+			lemon->l_lazy = 1;
+		} else if (strncmp(argv[argi], "-R", 2) == 0) {
+			lemon->l_recursion = atoi(argv[argi] + 2);
+		} else {
+			break;
+		}
+	}
+
+	if (argc <= argi) {
 		shell(lemon);
 	} else {
-		if (!lemon_input_set_file(lemon, argv[1])) {
-			fprintf(stderr, "open '%s' file fail\n", argv[1]);
+		if (!lemon_input_set_file(lemon, argv[argi])) {
+			fprintf(stderr, "open '%s' file fail\n", argv[argi]);
 			lemon_destroy(lemon);
 			exit(1);
 		}
 
 		objects = larray_create(lemon, 0, NULL);
-		for (i = 1; i < argc; i++) {
+		for (i = argi; i < argc; i++) {
 			struct lobject *value;
 
 			value = lstring_create(lemon, argv[i], strlen(argv[i]));
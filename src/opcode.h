@@ -65,15 +65,19 @@ enum {
 	OPCODE_JZ,
 	OPCODE_JNZ,
 	OPCODE_JMP,
+	OPCODE_INLINE, /* jump if not the inlined function */
+	OPCODE_FORITER, /* advance native iterator in local */
 
 	OPCODE_ARRAY,
 	OPCODE_DICTIONARY,
 
 	OPCODE_DEFINE,
+	OPCODE_LAZY, /* define function, body is compiled at first call */
 	OPCODE_KARG,
 	OPCODE_VARG,
 	OPCODE_VKARG,
 	OPCODE_CALL,
+	OPCODE_CALLKW, /* call with keyword names in constant array */
 	OPCODE_TAILCALL,
 	OPCODE_RETURN,
 
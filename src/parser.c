@@ -4,6 +4,7 @@
 #include "lexer.h"
 #include "syntax.h"
 #include "parser.h"
+#include "lstring.h"
 
 static struct syntax *
 parser_expr(struct lemon *lemon);
@@ -1746,6 +1747,42 @@ parser_parameter_list(struct lemon *lemon)
 
 	return first;
 }
+
+static struct syntax *
+parser_lazy_define(struct lemon *lemon,
+                   struct syntax *name,
+                   struct syntax *parameter_list,
+                   long offset)
+{
+	struct input *input;
+	struct syntax *node;
+
+	/* whole buffer is kept once for every lazy define in it */
+	input = lemon->l_input;
+	if (!input->source) {
+		input->source = lstring_create(lemon,
+		                               input->buffer,
+		                               input->size - 1);
+		if (!input->source) {
+			return NULL;
+		}
+	}
+
+	/* body is only scanned to its matching '}' */
+	do {
+		lexer_next_token(lemon);
+	} while (lexer_get_depth(lemon) > 0 &&
+	         lexer_get_token(lemon) != TOKEN_EOF &&
+	         lexer_get_token(lemon) != TOKEN_ERROR);
+	PARSER_MATCH(lemon, TOKEN_RBRACE);
+
+	node = syntax_make_define_node(lemon, name, parameter_list, NULL);
+	node->u.define_stmt.source = input->source;
+	node->u.define_stmt.offset = offset;
+
+	return node;
+}
+
 /*
  * define_stmt : 'define' '(' ')' block_stmt
  *             | 'define' '(' parameter_list ')' block_stmt
@@ -1756,10 +1793,12 @@ parser_parameter_list(struct lemon *lemon)
 static struct syntax *
 parser_define_stmt(struct lemon *lemon)
 {
+	long offset;
 	struct syntax *name;
 	struct syntax *parameter_list;
 	struct syntax *block_stmt;
 
+	offset = lexer_get_offset(lemon);
 	PARSER_MATCH(lemon, TOKEN_DEFINE);
 
 	name = NULL;
@@ -1780,6 +1819,14 @@ parser_define_stmt(struct lemon *lemon)
 	}
 	PARSER_MATCH(lemon, TOKEN_RPAREN);
 
+	/* module level function is compiled at first call, see compiler */
+	if (lemon->l_lazy &&
+	    lexer_get_token(lemon) == TOKEN_LBRACE &&
+	    lexer_get_depth(lemon) == 1)
+	{
+		return parser_lazy_define(lemon, name, parameter_list, offset);
+	}
+
 	block_stmt = parser_block_stmt(lemon);
 	if (!block_stmt) {
 		return NULL;
@@ -2241,3 +2288,44 @@ parser_parse(struct lemon *lemon)
 {
 	return parser_module(lemon);
 }
+
+struct syntax *
+parser_parse_define(struct lemon *lemon,
+                    struct lobject *source,
+                    const char *filename,
+                    long offset)
+{
+	int lazy;
+	void *input;
+	void *lexer;
+	struct syntax *node;
+
+	input = lemon->l_input;
+	lexer = lemon->l_lexer;
+	lazy = lemon->l_lazy;
+
+	node = NULL;
+	lemon->l_input = input_create(lemon);
+	lemon->l_lexer = lexer_create(lemon);
+	lemon->l_lazy = 0;
+	if (lemon->l_input && lemon->l_lexer &&
+	    input_set_buffer(lemon,
+	                     filename,
+	                     lstring_buffer(lemon, source),
+	                     lstring_length(lemon, source)))
+	{
+		((struct input *)lemon->l_input)->offset = offset;
+		lexer_next_token(lemon);
+		node = parser_define_stmt(lemon);
+	}
+	input_destroy(lemon, lemon->l_input);
+	if (lemon->l_lexer) {
+		lexer_destroy(lemon, lemon->l_lexer);
+	}
+
+	lemon->l_input = input;
+	lemon->l_lexer = lexer;
+	lemon->l_lazy = lazy;
+
+	return node;
+}
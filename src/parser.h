@@ -3,8 +3,19 @@
 
 struct lemon;
 struct syntax;
+struct lobject;
 
 struct syntax *
 parser_parse(struct lemon *lemon);
 
+/*
+ * parse lazy `define' at `offset' of `source' with a new input and lexer,
+ * current input and lexer are kept.  return NULL on syntax error
+ */
+struct syntax *
+parser_parse_define(struct lemon *lemon,
+                    struct lobject *source,
+                    const char *filename,
+                    long offset);
+
 #endif /* LEMON_PARSER_H */
@@ -1,6 +1,5 @@
 #include "lemon.h"
 #include "opcode.h"
-#include "machine.h"
 #include "generator.h"
 
 #define IS_JZ(a) ((a) && IS_OPCODE(a, OPCODE_JZ))
@@ -15,6 +14,10 @@
 #define IS_LABEL(a) ((a) && IS_OPCODE(a, -1))
 #define IS_OPCODE(a,b) ((a) && (a)->opcode == (b))
 
+#define PREV(a) generator_prev(lemon, (a))
+#define NEXT(a) generator_next(lemon, (a))
+#define LABEL(a) generator_label_code(lemon, (a)->arg[0].label)
+
 static struct generator_code *
 peephole_rewrite_unop(struct lemon *lemon,
                       struct generator_code *a)
@@ -30,24 +33,27 @@ peephole_rewrite_unop(struct lemon *lemon,
 	struct generator_code *b;
 	struct lobject *result;
 
-#define UNOP(m) do {                                                       \
-	result = lobject_unop(lemon,                                       \
-	                      (m),                                         \
-	                      machine_get_const(lemon, b->arg[0]->value)); \
-	pool = machine_add_const(lemon, result);                           \
-	if (lobject_is_error(lemon, result)) {                             \
-		return NULL;                                               \
-	}                                                                  \
-	a->opcode = OPCODE_CONST;                                          \
-	a->arg[0] = generator_make_arg(lemon, 0, 4, pool);                 \
-	generator_delete_code(lemon, b);                                   \
-	return a;                                                          \
+#define UNOP(m) do {                                                        \
+	result = lobject_unop(lemon,                                        \
+	                      (m),                                          \
+	                      generator_get_const(lemon, b->arg[0].value)); \
+	if (!result || lobject_is_error(lemon, result)) {                   \
+		return NULL;                                                \
+	}                                                                   \
+	pool = generator_add_const(lemon, result);                          \
+	if (pool < 0) {                                                     \
+		return NULL;                                                \
+	}                                                                   \
+	a->opcode = OPCODE_CONST;                                           \
+	generator_add_arg(lemon, a, 4, pool);                               \
+	generator_delete_code(lemon, b);                                    \
+	return a;                                                           \
 } while(0)
 
-	if (!IS_CONST(a->prev)) {
+	b = PREV(a);
+	if (!IS_CONST(b)) {
 		return NULL;
 	}
-	b = a->prev;
 
 	switch (a->opcode) {
 	case OPCODE_POS:
@@ -63,14 +69,17 @@ peephole_rewrite_unop(struct lemon *lemon,
 		break;
 
 	case OPCODE_LNOT:
-		result = machine_get_const(lemon, b->arg[0]->value);
+		result = generator_get_const(lemon, b->arg[0].value);
 		if (lobject_boolean(lemon, result) == lemon->l_true) {
-			pool = machine_add_const(lemon, lemon->l_false);
+			pool = generator_add_const(lemon, lemon->l_false);
 		} else {
-			pool = machine_add_const(lemon, lemon->l_true);
+			pool = generator_add_const(lemon, lemon->l_true);
+		}
+		if (pool < 0) {
+			return NULL;
 		}
 		a->opcode = OPCODE_CONST;
-		a->arg[0] = generator_make_arg(lemon, 0, 4, pool);
+		generator_add_arg(lemon, a, 4, pool);
 		generator_delete_code(lemon, b);
 
 		return a;
@@ -97,33 +106,35 @@ peephole_rewrite_binop(struct lemon *lemon,
 	struct generator_code *a;
 	struct generator_code *b;
 
-#define BINOP(m) do {                                                       \
-	result = lobject_binop(lemon,                                       \
-	                       (m),                                         \
-	                       machine_get_const(lemon, b->arg[0]->value),  \
-	                       machine_get_const(lemon, c->arg[0]->value)); \
-	pool = machine_add_const(lemon, result);                            \
-	if (lobject_is_error(lemon, result)) {                              \
-		return NULL;                                                \
-	}                                                                   \
-	a->opcode = OPCODE_CONST;                                           \
-	a->arg[0] = generator_make_arg(lemon, 0, 4, pool);                  \
-	generator_delete_code(lemon, b);                                    \
-	generator_delete_code(lemon, c);                                    \
-	return a;                                                           \
+#define BINOP(m) do {                                                        \
+	result = lobject_binop(lemon,                                        \
+	                       (m),                                          \
+	                       generator_get_const(lemon, a->arg[0].value),  \
+	                       generator_get_const(lemon, b->arg[0].value)); \
+	if (!result || lobject_is_error(lemon, result)) {                    \
+		return NULL;                                                 \
+	}                                                                    \
+	pool = generator_add_const(lemon, result);                           \
+	if (pool < 0) {                                                      \
+		return NULL;                                                 \
+	}                                                                    \
+	a->arg[0].value = pool;                                              \
+	generator_delete_code(lemon, b);                                     \
+	generator_delete_code(lemon, c);                                     \
+	return a;                                                            \
 } while(0)
 
-	if (!IS_CONST(c->prev)) {
+	b = PREV(c);
+	if (!IS_CONST(b)) {
 		return NULL;
 	}
-	b = c->prev;
 
-	if (!IS_CONST(b->prev)) {
+	a = PREV(b);
+	if (!IS_CONST(a)) {
 		return NULL;
 	}
-	a = b->prev;
 
-	switch (a->opcode) {
+	switch (c->opcode) {
 	case OPCODE_ADD:
 		BINOP(LOBJECT_METHOD_ADD);
 		break;
@@ -184,6 +195,10 @@ peephole_rewrite_binop(struct lemon *lemon,
 		BINOP(LOBJECT_METHOD_BITWISE_OR);
 		break;
 
+	case OPCODE_BXOR:
+		BINOP(LOBJECT_METHOD_BITWISE_XOR);
+		break;
+
 	default:
 		return NULL;
 	}
@@ -202,12 +217,14 @@ peephole_rewrite_jmp_to_next(struct lemon *lemon,
 	 *    ...
 	 */
 
+	struct generator_code *b;
+
 	if (IS_JMP(a)) {
-		if (a->next == a->arg[0]->label->code) {
-			a = a->next;
-			generator_delete_code(lemon, a->prev);
+		b = NEXT(a);
+		if (b == LABEL(a)) {
+			generator_delete_code(lemon, a);
 
-			return a;
+			return b;
 		}
 	}
 
@@ -229,10 +246,9 @@ peephole_rewrite_jz_or_jnz_to_next(struct lemon *lemon,
 	 */
 
 	if (IS_JZ(a) || IS_JNZ(a)) {
-		if (a->next == a->arg[0]->label->code) {
-			a->arg[0]->label->count -= 1;
+		if (NEXT(a) == LABEL(a)) {
+			generator_clear_args(lemon, a);
 			a->opcode = OPCODE_POP;
-			a->arg[0] = NULL;
 
 			return a;
 		}
@@ -264,17 +280,19 @@ peephole_rewrite_dup_jz_to_dup_jz(struct lemon *lemon,
 	 */
 
 	struct generator_code *b;
+	struct generator_code *c;
 
-	if (IS_JZ(a) && IS_DUP(a->prev)) {
-		b = a->arg[0]->label->code->next;
-		if (IS_DUP(b) && IS_JZ(b->next)) {
-			if (a->arg[0]->label == b->next->arg[0]->label) {
+	if (IS_JZ(a) && IS_DUP(PREV(a))) {
+		b = NEXT(LABEL(a));
+		c = b ? NEXT(b) : NULL;
+		if (IS_DUP(b) && IS_JZ(c)) {
+			if (a->arg[0].label == c->arg[0].label) {
 				return NULL;
 			}
 
-			a->arg[0]->label->count -= 1;
-			b->next->arg[0]->label->count += 1;
-			a->arg[0]->label = b->next->arg[0]->label;
+			a->arg[0].label->count -= 1;
+			c->arg[0].label->count += 1;
+			a->arg[0].label = c->arg[0].label;
 
 			return a;
 		}
@@ -312,15 +330,17 @@ peephole_rewrite_const_jz(struct lemon *lemon,
 	 */
 
 	struct lobject *object;
+	struct generator_code *b;
 
-	if (IS_JZ(a) && IS_CONST(a->prev)) {
-		object = machine_get_const(lemon, a->prev->arg[0]->value);
+	b = IS_JZ(a) ? PREV(a) : NULL;
+	if (IS_CONST(b)) {
+		object = generator_get_const(lemon, b->arg[0].value);
+		generator_delete_code(lemon, b);
 		if (lobject_boolean(lemon, object) == lemon->l_true) {
-			generator_delete_code(lemon, a->prev);
-			a = a->next;
-			generator_delete_code(lemon, a->prev);
+			b = NEXT(a);
+			generator_delete_code(lemon, a);
+			a = b;
 		} else {
-			generator_delete_code(lemon, a->prev);
 			a->opcode = OPCODE_JMP;
 		}
 		return a;
@@ -362,18 +382,20 @@ peephole_rewrite_const_dup_jz(struct lemon *lemon,
 	 */
 
 	struct lobject *object;
+	struct generator_code *b;
+	struct generator_code *c;
 
-	if (IS_JZ(a) && IS_DUP(a->prev) && IS_CONST(a->prev->prev)) {
-		a = a->prev->prev;
-		object = machine_get_const(lemon, a->arg[0]->value);
+	b = IS_JZ(a) ? PREV(a) : NULL;
+	c = IS_DUP(b) ? PREV(b) : NULL;
+	if (IS_CONST(c)) {
+		object = generator_get_const(lemon, c->arg[0].value);
+		generator_delete_code(lemon, b);
 		if (lobject_boolean(lemon, object) == lemon->l_true) {
-			generator_delete_code(lemon, a->next->next);
-			generator_delete_code(lemon, a->next);
+			generator_delete_code(lemon, a);
 		} else {
-			generator_delete_code(lemon, a->next);
-			a->next->opcode = OPCODE_JMP;
+			a->opcode = OPCODE_JMP;
 		}
-		return a;
+		return c;
 	}
 
 	return NULL;
@@ -412,18 +434,20 @@ peephole_rewrite_const_dup_jnz(struct lemon *lemon,
 	 */
 
 	struct lobject *object;
+	struct generator_code *b;
+	struct generator_code *c;
 
-	if (IS_JNZ(a) && IS_DUP(a->prev) && IS_CONST(a->prev->prev)) {
-		a = a->prev->prev;
-		object = machine_get_const(lemon, a->arg[0]->value);
+	b = IS_JNZ(a) ? PREV(a) : NULL;
+	c = IS_DUP(b) ? PREV(b) : NULL;
+	if (IS_CONST(c)) {
+		object = generator_get_const(lemon, c->arg[0].value);
+		generator_delete_code(lemon, b);
 		if (lobject_boolean(lemon, object) == lemon->l_true) {
-			generator_delete_code(lemon, a->next);
-			a->next->opcode = OPCODE_JMP;
+			a->opcode = OPCODE_JMP;
 		} else {
-			generator_delete_code(lemon, a->next->next);
-			generator_delete_code(lemon, a->next);
+			generator_delete_code(lemon, a);
 		}
-		return a;
+		return c;
 	}
 
 	return NULL;
@@ -434,19 +458,22 @@ peephole_rewrite_pop(struct lemon *lemon,
                      struct generator_code *a)
 {
 	/*
-	 *    CONST/DUP
+	 *    CONST/DUP/LOAD
 	 *    POP
 	 *    ...
 	 * ->
 	 *    ...
 	 */
 
-	if (IS_POP(a) && (IS_CONST(a->prev) || IS_DUP(a->prev))) {
-		generator_delete_code(lemon, a->prev);
-		a = a->next;
-		generator_delete_code(lemon, a->prev);
+	struct generator_code *b;
 
-		return a;
+	b = IS_POP(a) ? PREV(a) : NULL;
+	if (IS_CONST(b) || IS_DUP(b) || IS_LOAD(b)) {
+		generator_delete_code(lemon, b);
+		b = NEXT(a);
+		generator_delete_code(lemon, a);
+
+		return b;
 	}
 
 	return NULL;
@@ -466,15 +493,17 @@ peephole_rewrite_load_load(struct lemon *lemon,
 	 *    ...
 	 */
 
-	if (IS_LOAD(a) && IS_LOAD(a->prev)) {
-		if (a->arg[0]->value == a->prev->arg[0]->value &&
-		    a->arg[1]->value == a->prev->arg[1]->value)
+	struct generator_code *b;
+
+	b = IS_LOAD(a) ? PREV(a) : NULL;
+	if (IS_LOAD(b)) {
+		if (a->arg[0].value == b->arg[0].value &&
+		    a->arg[1].value == b->arg[1].value)
 		{
 			a->opcode = OPCODE_DUP;
-			a->arg[0] = NULL;
-			a->arg[1] = NULL;
+			a->nargs = 0;
 
-			return a->prev;
+			return b;
 		}
 	}
 
@@ -495,15 +524,18 @@ peephole_rewrite_store_load(struct lemon *lemon,
 	 *    ...
 	 */
 
-	if (IS_LOAD(a) && IS_STORE(a->prev)) {
-		if (a->arg[0]->value == a->prev->arg[0]->value &&
-		    a->arg[1]->value == a->prev->arg[1]->value)
+	struct generator_code *b;
+
+	b = IS_LOAD(a) ? PREV(a) : NULL;
+	if (IS_STORE(b)) {
+		if (a->arg[0].value == b->arg[0].value &&
+		    a->arg[1].value == b->arg[1].value)
 		{
-			a->prev->opcode = OPCODE_DUP;
-			a->prev->arg[0] = NULL;
+			b->opcode = OPCODE_DUP;
+			b->nargs = 0;
 			a->opcode = OPCODE_STORE;
 
-			return a->prev;
+			return b;
 		}
 	}
 
@@ -513,28 +545,26 @@ peephole_rewrite_store_load(struct lemon *lemon,
 void
 peephole_optimize(struct lemon *lemon)
 {
-	struct generator *gen;
 	struct generator_code *a;
 	struct generator_code *t;
 
-	gen = lemon->l_generator;
-	a = gen->head;
+	a = generator_first(lemon);
 	while (a) {
 		if (IS_LABEL(a)) {
 			/* remove no reference label,
 			 * peephole should use backward order match pattern
 			 */
+			t = NEXT(a);
 			if (a->label && a->label->count == 0) {
-				a = a->next;
-				generator_delete_code(lemon, a->prev);
-			} else {
-				a = a->next;
+				generator_delete_code(lemon, a);
 			}
+			a = t;
 			continue;
 		}
 		if (IS_NOP(a)) {
-			a = a->next;
-			generator_delete_code(lemon, a->prev);
+			t = NEXT(a);
+			generator_delete_code(lemon, a);
+			a = t;
 			continue;
 		}
 
@@ -593,6 +623,7 @@ peephole_optimize(struct lemon *lemon)
 			continue;
 		}
 
-		a = a->next;
+		a = NEXT(a);
 	}
+	generator_compact(lemon);
 }
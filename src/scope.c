@@ -36,49 +36,149 @@ scope_leave(struct lemon *lemon)
 	return 0;
 }
 
-struct symbol *
-scope_add_symbol(struct lemon *lemon,
-                 struct scope *scope,
-                 const char *name,
-                 int type)
+static long
+scope_slot(struct scope *scope, const char *name)
+{
+	unsigned long h;
+
+	h = (unsigned long)(uintptr_t)name;
+	h = (h >> 4) ^ (h >> 12);
+
+	return (long)(h & (unsigned long)(scope->nslots - 1));
+}
+
+static struct symbol *
+scope_find_symbol(struct scope *scope, const char *name)
 {
 	struct symbol *symbol;
 
-	if (symbol_get_symbol(scope->symbol, name)) {
+	if (!scope->nslots) {
 		return NULL;
 	}
+
+	symbol = scope->slots[scope_slot(scope, name)];
+	for (; symbol; symbol = symbol->chain) {
+		if (symbol->name == name) {
+			return symbol;
+		}
+	}
+
+	return NULL;
+}
+
+static int
+scope_resize(struct lemon *lemon, struct scope *scope)
+{
+	long i;
+	long nslots;
+	struct symbol *symbol;
+	struct symbol **slots;
+
+	if (scope->nslots) {
+		nslots = scope->nslots * 2;
+	} else {
+		nslots = 8;
+	}
+	slots = arena_alloc(lemon, lemon->l_arena, sizeof(*slots) * nslots);
+	if (!slots) {
+		return 0;
+	}
+	memset(slots, 0, sizeof(*slots) * nslots);
+	scope->slots = slots;
+	scope->nslots = nslots;
+
+	/* old slots is left in arena, `symbol' list keep every symbol */
+	for (symbol = scope->symbol; symbol; symbol = symbol->next) {
+		i = scope_slot(scope, symbol->name);
+		symbol->chain = slots[i];
+		slots[i] = symbol;
+	}
+
+	return 1;
+}
+
+static struct symbol *
+scope_insert_symbol(struct lemon *lemon,
+                    struct scope *scope,
+                    const char *name,
+                    int type)
+{
+	long i;
+	struct symbol *symbol;
+
+	if (scope->nsymbols >= scope->nslots) {
+		if (!scope_resize(lemon, scope)) {
+			return NULL;
+		}
+	}
+
 	symbol = symbol_make_symbol(lemon, name, type);
+	if (!symbol) {
+		return NULL;
+	}
 	symbol->next = scope->symbol;
 	scope->symbol = symbol;
 
+	i = scope_slot(scope, name);
+	symbol->chain = scope->slots[i];
+	scope->slots[i] = symbol;
+	scope->nsymbols += 1;
+
 	return symbol;
 }
 
 struct symbol *
-scope_get_symbol(struct lemon *lemon, struct scope *scope, char *name)
+scope_add_symbol(struct lemon *lemon,
+                 struct scope *scope,
+                 const char *name,
+                 int type)
+{
+	name = symbol_intern(lemon, name, strlen(name));
+	if (!name) {
+		return NULL;
+	}
+
+	if (scope_find_symbol(scope, name)) {
+		return NULL;
+	}
+
+	return scope_insert_symbol(lemon, scope, name, type);
+}
+
+struct symbol *
+scope_get_symbol(struct lemon *lemon, struct scope *scope, const char *name)
 {
 	int level;
 	struct scope *curr;
-	struct scope *global;
 	struct symbol *s;
 	struct symbol *symbol;
 
+	/* intern once, then each scope is a pointer compare */
+	name = symbol_intern(lemon, name, strlen(name));
+	if (!name) {
+		return NULL;
+	}
+
 	level = 0;
 	for (curr = scope; curr; curr = curr->parent) {
 		if (curr->type == SCOPE_CLASS) {
 			continue;
 		}
-		s = symbol_get_symbol(curr->symbol, name);
+		s = scope_find_symbol(curr, name);
 		if (s) {
 			if (level && s->type == SYMBOL_LOCAL) {
-				symbol = scope_add_symbol(lemon,
-				                          scope,
-				                          name,
-				                          SYMBOL_LOCAL);
-				symbol->cpool = s->cpool;
+				symbol = scope_insert_symbol(lemon,
+				                             scope,
+				                             name,
+				                             SYMBOL_LOCAL);
+				if (!symbol) {
+					return NULL;
+				}
+				symbol->global = s->global;
 				symbol->level = s->level + level;
 				symbol->local = s->local;
 				symbol->accessor_list = s->accessor_list;
+				symbol->define = s->define;
 
 				return symbol;
 			}
@@ -91,6 +191,5 @@ scope_get_symbol(struct lemon *lemon, struct scope *scope, char *name)
 		}
 	}
 
-	global = lemon->l_global;
-	return symbol_get_symbol(global->symbol, name);
+	return scope_find_symbol(lemon->l_global, name);
 }
@@ -3,6 +3,7 @@
 
 struct lemon;
 struct symbol;
+struct lobject;
 
 enum {
 	SCOPE_CLASS,
@@ -15,7 +16,20 @@ struct scope {
 	int type;
 	struct scope *parent;
 
-	struct symbol *symbol;
+	/*
+	 * symbols hashed by interned name's address, `nslots' is 0 or
+	 * power of 2, allocated at first symbol
+	 */
+	long nslots;
+	long nsymbols;
+	struct symbol **slots;
+
+	struct symbol *symbol; /* all symbols, last added first */
+
+	/* module symbols exported to lazy function, see compiler_lazy */
+	struct lobject *names;
+	struct lobject *lazies; /* lazy records, one const for module */
+	int eager; /* symbol can't be exported, no more lazy function */
 };
 
 int
@@ -31,6 +45,6 @@ scope_add_symbol(struct lemon *lemon,
                  int type);
 
 struct symbol *
-scope_get_symbol(struct lemon *lemon, struct scope *scope, char *name);
+scope_get_symbol(struct lemon *lemon, struct scope *scope, const char *name);
 
 #endif /* LEMON_SCOPE_H */
@@ -204,6 +204,14 @@ shell(struct lemon *lemon)
 	puts("Copyright 2017 Zhicheng Wei");
 	puts("Type '\\help' for more information, '\\exit' or ^D exit\n");
 
+	/*
+	 * all code is emitted again for every statement, no lazy function,
+	 * no inlined function (its guard never match code object of later
+	 * statement and inlined locals grow module frame)
+	 */
+	lemon->l_lazy = 0;
+	lemon->l_inline = 0;
+
 	pc = 0;
 	codelen = 0;
 	stmtlen = 0;
@@ -266,16 +274,16 @@ shell(struct lemon *lemon)
 		if (!compiler_compile(lemon, node)) {
 			codelen -= stmtlen;
 			stmtlen = 0;
-			lemon->l_generator = generator_create(lemon);
+			generator_reset(lemon);
 			fprintf(stderr, "generator: syntax error\n");
 
 			continue;
 		}
 
+		/* whole program is emitted again, run from last statement */
 		stmtlen = 0;
-		lemon_machine_reset(lemon);
-		generator_emit(lemon);
-		lemon->l_generator = generator_create(lemon);
+		lemon_machine_set_code(lemon, generator_emit(lemon));
+		generator_reset(lemon);
 		lemon_machine_set_pc(lemon, pc);
 		if (lemon_machine_get_fp(lemon) >= 0) {
 			frame = lemon_machine_get_frame(lemon, 0);
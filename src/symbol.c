@@ -1,10 +1,117 @@
 #include "lemon.h"
+#include "hash.h"
 #include "arena.h"
-#include "scope.h"
 #include "symbol.h"
 
 #include <string.h>
 
+struct symbol_name {
+	struct symbol_name *next;
+	unsigned long hash;
+	long length;
+	char name[1];
+};
+
+static int
+symbol_intern_resize(struct lemon *lemon)
+{
+	unsigned long i;
+	unsigned long size;
+	struct symbol_name *name;
+	struct symbol_name *next;
+	struct symbol_name **slots;
+	struct symbol_name **oldslots;
+
+	if (lemon->l_names_length) {
+		size = lemon->l_names_length * 2;
+	} else {
+		size = 256;
+	}
+	slots = lemon_allocator_alloc(lemon, sizeof(*slots) * size);
+	if (!slots) {
+		return 0;
+	}
+	memset(slots, 0, sizeof(*slots) * size);
+
+	oldslots = lemon->l_names_slots;
+	for (i = 0; i < lemon->l_names_length; i++) {
+		for (name = oldslots[i]; name; name = next) {
+			next = name->next;
+			name->next = slots[name->hash & (size - 1)];
+			slots[name->hash & (size - 1)] = name;
+		}
+	}
+	lemon_allocator_free(lemon, oldslots);
+	lemon->l_names_slots = slots;
+	lemon->l_names_length = size;
+
+	return 1;
+}
+
+char *
+symbol_intern(struct lemon *lemon, const char *name, long length)
+{
+	unsigned long hash;
+	struct symbol_name *p;
+	struct symbol_name **slots;
+
+	hash = (unsigned long)lemon_hash(lemon, name, length);
+	slots = lemon->l_names_slots;
+	if (slots) {
+		p = slots[hash & (lemon->l_names_length - 1)];
+		for (; p; p = p->next) {
+			if (p->hash == hash &&
+			    p->length == length &&
+			    memcmp(p->name, name, length) == 0)
+			{
+				return p->name;
+			}
+		}
+	}
+
+	if (lemon->l_names_count >= lemon->l_names_length) {
+		if (!symbol_intern_resize(lemon)) {
+			return NULL;
+		}
+		slots = lemon->l_names_slots;
+	}
+
+	p = lemon_allocator_alloc(lemon, sizeof(*p) + length);
+	if (!p) {
+		return NULL;
+	}
+	p->hash = hash;
+	p->length = length;
+	memcpy(p->name, name, length);
+	p->name[length] = '\0';
+	p->next = slots[hash & (lemon->l_names_length - 1)];
+	slots[hash & (lemon->l_names_length - 1)] = p;
+	lemon->l_names_count += 1;
+
+	return p->name;
+}
+
+void
+symbol_intern_destroy(struct lemon *lemon)
+{
+	unsigned long i;
+	struct symbol_name *name;
+	struct symbol_name *next;
+	struct symbol_name **slots;
+
+	slots = lemon->l_names_slots;
+	for (i = 0; i < lemon->l_names_length; i++) {
+		for (name = slots[i]; name; name = next) {
+			next = name->next;
+			lemon_allocator_free(lemon, name);
+		}
+	}
+	lemon_allocator_free(lemon, slots);
+	lemon->l_names_slots = NULL;
+	lemon->l_names_count = 0;
+	lemon->l_names_length = 0;
+}
+
 struct symbol *
 symbol_make_symbol(struct lemon *lemon, const char *name, int type)
 {
@@ -15,20 +122,8 @@ symbol_make_symbol(struct lemon *lemon, const char *name, int type)
 		return NULL;
 	}
 	memset(symbol, 0, sizeof(*symbol));
-	strncpy(symbol->name, name, LEMON_NAME_MAX);
+	symbol->name = name;
 	symbol->type = type;
 
 	return symbol;
 }
-
-struct symbol *
-symbol_get_symbol(struct symbol *symbol, const char *name)
-{
-	for (; symbol; symbol = symbol->next) {
-		if (strncmp(symbol->name, name, LEMON_NAME_MAX) == 0) {
-			return symbol;
-		}
-	}
-
-	return NULL;
-}
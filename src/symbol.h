@@ -13,19 +13,32 @@ enum {
 struct symbol {
 	int type;
 
-	int cpool; /* const pool index */
+	int global; /* machine_get_global index if SYMBOL_GLOBAL */
 	int level; /* level == 0: current frame, level > 0: upframe */
 	int local; /* frame->locals index */
-	char name[LEMON_NAME_MAX];
+	const char *name; /* interned, compare by pointer */
 
-	struct symbol *next;
+	struct symbol *next;  /* scope's symbols, last added first */
+	struct symbol *chain; /* scope's hash bucket */
 	struct syntax *accessor_list;
+	void *define; /* inlinable function, see compiler_inline */
 };
 
-struct symbol *
-symbol_make_symbol(struct lemon *lemon, const char *name, int type);
+/*
+ * return unique '\0' terminated copy of `name', same name always return
+ * same pointer.  interned names live until lemon_destroy and must not be
+ * modified.
+ */
+char *
+symbol_intern(struct lemon *lemon, const char *name, long length);
 
+void
+symbol_intern_destroy(struct lemon *lemon);
+
+/*
+ * `name' must be interned
+ */
 struct symbol *
-symbol_get_symbol(struct symbol *symbol, const char *name);
+symbol_make_symbol(struct lemon *lemon, const char *name, int type);
 
 #endif /* LEMON_SYMBOL_H */
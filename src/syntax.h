@@ -317,8 +317,12 @@ struct syntax {
 		struct {
 			struct syntax *name;
 			struct syntax *parameter_list;
-			struct syntax *block_stmt;
+			struct syntax *block_stmt; /* NULL if body is lazy */
 			struct syntax *accessor_list;
+
+			/* lazy body's source (lstring) and `define' offset */
+			void *source;
+			long offset;
 		} define_stmt;
 
 		struct {